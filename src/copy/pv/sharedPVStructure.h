@@ -0,0 +1,91 @@
+/* sharedPVStructure.h */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef SHAREDPVSTRUCTURE_H
+#define SHAREDPVSTRUCTURE_H
+
+#include <pv/pvData.h>
+#include <pv/lock.h>
+#include <pv/bitSet.h>
+#include <pv/noDefaultMethods.h>
+
+#include <shareLib.h>
+
+namespace epics { namespace pvData {
+
+/**
+ * @brief Publish consistent snapshots of a PVStructure from one writer to many readers.
+ *
+ * The writer updates its own PVStructure, from getWritable(), without any locking.
+ * It then calls publish() with the offsets of the fields it changed.
+ * Readers call snapshot() to get the most recently published values.
+ * A snapshot is never modified while any reader references it.
+ *
+ @code
+   SharedPVStructure shared(type);
+   // writer
+   shared.getWritable()->getSubFieldT<PVDouble>("value")->put(42.0);
+   shared.publish(changed);
+   // reader
+   SharedPVStructure::const_pointer snap(shared.snapshot());
+ @endcode
+ *
+ * Snapshots are kept in a pool of PVStructures which are recycled once no reader references them.
+ * publish() copies into a recycled PVStructure only the fields changed since it was last published,
+ * so the cost of publish() follows the size of the changes, not of the structure.
+ * Elements of changed structure and union arrays are copied, not shared with the writer,
+ * so the writer may go on to modify them in place.
+ *
+ * snapshot() holds a lock only to copy the current pointer.
+ * Readers never wait for publish() to copy values, and the writer never waits for readers.
+ */
+class epicsShareClass SharedPVStructure {
+    EPICS_NOT_COPYABLE(SharedPVStructure)
+public:
+    POINTER_DEFINITIONS(SharedPVStructure);
+    typedef std::tr1::shared_ptr<const PVStructure> const_pointer;
+
+    /**
+     * Create the writer's PVStructure, and publish an initial snapshot with default values.
+     * @param type The type of the shared structure.
+     */
+    explicit SharedPVStructure(const StructureConstPtr& type);
+    ~SharedPVStructure();
+
+    /** The PVStructure updated by the writer.
+     * Only to be used by the thread which calls publish().
+     */
+    const PVStructurePtr& getWritable() const { return writable; }
+
+    /**
+     * Make the current values of getWritable() visible to snapshot().
+     * @param changed Offsets of the fields changed since the previous publish().
+     *        Bit 0 for all fields.
+     */
+    void publish(const BitSet& changed);
+
+    //! The most recently published values.  May be called from any thread.
+    const_pointer snapshot() const;
+
+    struct Stats {
+        //! Number of calls to publish()
+        size_t published;
+        //! Number of PVStructures allocated for snapshots
+        size_t buffers;
+        //! Number of these not currently referenced by any reader
+        size_t free;
+    };
+    Stats getStats() const;
+
+    struct Pool;
+private:
+    const PVStructurePtr writable;
+    const std::tr1::shared_ptr<Pool> pool;
+    size_t published;
+};
+
+}}
+
+#endif // SHAREDPVSTRUCTURE_H
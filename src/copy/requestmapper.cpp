@@ -96,23 +96,27 @@ void PVRequestMapper::compute(const PVStructure &base,
     }
 
     {
-        PVStructurePtr proto(temp.typeRequested->build());
+        const Structure::Layout& baseLayout = temp.typeBase->getLayout();
+        const Structure::Layout& reqLayout = temp.typeRequested->getLayout();
 
         // base -> request may be sparce mapping
-        temp.base2req.resize(base.getNextFieldOffset());
+        temp.base2req.resize(baseLayout.size());
         // request -> base is dense mapping
-        temp.req2base.resize(proto->getNextFieldOffset());
+        temp.req2base.resize(reqLayout.size());
 
         // special handling for whole structure mapping.  in part because getSubField(0) isn't allowed
         temp.base2req[0] = Mapping(0, false);
         temp.req2base[0] = Mapping(0, false);
 
-        // Iterate prototype of requested to map with base field offsets.
+        // Iterate fields of requested type to map with base field offsets.
         // which is handled as a special case below.
         // We also don't try to prevent redundant copies if both leaf and compress bits are set.
-        for(size_t r=1, N=proto->getNextFieldOffset(); r<N; r++) {
-            PVField::const_shared_pointer fld_req(proto->getSubFieldT(r)),
-                    fld_base(base.getSubFieldT(fld_req->getFullName()));
+        for(size_t r=1, N=reqLayout.size(); r<N; r++) {
+            std::string fullName(*reqLayout[r].name);
+            for(uint32 parent = reqLayout[r].parentOffset; parent; parent = reqLayout[parent].parentOffset)
+                fullName = *reqLayout[parent].name + '.' + fullName;
+
+            PVField::const_shared_pointer fld_base(base.getSubFieldT(fullName));
             const size_t b = fld_base->getFieldOffset();
 
             if(!temp.requestedMask().get(b))
@@ -125,14 +129,16 @@ void PVRequestMapper::compute(const PVStructure &base,
             temp.req2base[r] = Mapping(b, leaf);
 
             // add ourself to all "compress" bit mappings of enclosing structures
-            for(const PVStructure *parent = fld_req->getParent(); parent; parent = parent->getParent()) {
-                temp.req2base[parent->getFieldOffset()].tomask  .set(b);
-                temp.req2base[parent->getFieldOffset()].frommask.set(r);
+            for(uint32 parent = reqLayout[r].parentOffset; ; parent = reqLayout[parent].parentOffset) {
+                temp.req2base[parent].tomask  .set(b);
+                temp.req2base[parent].frommask.set(r);
+                if(!parent) break;
             }
 
-            for(const PVStructure *parent = fld_base->getParent(); parent; parent = parent->getParent()) {
-                temp.base2req[parent->getFieldOffset()].tomask  .set(r);
-                temp.base2req[parent->getFieldOffset()].frommask.set(b);
+            for(uint32 parent = baseLayout[b].parentOffset; ; parent = baseLayout[parent].parentOffset) {
+                temp.base2req[parent].tomask  .set(r);
+                temp.base2req[parent].frommask.set(b);
+                if(!parent) break;
             }
         }
     }
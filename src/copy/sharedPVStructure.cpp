@@ -0,0 +1,206 @@
+/* sharedPVStructure.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <vector>
+
+#include <epicsAtomic.h>
+
+#define epicsExportSharedSymbols
+#include <pv/sharedPVStructure.h>
+
+namespace epics { namespace pvData {
+
+namespace {
+struct Buffer {
+    const PVStructurePtr value;
+    // fields published since this buffer was last filled
+    BitSet stale;
+    explicit Buffer(const PVStructurePtr& value) :value(value) {
+        stale.set(0);
+    }
+};
+} // namespace
+
+namespace {
+// As PVField::copyUnchecked(), but elements of structure and union arrays,
+// and the values of variant unions, are copied instead of shared with src.
+void deepCopy(PVField& dest, const PVField& src);
+
+PVFieldPtr deepClone(const PVField& src)
+{
+    PVFieldPtr ret(getPVDataCreate()->createPVField(src.getField()));
+    deepCopy(*ret, src);
+    return ret;
+}
+
+template<typename PVA>
+void deepCopyArray(PVA& dest, const PVA& src)
+{
+    typename PVA::const_svector from(src.view());
+    typename PVA::svector to(from.size());
+    for(size_t i=0, N=from.size(); i<N; i++) {
+        if(from[i])
+            to[i] = std::tr1::static_pointer_cast<typename PVA::value_type::element_type>(deepClone(*from[i]));
+    }
+    dest.replace(freeze(to));
+}
+
+void deepCopy(PVField& dest, const PVField& src)
+{
+    switch(src.getField()->getType()) {
+    case structure: {
+        const PVFieldPtrArray& from(static_cast<const PVStructure&>(src).getPVFields()),
+                               to(static_cast<PVStructure&>(dest).getPVFields());
+        for(size_t i=0, N=from.size(); i<N; i++)
+            deepCopy(*to[i], *from[i]);
+        break;
+    }
+    case structureArray:
+        deepCopyArray(static_cast<PVStructureArray&>(dest), static_cast<const PVStructureArray&>(src));
+        break;
+    case union_: {
+        const PVUnion& from(static_cast<const PVUnion&>(src));
+        PVUnion& to(static_cast<PVUnion&>(dest));
+        const PVField::const_shared_pointer& value(from.get());
+        if(from.getUnion()->isVariant())
+            to.set(value ? deepClone(*value) : PVFieldPtr());
+        else if(!value)
+            to.select(PVUnion::UNDEFINED_INDEX);
+        else
+            deepCopy(*to.select(from.getSelectedIndex()), *value);
+        break;
+    }
+    case unionArray:
+        deepCopyArray(static_cast<PVUnionArray&>(dest), static_cast<const PVUnionArray&>(src));
+        break;
+    default:
+        dest.copyUnchecked(src);
+    }
+}
+
+// copy the fields of src selected by mask
+void copyChanged(PVStructure& dest, const PVStructure& src, const BitSet& mask)
+{
+    const Structure::Layout& layout = src.getStructure()->getLayout();
+    for(int32 offset = mask.nextSetBit(0); offset>=0 && size_t(offset)<layout.size();
+        offset = mask.nextSetBit(layout[offset].nextOffset))
+    {
+        if(offset==0)
+            deepCopy(dest, src);
+        else
+            deepCopy(*dest.getSubFieldT(size_t(offset)), *src.getSubFieldT(size_t(offset)));
+    }
+}
+} // namespace
+
+struct SharedPVStructure::Pool {
+    const StructureConstPtr type;
+
+    mutable Mutex lock;
+    // guarded by lock
+    const_pointer current;
+    std::vector<Buffer*> free;
+    // guarded by lock, except that the writer may read without locking.
+    // free.capacity()>=all.size() so Recycle never allocates.
+    std::vector<Buffer*> all;
+
+    explicit Pool(const StructureConstPtr& type) :type(type) {}
+    ~Pool() {
+        for(size_t i=0; i<all.size(); i++)
+            delete all[i];
+    }
+};
+
+namespace {
+// returns a Buffer to the free list when no reader references it
+struct Recycle {
+    std::tr1::shared_ptr<SharedPVStructure::Pool> pool;
+    Buffer *buf;
+    Recycle(const std::tr1::shared_ptr<SharedPVStructure::Pool>& pool, Buffer *buf) :pool(pool), buf(buf) {}
+    void operator()(const PVStructure *) {
+        std::tr1::shared_ptr<SharedPVStructure::Pool> P;
+        P.swap(pool); // may be the last reference
+        {
+            Lock G(P->lock);
+            P->free.push_back(buf);
+        }
+    }
+};
+} // namespace
+
+SharedPVStructure::SharedPVStructure(const StructureConstPtr& type)
+    :writable(getPVDataCreate()->createPVStructure(type))
+    ,pool(new Pool(type))
+    ,published(0u)
+{
+    BitSet all;
+    all.set(0);
+    publish(all);
+}
+
+SharedPVStructure::~SharedPVStructure()
+{
+    const_pointer temp;
+    Lock G(pool->lock);
+    temp.swap(pool->current);
+    // the last snapshot released will destroy the pool
+}
+
+void SharedPVStructure::publish(const BitSet& changed)
+{
+    Buffer *buf = 0;
+    {
+        Lock G(pool->lock);
+        if(!pool->free.empty()) {
+            buf = pool->free.back();
+            pool->free.pop_back();
+        }
+    }
+
+    if(!buf) {
+        epics::auto_ptr<Buffer> temp(new Buffer(getPVDataCreate()->createPVStructure(pool->type)));
+        Lock G(pool->lock);
+        pool->all.push_back(temp.get());
+        pool->free.reserve(pool->all.size());
+        buf = temp.release();
+    }
+
+    // bring this buffer up to date
+    buf->stale |= changed;
+    copyChanged(*buf->value, *writable, buf->stale);
+    buf->stale.clear();
+
+    for(size_t i=0; i<pool->all.size(); i++) {
+        if(pool->all[i]!=buf)
+            pool->all[i]->stale |= changed;
+    }
+
+    const_pointer next(buf->value.get(), Recycle(pool, buf));
+    {
+        Lock G(pool->lock);
+        next.swap(pool->current);
+    }
+    // previous snapshot released outside of the lock
+    epics::atomic::increment(published);
+}
+
+SharedPVStructure::const_pointer SharedPVStructure::snapshot() const
+{
+    Lock G(pool->lock);
+    return pool->current;
+}
+
+SharedPVStructure::Stats SharedPVStructure::getStats() const
+{
+    Stats ret;
+    ret.published = epics::atomic::get(published);
+    Lock G(pool->lock);
+    ret.buffers = pool->all.size();
+    ret.free = pool->free.size();
+    return ret;
+}
+
+}} // namespace epics::pvData
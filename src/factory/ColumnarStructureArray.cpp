@@ -0,0 +1,415 @@
+/* ColumnarStructureArray.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#include <algorithm>
+#include <string>
+#include <stdexcept>
+
+#define epicsExportSharedSymbols
+#include <pv/pvData.h>
+#include <pv/serializeHelper.h>
+#include <pv/columnarStructureArray.h>
+
+using std::string;
+using std::size_t;
+
+namespace {
+using namespace epics::pvData;
+
+void buildColumns(const Structure& type, const string& prefix,
+                  std::vector<string>& names, std::vector<ScalarType>& types)
+{
+    const FieldConstPtrArray& fields = type.getFields();
+    for(size_t i=0, N=fields.size(); i<N; i++) {
+        string name(prefix + type.getFieldName(i));
+        switch(fields[i]->getType()) {
+        case scalar:
+            names.push_back(name);
+            types.push_back(static_cast<const Scalar*>(fields[i].get())->getScalarType());
+            break;
+        case structure:
+            buildColumns(*static_cast<const Structure*>(fields[i].get()), name+".", names, types);
+            break;
+        default:
+            throw std::invalid_argument("ColumnarStructureArray: element field '"+name+"' is not a scalar");
+        }
+    }
+}
+
+// leaf fields of one element, in the same order as the columns
+void collectLeaves(const PVStructure& elem, std::vector<const PVScalar*>& leaves)
+{
+    const PVFieldPtrArray& fields = elem.getPVFields();
+    for(size_t i=0, N=fields.size(); i<N; i++) {
+        if(fields[i]->getField()->getType()==structure)
+            collectLeaves(*static_cast<const PVStructure*>(fields[i].get()), leaves);
+        else
+            leaves.push_back(static_cast<const PVScalar*>(fields[i].get()));
+    }
+}
+
+void collectLeaves(PVStructure& elem, std::vector<PVScalar*>& leaves)
+{
+    const PVFieldPtrArray& fields = elem.getPVFields();
+    for(size_t i=0, N=fields.size(); i<N; i++) {
+        if(fields[i]->getField()->getType()==structure)
+            collectLeaves(*static_cast<PVStructure*>(fields[i].get()), leaves);
+        else
+            leaves.push_back(static_cast<PVScalar*>(fields[i].get()));
+    }
+}
+
+template<typename T>
+shared_vector<const void> resizeColumn(const shared_vector<const void>& raw, size_t length)
+{
+    shared_vector<const T> prev(static_shared_vector_cast<const T>(raw));
+    shared_vector<T> next(length, T());
+    std::copy(prev.begin(), prev.begin()+std::min(prev.size(), length), next.begin());
+    return static_shared_vector_cast<const void>(freeze(next));
+}
+
+template<typename T>
+shared_vector<const void> gatherLeaves(const std::vector<const PVScalar*>& leaves,
+                                       size_t column, size_t ncolumns, size_t length)
+{
+    shared_vector<T> ret(length);
+    for(size_t r=0; r<length; r++)
+        ret[r] = static_cast<const PVScalarValue<T>*>(leaves[r*ncolumns+column])->get();
+    return static_shared_vector_cast<const void>(freeze(ret));
+}
+
+template<typename T>
+void scatterLeaves(const std::vector<PVScalar*>& leaves,
+                   size_t column, size_t ncolumns, const shared_vector<const void>& raw)
+{
+    shared_vector<const T> data(static_shared_vector_cast<const T>(raw));
+    for(size_t r=0, N=data.size(); r<N; r++)
+        static_cast<PVScalarValue<T>*>(leaves[r*ncolumns+column])->put(data[r]);
+}
+
+// write 'count' values to every 'stride' bytes of the buffer, starting at 'pos'
+template<typename T>
+void scatterColumn(ByteBuffer *pbuffer, size_t pos, size_t stride, const void *raw, size_t count)
+{
+    const T *src = static_cast<const T*>(raw);
+    for(size_t i=0; i<count; i++, pos+=stride)
+        pbuffer->put<T>(pos, src[i]);
+}
+
+template<typename T>
+void gatherColumn(const ByteBuffer *pbuffer, size_t pos, size_t stride, void *raw, size_t count)
+{
+    T *dest = static_cast<T*>(raw);
+    for(size_t i=0; i<count; i++, pos+=stride)
+        dest[i] = pbuffer->get<T>(pos);
+}
+
+void nullElement()
+{
+    throw std::runtime_error("ColumnarStructureArray can not store NULL elements");
+}
+
+} // namespace
+
+namespace epics { namespace pvData {
+
+ColumnarStructureArray::ColumnarStructureArray(StructureConstPtr const & elementType)
+    :elementType(elementType)
+    ,length(0)
+    ,rowSize(1)
+{
+    if(!elementType)
+        throw std::invalid_argument("ColumnarStructureArray: NULL element Structure");
+
+    std::vector<string> names;
+    std::vector<ScalarType> types;
+    buildColumns(*elementType, string(), names, types);
+
+    columns.resize(names.size());
+    for(size_t i=0, N=columns.size(); i<N; i++) {
+        columns[i].name = names[i];
+        columns[i].type = types[i];
+        columns[i].data.set_original_type(types[i]);
+
+        if(types[i]==pvString)
+            rowSize = 0;
+        else if(rowSize)
+            rowSize += ScalarTypeFunc::elementSize(types[i]);
+    }
+}
+
+ColumnarStructureArray::~ColumnarStructureArray() {}
+
+size_t ColumnarStructureArray::getColumnIndex(string const & name) const
+{
+    for(size_t i=0, N=columns.size(); i<N; i++) {
+        if(columns[i].name==name)
+            return i;
+    }
+    return -1;
+}
+
+size_t ColumnarStructureArray::findColumn(string const & name) const
+{
+    size_t idx = getColumnIndex(name);
+    if(idx==size_t(-1))
+        throw std::out_of_range("ColumnarStructureArray has no column '"+name+"'");
+    return idx;
+}
+
+void ColumnarStructureArray::setLength(size_t newLength)
+{
+    if(newLength==length)
+        return;
+
+    std::vector<shared_vector<const void> > next(columns.size());
+
+    for(size_t i=0, N=columns.size(); i<N; i++) {
+        switch(columns[i].type) {
+#define CASE_REAL_INT64
+#define CASE_STRING
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv ## PVACODE: \
+            next[i] = resizeColumn<PVATYPE>(columns[i].data, newLength); break;
+#include <pv/typemap.h>
+#undef CASE
+#undef CASE_STRING
+#undef CASE_REAL_INT64
+        }
+    }
+
+    for(size_t i=0, N=columns.size(); i<N; i++)
+        columns[i].data.swap(next[i]);
+    length = newLength;
+}
+
+void ColumnarStructureArray::putColumn(size_t index, shared_vector<const void> const & data)
+{
+    Column& col = columns.at(index);
+    ScalarType stype = data.original_type();
+
+    if(data.empty() && length==0) {
+        return;
+
+    } else if(stype==col.type) {
+        if(data.size()!=length*ScalarTypeFunc::elementSize(stype))
+            throw std::length_error("ColumnarStructureArray::putColumn length mismatch");
+        col.data = data;
+
+    } else {
+        if(stype==(ScalarType)-1)
+            throw std::logic_error("ColumnarStructureArray::putColumn requires original_type()");
+        if(data.size()!=length*ScalarTypeFunc::elementSize(stype))
+            throw std::length_error("ColumnarStructureArray::putColumn length mismatch");
+
+        shared_vector<void> temp(ScalarTypeFunc::allocArray(col.type, length));
+        castUnsafeV(length, col.type, temp.data(), stype, data.data());
+        col.data = freeze(temp);
+    }
+}
+
+void ColumnarStructureArray::copyFrom(PVStructureArray const & from)
+{
+    if(from.getStructureArray()->getStructure()!=elementType)
+        throw std::invalid_argument("ColumnarStructureArray::copyFrom element Structure mismatch");
+
+    PVStructureArray::const_svector elems(from.view());
+    const size_t nrows = elems.size(),
+                 ncols = columns.size();
+
+    std::vector<const PVScalar*> leaves;
+    leaves.reserve(nrows*ncols);
+    for(size_t r=0; r<nrows; r++) {
+        if(!elems[r])
+            nullElement();
+        collectLeaves(*elems[r], leaves);
+    }
+
+    std::vector<shared_vector<const void> > next(ncols);
+
+    for(size_t c=0; c<ncols; c++) {
+        switch(columns[c].type) {
+#define CASE_REAL_INT64
+#define CASE_STRING
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv ## PVACODE: \
+            next[c] = gatherLeaves<PVATYPE>(leaves, c, ncols, nrows); break;
+#include <pv/typemap.h>
+#undef CASE
+#undef CASE_STRING
+#undef CASE_REAL_INT64
+        }
+    }
+
+    for(size_t c=0; c<ncols; c++)
+        columns[c].data.swap(next[c]);
+    length = nrows;
+}
+
+void ColumnarStructureArray::copyTo(PVStructureArray & to) const
+{
+    if(to.getStructureArray()->getStructure()!=elementType)
+        throw std::invalid_argument("ColumnarStructureArray::copyTo element Structure mismatch");
+
+    const size_t ncols = columns.size();
+
+    PVStructureArray::svector elems(length);
+    std::vector<PVScalar*> leaves;
+    leaves.reserve(length*ncols);
+
+    PVDataCreatePtr create(getPVDataCreate());
+    for(size_t r=0; r<length; r++) {
+        elems[r] = create->createPVStructure(elementType);
+        collectLeaves(*elems[r], leaves);
+    }
+
+    for(size_t c=0; c<ncols; c++) {
+        switch(columns[c].type) {
+#define CASE_REAL_INT64
+#define CASE_STRING
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv ## PVACODE: \
+            scatterLeaves<PVATYPE>(leaves, c, ncols, columns[c].data); break;
+#include <pv/typemap.h>
+#undef CASE
+#undef CASE_STRING
+#undef CASE_REAL_INT64
+        }
+    }
+
+    to.replace(freeze(elems));
+}
+
+void ColumnarStructureArray::serialize(ByteBuffer *pbuffer,
+        SerializableControl *pflusher) const
+{
+    SerializeHelper::writeSize(length, pbuffer, pflusher);
+
+    if(rowSize && rowSize<=pbuffer->getSize()) {
+        // all columns fixed width.  write as many whole rows as fit, one column at a time.
+        for(size_t row=0; row<length; ) {
+            if(pbuffer->getRemaining()<rowSize)
+                pflusher->ensureBuffer(rowSize);
+
+            const size_t base = pbuffer->getPosition(),
+                         count = std::min(length-row, pbuffer->getRemaining()/rowSize);
+
+            for(size_t i=0; i<count; i++)
+                pbuffer->put<int8>(base+i*rowSize, 1); // element not NULL
+
+            size_t pos = base+1;
+            for(size_t c=0, N=columns.size(); c<N; c++) {
+                const Column& col = columns[c];
+                switch(col.type) {
+#define CASE_REAL_INT64
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv ## PVACODE: \
+                    scatterColumn<PVATYPE>(pbuffer, pos, rowSize, \
+                                           static_cast<const PVATYPE*>(col.data.data())+row, count); \
+                    pos += sizeof(PVATYPE); break;
+#include <pv/typemap.h>
+#undef CASE
+#undef CASE_REAL_INT64
+                case pvString:
+                    break; // excluded by rowSize!=0
+                }
+            }
+
+            pbuffer->setPosition(base+count*rowSize);
+            row += count;
+        }
+
+    } else {
+        for(size_t row=0; row<length; row++) {
+            pflusher->ensureBuffer(1);
+            pbuffer->putByte(1);
+
+            for(size_t c=0, N=columns.size(); c<N; c++) {
+                const Column& col = columns[c];
+                switch(col.type) {
+#define CASE_REAL_INT64
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv ## PVACODE: \
+                    pflusher->ensureBuffer(sizeof(PVATYPE)); \
+                    pbuffer->put(static_cast<const PVATYPE*>(col.data.data())[row]); break;
+#include <pv/typemap.h>
+#undef CASE
+#undef CASE_REAL_INT64
+                case pvString:
+                    SerializeHelper::serializeString(static_cast<const string*>(col.data.data())[row],
+                                                     pbuffer, pflusher);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void ColumnarStructureArray::deserialize(ByteBuffer *pbuffer,
+        DeserializableControl *pcontrol)
+{
+    const size_t size = SerializeHelper::readSize(pbuffer, pcontrol);
+
+    std::vector<shared_vector<void> > next(columns.size());
+    for(size_t c=0, N=columns.size(); c<N; c++)
+        next[c] = ScalarTypeFunc::allocArray(columns[c].type, size);
+
+    if(rowSize && rowSize<=pbuffer->getSize()) {
+        for(size_t row=0; row<size; ) {
+            if(pbuffer->getRemaining()<rowSize)
+                pcontrol->ensureData(rowSize);
+
+            const size_t base = pbuffer->getPosition(),
+                         count = std::min(size-row, pbuffer->getRemaining()/rowSize);
+
+            for(size_t i=0; i<count; i++) {
+                if(pbuffer->getByte(base+i*rowSize)==0)
+                    nullElement();
+            }
+
+            size_t pos = base+1;
+            for(size_t c=0, N=columns.size(); c<N; c++) {
+                switch(columns[c].type) {
+#define CASE_REAL_INT64
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv ## PVACODE: \
+                    gatherColumn<PVATYPE>(pbuffer, pos, rowSize, \
+                                          static_cast<PVATYPE*>(next[c].data())+row, count); \
+                    pos += sizeof(PVATYPE); break;
+#include <pv/typemap.h>
+#undef CASE
+#undef CASE_REAL_INT64
+                case pvString:
+                    break; // excluded by rowSize!=0
+                }
+            }
+
+            pbuffer->setPosition(base+count*rowSize);
+            row += count;
+        }
+
+    } else {
+        for(size_t row=0; row<size; row++) {
+            pcontrol->ensureData(1);
+            if(pbuffer->getByte()==0)
+                nullElement();
+
+            for(size_t c=0, N=columns.size(); c<N; c++) {
+                switch(columns[c].type) {
+#define CASE_REAL_INT64
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv ## PVACODE: \
+                    pcontrol->ensureData(sizeof(PVATYPE)); \
+                    static_cast<PVATYPE*>(next[c].data())[row] = pbuffer->GET(PVATYPE); break;
+#include <pv/typemap.h>
+#undef CASE
+#undef CASE_REAL_INT64
+                case pvString:
+                    static_cast<string*>(next[c].data())[row] = SerializeHelper::deserializeString(pbuffer, pcontrol);
+                    break;
+                }
+            }
+        }
+    }
+
+    for(size_t c=0, N=columns.size(); c<N; c++)
+        columns[c].data = freeze(next[c]);
+    length = size;
+}
+
+}} // namespace epics::pvData
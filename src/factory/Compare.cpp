@@ -10,8 +10,11 @@
 #include <iterator>
 #include <sstream>
 
+#include <string.h>
+
 #define epicsExportSharedSymbols
 #include <pv/pvData.h>
+#include <pv/bitSet.h>
 
 using std::string;
 
@@ -156,6 +159,10 @@ template<typename T>
 bool compareArray(const PVValueArray<T>* left, const PVValueArray<T>* right)
 {
     typename PVValueArray<T>::const_svector lhs(left->view()), rhs(right->view());
+    if(lhs.size()!=rhs.size())
+        return false;
+    if(!lhs.empty() && lhs.same(rhs))
+        return true;
     return std::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
@@ -345,4 +352,128 @@ bool operator==(const PVField& left, const PVField& right)
     throw std::logic_error("PVField with invalid type!");
 }
 
+// field by field difference
+
+namespace {
+
+// compare by bit pattern
+template<typename T>
+bool sameValue(const PVField* left, const PVField* right)
+{
+    T a = static_cast<const PVScalarValue<T>*>(left)->get(),
+      b = static_cast<const PVScalarValue<T>*>(right)->get();
+    return memcmp(&a, &b, sizeof(T))==0;
+}
+
+template<>
+bool sameValue<string>(const PVField* left, const PVField* right)
+{
+    return static_cast<const PVString*>(left)->get()==static_cast<const PVString*>(right)->get();
+}
+
+template<typename T>
+bool sameArray(const PVField* left, const PVField* right)
+{
+    typename PVValueArray<T>::const_svector lhs(static_cast<const PVValueArray<T>*>(left)->view()),
+                                            rhs(static_cast<const PVValueArray<T>*>(right)->view());
+    if(lhs.size()!=rhs.size())
+        return false;
+    if(!lhs.empty() && lhs.same(rhs))
+        return true;
+    return memcmp(lhs.data(), rhs.data(), lhs.size()*sizeof(T))==0;
+}
+
+template<>
+bool sameArray<string>(const PVField* left, const PVField* right)
+{
+    PVStringArray::const_svector lhs(static_cast<const PVStringArray*>(left)->view()),
+                                 rhs(static_cast<const PVStringArray*>(right)->view());
+    if(lhs.size()!=rhs.size())
+        return false;
+    if(!lhs.empty() && lhs.same(rhs))
+        return true;
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+bool sameLeaf(const PVField* left, const PVField* right)
+{
+    const Field *type = left->getField().get();
+    switch(type->getType()) {
+    case scalar:
+        switch(static_cast<const Scalar*>(type)->getScalarType()) {
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv ## PVACODE: return sameValue<PVATYPE>(left, right);
+#define CASE_REAL_INT64
+#define CASE_STRING
+#include <pv/typemap.h>
+#undef CASE_STRING
+#undef CASE_REAL_INT64
+#undef CASE
+        }
+        break;
+    case scalarArray:
+        switch(static_cast<const ScalarArray*>(type)->getElementType()) {
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv ## PVACODE: return sameArray<PVATYPE>(left, right);
+#define CASE_REAL_INT64
+#define CASE_STRING
+#include <pv/typemap.h>
+#undef CASE_STRING
+#undef CASE_REAL_INT64
+#undef CASE
+        }
+        break;
+    default:
+        return *left==*right;
+    }
+    throw std::logic_error("PVField with invalid scalar type!");
+}
+
+// structures are known to have the same Structure
+bool diffStructure(const PVStructure& left, const PVStructure& right, BitSet& changed, bool update)
+{
+    const PVFieldPtrArray& lf = left.getPVFields();
+    const PVFieldPtrArray& rf = right.getPVFields();
+    bool any = false;
+
+    for(size_t i=0, N=lf.size(); i<N; i++) {
+        PVField *l = lf[i].get();
+        const PVField *r = rf[i].get();
+
+        if(l->getField()->getType()==structure) {
+            any |= diffStructure(static_cast<const PVStructure&>(*l),
+                                 static_cast<const PVStructure&>(*r), changed, update);
+
+        } else if(!sameLeaf(l, r)) {
+            changed.set(l->getFieldOffset());
+            if(update)
+                l->copyUnchecked(*r);
+            any = true;
+        }
+    }
+    return any;
+}
+
+void checkSameStructure(const PVStructure& a, const PVStructure& b)
+{
+    if(a.getStructure().get()!=b.getStructure().get())
+        throw std::invalid_argument("diff() requires structures of the same type");
+}
+
+} // namespace
+
+bool diff(const PVStructure& a, const PVStructure& b, BitSet& changed)
+{
+    checkSameStructure(a, b);
+    if(&a==&b)
+        return false;
+    return diffStructure(a, b, changed, false);
+}
+
+bool diffUpdate(PVStructure& snapshot, const PVStructure& current, BitSet& changed)
+{
+    checkSameStructure(snapshot, current);
+    if(&snapshot==&current)
+        return false;
+    return diffStructure(snapshot, current, changed, true);
+}
+
 }} // namespace epics::pvData
@@ -13,10 +13,13 @@
 #include <cstdio>
 #include <stdexcept>
 #include <sstream>
+#include <map>
 
 #include <epicsString.h>
+#include <epicsAssert.h>
 #include <epicsMutex.h>
 #include <epicsThread.h>
+#include <epicsAtomic.h>
 
 #define epicsExportSharedSymbols
 #include <pv/reftrack.h>
@@ -27,6 +30,8 @@
 #include <pv/thread.h>
 #include <pv/pvData.h>
 
+#include "dbDefs.h" // for NELEMENTS
+
 using std::tr1::static_pointer_cast;
 using std::size_t;
 using std::string;
@@ -35,6 +40,109 @@ namespace epics { namespace pvData {
 
 size_t Field::num_instances;
 
+namespace {
+// incremented when an ID is added to the registry.
+// Read without locking by Field::getTypeTag()
+size_t tagGeneration;
+
+struct TagRegistry {
+    Mutex lock;
+    typedef std::map<string, int32> tags_t;
+    tags_t tags;
+    int32 next;
+
+    TagRegistry() :next(TypeTag::FirstUser) {
+        static const char* const builtin[] = {
+            "alarm_t", "time_t", "display_t", "control_t", "enum_t", "valueAlarm_t",
+            "epics:nt/NTScalar:1",
+            "epics:nt/NTScalarArray:1",
+            "epics:nt/NTEnum:1",
+            "epics:nt/NTMatrix:1",
+            "epics:nt/NTNameValue:1",
+            "epics:nt/NTTable:1",
+            "epics:nt/NTURI:1",
+            "epics:nt/NTNDArray:1",
+            "epics:nt/NTAttribute:1",
+            "epics:nt/NTMultiChannel:1",
+            "epics:nt/NTScalarMultiChannel:1",
+            "epics:nt/NTHistogram:1",
+            "epics:nt/NTAggregate:1",
+            "epics:nt/NTContinuum:1",
+            "epics:nt/NTUnion:1",
+            "epics:nt/NTStructureArray:1",
+            "epics:nt/NTUnionArray:1",
+        };
+        for(size_t i=0; i<NELEMENTS(builtin); i++)
+            tags[builtin[i]] = int32(TypeTag::Alarm+i);
+        assert(TypeTag::Alarm+NELEMENTS(builtin)==size_t(TypeTag::FirstUser));
+    }
+
+    static size_t skipDigits(const string& id, size_t pos) {
+        while(pos<id.size() && id[pos]>='0' && id[pos]<='9')
+            pos++;
+        return pos;
+    }
+
+    // "name:1.2" -> "name:1".  Anything else, eg. "name:1.2[]", is unchanged
+    static string key(const string& id) {
+        size_t colon = id.find_last_of(':');
+        if(colon==string::npos)
+            return id;
+        size_t dot = skipDigits(id, colon+1u);
+        if(dot==colon+1u || dot>=id.size() || id[dot]!='.')
+            return id;
+        size_t end = skipDigits(id, dot+1u);
+        if(end==dot+1u || end!=id.size())
+            return id;
+        return id.substr(0, dot);
+    }
+
+    // call with lock held
+    int32 find(const string& id) const {
+        tags_t::const_iterator it(tags.find(key(id)));
+        return it==tags.end() ? int32(TypeTag::Unknown) : it->second;
+    }
+};
+
+TagRegistry *tagRegistry;
+epicsThreadOnceId tagRegistryOnce = EPICS_THREAD_ONCE_INIT;
+
+void tagRegistryInit(void *)
+{
+    tagRegistry = new TagRegistry; // never free'd
+}
+
+TagRegistry& getTagRegistry()
+{
+    epicsThreadOnce(&tagRegistryOnce, &tagRegistryInit, 0);
+    return *tagRegistry;
+}
+} // namespace
+
+int32 TypeTag::add(const std::string& id)
+{
+    TagRegistry& R = getTagRegistry();
+    Lock G(R.lock);
+    int32 ret = R.find(id);
+    if(ret==Unknown) {
+        // tags must fit in the lower 16 bits of Field::m_tag
+        if(R.next>0xffff)
+            throw std::length_error("Too many type IDs registered");
+        ret = R.next;
+        R.tags[TagRegistry::key(id)] = ret;
+        R.next++;
+        epics::atomic::increment(tagGeneration);
+    }
+    return ret;
+}
+
+int32 TypeTag::lookup(const std::string& id)
+{
+    TagRegistry& R = getTagRegistry();
+    Lock G(R.lock);
+    return R.find(id);
+}
+
 
 struct Field::Helper {
     static unsigned hash(Field *fld) {
@@ -46,6 +154,10 @@ struct Field::Helper {
         fld->m_hash = H;
         return H;
     }
+    // the tag of a well known ID is found once, when a Structure or Union is created
+    static void initTag(Field *fld, const string& id) {
+        fld->m_tag = TypeTag::lookup(id);
+    }
 };
 
 struct FieldCreate::Helper {
@@ -81,6 +193,8 @@ struct FieldCreate::Helper {
 Field::Field(Type type)
     : m_fieldType(type)
     , m_hash(0)
+    , m_tag(TypeTag::Unknown)
+    , m_lateTag(0)
 {
     REFTRACE_INCREMENT(num_instances);
 }
@@ -89,6 +203,26 @@ Field::~Field() {
     REFTRACE_DECREMENT(num_instances);
 }
 
+int32 Field::lateTypeTag() const
+{
+    // cache the tag, with the generation of the registry it was found in.
+    // An Unknown tag must be found again after add().
+    size_t cached = epics::atomic::get(m_lateTag);
+    size_t gen = epics::atomic::get(tagGeneration);
+    if((cached>>16)==gen+1u)
+        return int32(cached&0xffffu);
+
+    TagRegistry& R = getTagRegistry();
+    int32 tag;
+    {
+        Lock G(R.lock);
+        tag = R.find(getID());
+        gen = epics::atomic::get(tagGeneration);
+    }
+    epics::atomic::set(m_lateTag, ((gen+1u)<<16) | size_t(tag));
+    return tag;
+}
+
 void Field::cacheCleanup()
 {
     const FieldCreatePtr& create(getFieldCreate());
@@ -133,7 +267,7 @@ std::ostream& Scalar::dump(std::ostream& o) const
     return o << format::indent() << getID();
 }
 
-string Scalar::getID() const
+const string& Scalar::getID() const
 {
     static const string idScalarLUT[] = {
         "boolean", // pvBoolean
@@ -177,6 +311,10 @@ void Scalar::serialize(ByteBuffer *buffer, SerializableControl *control) const {
     buffer->putByte(getTypeCodeLUT(scalarType));
 }
 
+std::size_t Scalar::getSerializedSize() const {
+    return 1;
+}
+
 void Scalar::deserialize(ByteBuffer* /*buffer*/, DeserializableControl* /*control*/) {
     // must be done via FieldCreate
     throw std::runtime_error("not valid operation, use FieldCreate::deserialize instead");
@@ -190,11 +328,9 @@ std::tr1::shared_ptr<PVScalar> Scalar::build() const
 
 
 
-std::string BoundedString::getID() const
+const std::string& BoundedString::getID() const
 {
-    std::ostringstream id;
-    id << Scalar::getID() << '(' << maxLength << ')';
-    return id.str();
+    return id;
 }
 
 void BoundedString::serialize(ByteBuffer *buffer, SerializableControl *control) const
@@ -204,6 +340,11 @@ void BoundedString::serialize(ByteBuffer *buffer, SerializableControl *control)
     SerializeHelper::writeSize(maxLength, buffer, control);
 }
 
+std::size_t BoundedString::getSerializedSize() const
+{
+    return 1 + SerializeHelper::getSizeSerializedSize(maxLength);
+}
+
 std::size_t BoundedString::getMaximumLength() const
 {
     return maxLength;
@@ -214,6 +355,9 @@ BoundedString::BoundedString(std::size_t maxStringLength) :
 {
     if (maxLength == 0)
         THROW_EXCEPTION2(std::invalid_argument, "maxLength == 0");
+    std::ostringstream strm;
+    strm << Scalar::getID() << '(' << maxLength << ')';
+    id = strm.str();
 }
 
 BoundedString::~BoundedString()
@@ -243,6 +387,18 @@ static void serializeStructureField(const Structure* structure, ByteBuffer* buff
     }
 }
 
+static std::size_t getStructureFieldSerializedSize(const std::string& id, const std::string& defaultId,
+                                                   StringArray const & fieldNames,
+                                                   FieldConstPtrArray const & fields)
+{
+    std::size_t size = id==defaultId ? SerializeHelper::getSizeSerializedSize(0)
+                                     : SerializeHelper::getStringSerializedSize(id);
+    size += SerializeHelper::getSizeSerializedSize(fields.size());
+    for (std::size_t i = 0; i < fields.size(); i++)
+        size += SerializeHelper::getStringSerializedSize(fieldNames[i]) + fields[i]->getSerializedSize();
+    return size;
+}
+
 static StructureConstPtr deserializeStructureField(const FieldCreate* fieldCreate, ByteBuffer* buffer, DeserializableControl* control)
 {
     string id = SerializeHelper::deserializeString(buffer, control);
@@ -320,7 +476,7 @@ ScalarArray::~ScalarArray()
     cacheCleanup();
 }
 
-const string ScalarArray::getIDScalarArrayLUT() const
+const string& ScalarArray::getIDScalarArrayLUT() const
 {
     static const string idScalarArrayLUT[] = {
         "boolean[]", // pvBoolean
@@ -339,7 +495,7 @@ const string ScalarArray::getIDScalarArrayLUT() const
     return idScalarArrayLUT[elementType];
 }
 
-string ScalarArray::getID() const
+const string& ScalarArray::getID() const
 {
     return getIDScalarArrayLUT();
 }
@@ -354,6 +510,10 @@ void ScalarArray::serialize(ByteBuffer *buffer, SerializableControl *control) co
     buffer->putByte((int8)0x08 | Scalar::getTypeCodeLUT(elementType));
 }
 
+std::size_t ScalarArray::getSerializedSize() const {
+    return 1;
+}
+
 void ScalarArray::deserialize(ByteBuffer* /*buffer*/, DeserializableControl* /*control*/) {
     throw std::runtime_error("not valid operation, use FieldCreate::deserialize instead");
 }
@@ -373,13 +533,14 @@ BoundedScalarArray::BoundedScalarArray(ScalarType elementType, size_t size)
     : ScalarArray(elementType),
       size(size)
 {
+    char buffer[32];
+    sprintf(buffer, "%s<%zu>", ScalarTypeFunc::name(getElementType()), size);
+    id = buffer;
 }
 
-string BoundedScalarArray::getID() const
+const string& BoundedScalarArray::getID() const
 {
-    char buffer[32];
-    sprintf(buffer, "%s<%zu>", ScalarTypeFunc::name(getElementType()), size);
-    return string(buffer);
+    return id;
 }
 
 void BoundedScalarArray::serialize(ByteBuffer *buffer, SerializableControl *control) const {
@@ -388,6 +549,10 @@ void BoundedScalarArray::serialize(ByteBuffer *buffer, SerializableControl *cont
     SerializeHelper::writeSize(size, buffer, control);
 }
 
+std::size_t BoundedScalarArray::getSerializedSize() const {
+    return 1 + SerializeHelper::getSizeSerializedSize(size);
+}
+
 
 FixedScalarArray::~FixedScalarArray()
 {
@@ -398,13 +563,14 @@ FixedScalarArray::FixedScalarArray(ScalarType elementType, size_t size)
     : ScalarArray(elementType),
       size(size)
 {
+    char buffer[32];
+    sprintf(buffer, "%s[%zu]", ScalarTypeFunc::name(getElementType()), size);
+    id = buffer;
 }
 
-string FixedScalarArray::getID() const
+const string& FixedScalarArray::getID() const
 {
-    char buffer[32];
-    sprintf(buffer, "%s[%zu]", ScalarTypeFunc::name(getElementType()), size);
-    return string(buffer);
+    return id;
 }
 
 void FixedScalarArray::serialize(ByteBuffer *buffer, SerializableControl *control) const {
@@ -413,10 +579,14 @@ void FixedScalarArray::serialize(ByteBuffer *buffer, SerializableControl *contro
     SerializeHelper::writeSize(size, buffer, control);
 }
 
+std::size_t FixedScalarArray::getSerializedSize() const {
+    return 1 + SerializeHelper::getSizeSerializedSize(size);
+}
+
 
 
 StructureArray::StructureArray(StructureConstPtr const & structure)
-: Array(structureArray),pstructure(structure)
+: Array(structureArray),pstructure(structure),id(structure->getID() + "[]")
 {
 }
 
@@ -425,9 +595,9 @@ StructureArray::~StructureArray()
     cacheCleanup();
 }
 
-string StructureArray::getID() const
+const string& StructureArray::getID() const
 {
-    return pstructure->getID() + "[]";
+    return id;
 }
 
 std::ostream& StructureArray::dump(std::ostream& o) const
@@ -446,6 +616,10 @@ void StructureArray::serialize(ByteBuffer *buffer, SerializableControl *control)
     control->cachedSerialize(pstructure, buffer);
 }
 
+std::size_t StructureArray::getSerializedSize() const {
+    return 1 + pstructure->getSerializedSize();
+}
+
 void StructureArray::deserialize(ByteBuffer* /*buffer*/, DeserializableControl* /*control*/) {
     throw std::runtime_error("not valid operation, use FieldCreate::deserialize instead");
 }
@@ -456,7 +630,7 @@ std::tr1::shared_ptr<PVValueArray<std::tr1::shared_ptr<PVStructure> > > Structur
 }
 
 UnionArray::UnionArray(UnionConstPtr const & _punion)
-: Array(unionArray),punion(_punion)
+: Array(unionArray),punion(_punion),id(_punion->getID() + "[]")
 {
 }
 
@@ -465,9 +639,9 @@ UnionArray::~UnionArray()
     cacheCleanup();
 }
 
-string UnionArray::getID() const
+const string& UnionArray::getID() const
 {
-    return punion->getID() + "[]";
+    return id;
 }
 
 std::ostream& UnionArray::dump(std::ostream& o) const
@@ -494,6 +668,10 @@ void UnionArray::serialize(ByteBuffer *buffer, SerializableControl *control) con
     }
 }
 
+std::size_t UnionArray::getSerializedSize() const {
+    return punion->isVariant() ? 1 : 1 + punion->getSerializedSize();
+}
+
 void UnionArray::deserialize(ByteBuffer* /*buffer*/, DeserializableControl* /*control*/) {
     throw std::runtime_error("not valid operation, use FieldCreate::deserialize instead");
 }
@@ -518,7 +696,9 @@ Structure::Structure (
 : Field(structure),
       fieldNames(fieldNames),
       fields(infields),
-      id(inid)
+      id(inid),
+      layout(0),
+      memberIndices(0)
 {
     if(inid.empty()) {
         THROW_EXCEPTION2(std::invalid_argument, "Can't construct Structure, id is empty string");
@@ -545,15 +725,169 @@ Structure::Structure (
             }
         }
     }
+
+    serializedSize = 1 + getStructureFieldSerializedSize(id, defaultId(), fieldNames, fields);
+    Field::Helper::initTag(this, id);
+
+    // split the serialized size of a PVStructure value into the part which
+    // is the same for every value, and the fields which must be visited.
+    fixedValueSize = 0;
+    packedValue = true;
+    for(size_t i=0; i<number; i++) {
+        const Field *field = fields[i].get();
+        switch(field->getType()) {
+        case scalar: {
+            ScalarType stype = static_cast<const Scalar*>(field)->getScalarType();
+            if(stype!=pvString) {
+                fixedValueSize += ScalarTypeFunc::elementSize(stype);
+                continue;
+            }
+            break;
+        }
+        case scalarArray: {
+            const ScalarArray *array = static_cast<const ScalarArray*>(field);
+            if(array->getArraySizeType()==Array::fixed && array->getElementType()!=pvString) {
+                fixedValueSize += array->getMaximumCapacity()*ScalarTypeFunc::elementSize(array->getElementType());
+                packedValue = false;
+                continue;
+            }
+            break;
+        }
+        case structure: {
+            const Structure *sub = static_cast<const Structure*>(field);
+            fixedValueSize += sub->fixedValueSize;
+            packedValue &= sub->packedValue;
+            if(sub->variableValueFields.empty())
+                continue;
+            break;
+        }
+        default:
+            break;
+        }
+        variableValueFields.push_back(i);
+        packedValue = false;
+    }
 }
 
+struct Structure::MemberIndices {
+    const MemberSet *members;
+    MemberIndices *next;
+    bool found;
+    std::vector<uint32> index;
+};
+
 Structure::~Structure()
 {
     cacheCleanup();
+    delete static_cast<Layout*>(layout);
+    MemberIndices *ent = static_cast<MemberIndices*>(memberIndices);
+    while(ent) {
+        MemberIndices *next = ent->next;
+        delete ent;
+        ent = next;
+    }
+}
+
+namespace {
+const string& noName()
+{
+    static const string empty;
+    return empty;
 }
 
+void buildLayout(Structure::Layout& table, const Structure& type, uint32 parent)
+{
+    const FieldConstPtrArray& fields = type.getFields();
+    const StringArray& names = type.getFieldNames();
+    for(size_t i=0, N=fields.size(); i<N; i++) {
+        const uint32 self = uint32(table.size());
+        Structure::LayoutEntry entry;
+        entry.nextOffset = self+1u;
+        entry.parentOffset = parent;
+        entry.memberIndex = uint32(i);
+        entry.field = fields[i].get();
+        entry.name = &names[i];
+        table.push_back(entry);
+
+        if(fields[i]->getType()==structure) {
+            buildLayout(table, static_cast<const Structure&>(*fields[i]), self);
+            table[self].nextOffset = uint32(table.size());
+        }
+    }
+}
+} // namespace
+
+const Structure::Layout& Structure::getLayout() const
+{
+    void *cur = epics::atomic::get(layout);
+    if(cur)
+        return *static_cast<Layout*>(cur);
+
+    // Built without locking.  When racing, the first to finish wins.
+    epics::auto_ptr<Layout> table(new Layout);
+    Structure::LayoutEntry top;
+    top.nextOffset = 1u;
+    top.parentOffset = 0u;
+    top.memberIndex = 0u;
+    top.field = this;
+    top.name = &noName();
+    table->push_back(top);
+    buildLayout(*table, *this, 0u);
+    (*table)[0].nextOffset = uint32(table->size());
+
+    cur = epics::atomic::compareAndSwap(layout, (void*)0, (void*)table.get());
+    if(cur)
+        return *static_cast<Layout*>(cur); // lost the race
+    return *table.release();
+}
+
+const uint32* Structure::getMemberIndices(const MemberSet& members) const
+{
+    void *head = epics::atomic::get(memberIndices);
+    for(const MemberIndices *ent = static_cast<const MemberIndices*>(head); ent; ent = ent->next) {
+        if(ent->members==&members)
+            return ent->found ? &ent->index[0] : NULL;
+    }
+
+    epics::auto_ptr<MemberIndices> ent(new MemberIndices);
+    ent->members = &members;
+    ent->found = members.count>0u;
+    ent->index.resize(members.count ? members.count : 1u, 0u);
+
+    for(size_t i=0; ent->found && i<members.count; i++) {
+        size_t idx = 0u, N = fieldNames.size();
+        while(idx<N && fieldNames[idx]!=members.names[i])
+            idx++;
 
-string Structure::getID() const
+        if(idx==N || fields[idx]->getType()!=members.types[i]) {
+            ent->found = false;
+
+        } else if(members.types[i]==scalar) {
+            ent->found = static_cast<const Scalar&>(*fields[idx]).getScalarType()==members.scalarTypes[i];
+
+        } else if(members.types[i]==scalarArray) {
+            ent->found = static_cast<const ScalarArray&>(*fields[idx]).getElementType()==members.scalarTypes[i];
+        }
+        ent->index[i] = uint32(idx);
+    }
+
+    // prepend to the list.  When racing for the same MemberSet, the first to finish wins.
+    while(true) {
+        ent->next = static_cast<MemberIndices*>(head);
+        void *prev = epics::atomic::compareAndSwap(memberIndices, head, (void*)ent.get());
+        if(prev==head)
+            break;
+        for(const MemberIndices *other = static_cast<const MemberIndices*>(prev); other!=head; other = other->next) {
+            if(other->members==&members)
+                return other->found ? &other->index[0] : NULL;
+        }
+        head = prev;
+    }
+    const MemberIndices *ret = ent.release();
+    return ret->found ? &ret->index[0] : NULL;
+}
+
+const string& Structure::getID() const
 {
     return id;
 }
@@ -654,6 +988,10 @@ void Structure::serialize(ByteBuffer *buffer, SerializableControl *control) cons
     serializeStructureField(this, buffer, control);
 }
 
+std::size_t Structure::getSerializedSize() const {
+    return serializedSize;
+}
+
 void Structure::deserialize(ByteBuffer* /*buffer*/, DeserializableControl* /*control*/) {
     throw std::runtime_error("not valid operation, use FieldCreate::deserialize instead");
 }
@@ -683,7 +1021,8 @@ Union::Union ()
 : Field(union_),
       fieldNames(),
       fields(),
-      id(anyId())
+      id(anyId()),
+      serializedSize(1)
 {
 }
 
@@ -726,6 +1065,9 @@ Union::Union (
             }
         }
     }
+
+    serializedSize = fields.empty() ? 1 : 1 + getStructureFieldSerializedSize(id, defaultId(), fieldNames, fields);
+    Field::Helper::initTag(this, id);
 }
 
 Union::~Union()
@@ -769,7 +1111,7 @@ int32 Union::guess(Type t, ScalarType s) const
     return ret;
 }
 
-string Union::getID() const
+const string& Union::getID() const
 {
     return id;
 }
@@ -875,6 +1217,10 @@ void Union::serialize(ByteBuffer *buffer, SerializableControl *control) const {
     }
 }
 
+std::size_t Union::getSerializedSize() const {
+    return serializedSize;
+}
+
 void Union::deserialize(ByteBuffer* /*buffer*/, DeserializableControl* /*control*/) {
     throw std::runtime_error("not valid operation, use FieldCreate::deserialize instead");
 }
@@ -116,6 +116,18 @@ void PVScalarValue<std::string>::serialize(ByteBuffer *pbuffer,
     SerializeHelper::serializeString(storage.value, pbuffer, pflusher);
 }
 
+template<typename T>
+size_t PVScalarValue<T>::getSerializedSize() const
+{
+    return sizeof(T);
+}
+
+template<>
+size_t PVScalarValue<std::string>::getSerializedSize() const
+{
+    return SerializeHelper::getStringSerializedSize(storage.value);
+}
+
 template<typename T>
 void PVScalarValue<T>::deserialize(ByteBuffer *pbuffer,
     DeserializableControl *pflusher)
@@ -330,6 +342,7 @@ void PVValueArray<T>::deserialize(ByteBuffer *pbuffer,
     if (!pbuffer->reverse<T>())
         if (pcontrol->directDeserialize(pbuffer, (char*)cur, size, sizeof(T)))
         {
+        value = freeze(nextvalue);
         // inform about the change?
         PVField::postPut();
         return;
@@ -403,8 +416,30 @@ void PVValueArray<T>::serialize(ByteBuffer *pbuffer,
     }
 }
 
+template<typename T>
+size_t PVValueArray<T>::getSerializedSize() const
+{
+    size_t size = value.size()*sizeof(T);
+    if (this->getArray()->getArraySizeType() != Array::fixed)
+        size += SerializeHelper::getSizeSerializedSize(value.size());
+    return size;
+}
+
 // specializations for string
 
+template<>
+size_t PVValueArray<string>::getSerializedSize() const
+{
+    size_t size = 0;
+    if (this->getArray()->getArraySizeType() != Array::fixed)
+        size += SerializeHelper::getSizeSerializedSize(value.size());
+
+    const string * pvalue = value.data();
+    for(size_t i = 0; i<value.size(); i++)
+        size += SerializeHelper::getStringSerializedSize(pvalue[i]);
+    return size;
+}
+
 template<>
 void PVValueArray<string>::deserialize(ByteBuffer *pbuffer,
         DeserializableControl *pcontrol) {
@@ -458,7 +493,13 @@ void PVValueArray<T>::_getAsVoid(epics::pvData::shared_vector<const void>& out)
 template<typename T>
 void PVValueArray<T>::_putFromVoid(const epics::pvData::shared_vector<const void>& in)
 {
-    this->replace(shared_vector_convert<const T>(in));
+    const_svector next(shared_vector_convert<const T>(in));
+    if(!next.empty() && next.same(value)) {
+        // already referencing these elements
+        this->postPut();
+        return;
+    }
+    this->replace(next);
 }
 
 // Factory
@@ -714,6 +755,16 @@ PVUnionPtr PVDataCreate::createPVUnion(PVUnionPtr const & unionToClone)
     return punion;
 }
 
+void PVDataCreate::setArrayAllocator(ArrayAllocator::shared_pointer const & alloc)
+{
+    ArrayAllocator::install(alloc);
+}
+
+ArrayAllocator::shared_pointer PVDataCreate::getArrayAllocator() const
+{
+    return ArrayAllocator::current();
+}
+
 namespace detail {
 struct pvfield_factory {
     PVDataCreatePtr pvDataCreate;
@@ -10,14 +10,17 @@
 #include <cstdlib>
 #include <string>
 #include <cstdio>
+#include <iostream>
 
 #include <epicsMutex.h>
+#include <epicsAtomic.h>
 
 #define epicsExportSharedSymbols
 #include <pv/lock.h>
 #include <pv/pvData.h>
 #include <pv/factory.h>
 #include <pv/reftrack.h>
+#include <pv/bitSet.h>
 
 using std::tr1::const_pointer_cast;
 using std::size_t;
@@ -25,18 +28,47 @@ using std::string;
 
 namespace epics { namespace pvData {
 
+namespace {
+const string& emptyName()
+{
+    static const string empty;
+    return empty;
+}
+}
+
 size_t PVField::num_instances;
 
+namespace {
+// number of PostBatch open in all threads.
+// postPut() only looks for an open batch when non-zero.
+size_t activeBatches;
+}
+
+struct PVField::Extra {
+    PostHandlerPtr postHandler;
+    // for a PVStructure
+    PostBatchHandlerPtr batchHandler;
+    // number of open PostBatch, and the fields changed while open
+    unsigned batchDepth;
+    BitSet changed;
+    // copy of the field name once the parent, and its Structure, may be gone
+    std::string name;
+    Extra() :batchDepth(0u) {}
+};
+
 PVField::PVField(FieldConstPtr field)
-: parent(NULL),field(field),
+: fieldName(&emptyName()),
+  parent(NULL),field(field),
   fieldOffset(0), nextFieldOffset(0),
-  immutable(false)
+  immutable(false),
+  extra(NULL)
 {
     REFTRACE_INCREMENT(num_instances);
 }
 
 PVField::~PVField()
 {
+    delete extra;
     REFTRACE_DECREMENT(num_instances);
 }
 
@@ -64,24 +96,54 @@ void PVField::setImmutable() {immutable = true;}
 
 void PVField::postPut()
 {
-   if(postHandler) postHandler->postPut();
+   if(epics::atomic::get(activeBatches) && deferPost()) return;
+   if(extra && extra->postHandler) extra->postHandler->postPut();
+}
+
+bool PVField::deferPost() const
+{
+    bool deferred = false;
+    const size_t offset = getFieldOffset();
+    for(const PVField *cur = this; cur; cur = cur->parent) {
+        if(cur->extra && cur->extra->batchDepth) {
+            cur->extra->changed.set(uint32(offset - cur->getFieldOffset()));
+            deferred = true;
+        }
+    }
+    return deferred;
 }
 
 void PVField::setPostHandler(PostHandlerPtr const &handler)
 {
-    if(postHandler) {
-        if(postHandler.get()==handler.get()) return;
+    if(extra && extra->postHandler) {
+        if(extra->postHandler.get()==handler.get()) return;
         throw std::logic_error(
             "PVField::setPostHandler a postHandler is already registered");
 
     }
-    postHandler = handler;
+    if(!extra)
+        extra = new Extra;
+    extra->postHandler = handler;
 }
 
 void PVField::setParentAndName(PVStructure * xxx,string const & name)
 {
+    // name must be owned by the parent's Structure
     parent = xxx;
-    fieldName = name;
+    fieldName = &name;
+}
+
+void PVField::orphan(const PVStructure *oldParent)
+{
+    // a field may have been re-parented when shared with another PVStructure
+    if(parent!=oldParent) return;
+    parent = NULL;
+    if(fieldName->empty()) return;
+    // keep the name, as the field may still be a member of another PVStructure
+    if(!extra)
+        extra = new Extra;
+    extra->name = *fieldName;
+    fieldName = &extra->name;
 }
 
 bool PVField::equals(PVField &pv)
@@ -96,7 +158,7 @@ std::ostream& operator<<(std::ostream& o, const PVField& f)
 
 string PVField::getFullName() const
 {
-    string ret(fieldName);
+    string ret(*fieldName);
     for(const PVField *fld=getParent(); fld; fld=fld->getParent())
     {
         if(fld->getFieldName().size()==0) break;
@@ -132,8 +194,8 @@ void PVField::computeOffset(const PVField   *  pvField) {
         case union_:
         case unionArray: {
             nextOffset++;
-            pvField->fieldOffset = offset;
-            pvField->nextFieldOffset = nextOffset;
+            pvField->fieldOffset = uint32(offset);
+            pvField->nextFieldOffset = uint32(nextOffset);
             break;
         }
         case structure: {
@@ -145,7 +207,7 @@ void PVField::computeOffset(const PVField   *  pvField) {
     PVField *top = (PVField *)pvTop;
     PVField *xxx = const_cast<PVField *>(top);
     xxx->fieldOffset = 0;
-    xxx->nextFieldOffset = nextOffset;
+    xxx->nextFieldOffset = uint32(nextOffset);
 }
 
 void PVField::computeOffset(const PVField   *  pvField,size_t offset) {
@@ -164,8 +226,8 @@ void PVField::computeOffset(const PVField   *  pvField,size_t offset) {
             case union_:
             case unionArray: {
                 nextOffset++;
-                pvSubField->fieldOffset = offset;
-                pvSubField->nextFieldOffset = nextOffset;
+                pvSubField->fieldOffset = uint32(offset);
+                pvSubField->nextFieldOffset = uint32(nextOffset);
                 break;
             }
             case structure: {
@@ -175,8 +237,8 @@ void PVField::computeOffset(const PVField   *  pvField,size_t offset) {
         }
     }
     PVField *xxx = const_cast<PVField *>(pvField);
-    xxx->fieldOffset = beginOffset;
-    xxx->nextFieldOffset = nextOffset;
+    xxx->fieldOffset = uint32(beginOffset);
+    xxx->nextFieldOffset = uint32(nextOffset);
 }
 
 void PVField::copy(const PVField& from)
@@ -246,4 +308,76 @@ void PVField::copyUnchecked(const PVField& from)
 }
 
 
+void PVStructure::setPostBatchHandler(PostBatchHandlerPtr const &handler)
+{
+    if(extra && extra->batchHandler) {
+        if(extra->batchHandler.get()==handler.get()) return;
+        throw std::logic_error(
+            "PVStructure::setPostBatchHandler a postBatchHandler is already registered");
+    }
+    if(!extra)
+        extra = new Extra;
+    extra->batchHandler = handler;
+}
+
+void PVStructure::beginBatch()
+{
+    if(!extra)
+        extra = new Extra;
+    if(extra->batchDepth++==0u)
+        epics::atomic::increment(activeBatches);
+}
+
+void PVStructure::endBatch()
+{
+    if(--extra->batchDepth!=0u)
+        return;
+    epics::atomic::decrement(activeBatches);
+
+    // handlers may open a new batch
+    BitSet changed;
+    changed.swap(extra->changed);
+    if(changed.isEmpty())
+        return;
+
+    PostBatchHandlerPtr handler(extra->batchHandler);
+    if(handler) {
+        try {
+            handler->postPut(changed);
+        } catch(std::exception& e) {
+            std::cerr<<"Error from PostBatchHandler of "<<getFullName()<<" : "<<e.what()<<"\n";
+        }
+    }
+
+    // an enclosing batch has also recorded these changes
+    for(const PVStructure *up = getParent(); up; up = up->getParent()) {
+        if(up->extra && up->extra->batchDepth)
+            return;
+    }
+
+    const size_t base = getFieldOffset();
+    for(int32 bit = changed.nextSetBit(0); bit>=0; bit = changed.nextSetBit(bit+1)) {
+        PVFieldPtr fld(bit==0 ? shared_from_this() : getSubFieldT(base+bit));
+        PostHandlerPtr post(fld->extra ? fld->extra->postHandler : PostHandlerPtr());
+        if(!post)
+            continue;
+        try {
+            post->postPut();
+        } catch(std::exception& e) {
+            std::cerr<<"Error from PostHandler of "<<fld->getFullName()<<" : "<<e.what()<<"\n";
+        }
+    }
+}
+
+PVStructure::PostBatch::PostBatch(PVStructure& pvs)
+    :pvs(pvs)
+{
+    pvs.beginBatch();
+}
+
+PVStructure::PostBatch::~PostBatch()
+{
+    pvs.endBatch();
+}
+
 }}
@@ -60,7 +60,21 @@ PVStructure::PVStructure(StructureConstPtr const & structurePtr,
     }
 }
 
-PVStructure::~PVStructure() {}
+PVStructure::PVStructure(StructureConstPtr const & structurePtr,
+    PVFieldPtrArray& pvs, Snapshot)
+: PVField(structurePtr),
+  structurePtr(structurePtr),
+  extendsStructureName("")
+{
+    pvFields.swap(pvs);
+}
+
+PVStructure::~PVStructure()
+{
+    // sub-fields may outlive us, and refer to our Structure for their names
+    for(size_t i=0, N=pvFields.size(); i<N; i++)
+        pvFields[i]->orphan(this);
+}
 
 void PVStructure::setImmutable()
 {
@@ -72,13 +86,24 @@ void PVStructure::setImmutable()
     PVField::setImmutable();
 }
 
+namespace {
+// sub-field at an offset relative to top
+const PVFieldPtr& fieldAt(const PVStructure& top, const Structure::Layout& layout, uint32 offset)
+{
+    const Structure::LayoutEntry& entry = layout[offset];
+    const PVStructure& parent = entry.parentOffset==0u ? top
+            : static_cast<const PVStructure&>(*fieldAt(top, layout, entry.parentOffset));
+    return parent.getPVFields()[entry.memberIndex];
+}
+}
+
 PVFieldPtr  PVStructure::getSubFieldImpl(size_t fieldOffset, bool throws) const
 {
-    const PVStructure *current = this;
+    const size_t base = getFieldOffset();
+    const Structure::Layout& layout = structurePtr->getLayout();
 
-recurse:
     // we don't permit self lookup
-    if(fieldOffset<=current->getFieldOffset() || fieldOffset>=current->getNextFieldOffset()) {
+    if(fieldOffset<=base || fieldOffset-base>=layout.size()) {
         if(throws) {
             std::stringstream ss;
             ss << "Failed to get field with offset "
@@ -89,22 +114,7 @@ recurse:
         }
     }
 
-    for(size_t i=0, numFields = current->pvFields.size(); i<numFields; i++) {
-        const PVFieldPtr& pvField  = current->pvFields[i];
-
-        if(pvField->getFieldOffset()==fieldOffset) {
-            return pvField;
-
-        } else if(pvField->getNextFieldOffset()<=fieldOffset) {
-            continue;
-
-        } else if(pvField->getField()->getType()==structure) {
-            current = static_cast<PVStructure *>(pvField.get());
-            goto recurse;
-        }
-    }
-    // the first test against current->getNextFieldOffset() would avoid this
-    throw std::logic_error("PVStructure.getSubField: Logic error");
+    return fieldAt(*this, layout, uint32(fieldOffset-base));
 }
 
 PVFieldPtr PVStructure::getSubFieldImpl(const char *name, bool throws) const
@@ -215,8 +225,77 @@ void PVStructure::throwBadFieldType(std::size_t fieldOffset)
     throw std::runtime_error(ss.str());
 }
 
+namespace {
+// Largest packed value for which ensureBuffer()/ensureData() is called.
+// Larger values are only packed when already in the buffer, as
+// some controls limit the size which may be ensured.
+const size_t maxEnsurePacked = 256;
+}
+
+// Caller ensures that Structure::fixedValueSize bytes are available
+void PVStructure::serializePacked(ByteBuffer *pbuffer) const
+{
+    for(size_t i = 0, N = pvFields.size(); i<N; i++) {
+        const PVField *pvField = pvFields[i].get();
+        const Field *field = pvField->getField().get();
+
+        if(field->getType()==structure) {
+            static_cast<const PVStructure*>(pvField)->serializePacked(pbuffer);
+            continue;
+        }
+
+        switch(static_cast<const Scalar*>(field)->getScalarType()) {
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) \
+        case pv ## PVACODE: pbuffer->put(static_cast<const PVScalarValue<PVATYPE>*>(pvField)->storage.value); break;
+#define CASE_REAL_INT64
+#include <pv/typemap.h>
+#undef CASE_REAL_INT64
+#undef CASE
+        case pvString:
+            throw std::logic_error("string in packed Structure");
+        }
+    }
+}
+
+// Caller ensures that Structure::fixedValueSize bytes are available
+void PVStructure::deserializePacked(ByteBuffer *pbuffer)
+{
+    for(size_t i = 0, N = pvFields.size(); i<N; i++) {
+        PVField *pvField = pvFields[i].get();
+        const Field *field = pvField->getField().get();
+
+        if(field->getType()==structure) {
+            static_cast<PVStructure*>(pvField)->deserializePacked(pbuffer);
+            continue;
+        }
+
+        switch(static_cast<const Scalar*>(field)->getScalarType()) {
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) \
+        case pv ## PVACODE: static_cast<PVScalarValue<PVATYPE>*>(pvField)->storage.value = pbuffer->GET(PVATYPE); break;
+#define CASE_REAL_INT64
+#include <pv/typemap.h>
+#undef CASE_REAL_INT64
+#undef CASE
+        case pvString:
+            throw std::logic_error("string in packed Structure");
+        }
+    }
+}
+
 void PVStructure::serialize(ByteBuffer *pbuffer,
         SerializableControl *pflusher) const {
+    const Structure *pstructure = structurePtr.get();
+    if(pstructure->packedValue) {
+        // only fixed width scalars.  one check, then copy.
+        const size_t size = pstructure->fixedValueSize;
+        if(pbuffer->getRemaining()<size && size<=maxEnsurePacked)
+            pflusher->ensureBuffer(size);
+        if(pbuffer->getRemaining()>=size) {
+            serializePacked(pbuffer);
+            return;
+        }
+    }
+
     size_t fieldsSize = pvFields.size();
     for(size_t i = 0; i<fieldsSize; i++)
         pvFields[i]->serialize(pbuffer, pflusher);
@@ -224,6 +303,17 @@ void PVStructure::serialize(ByteBuffer *pbuffer,
 
 void PVStructure::deserialize(ByteBuffer *pbuffer,
         DeserializableControl *pcontrol) {
+    const Structure *pstructure = structurePtr.get();
+    if(pstructure->packedValue) {
+        const size_t size = pstructure->fixedValueSize;
+        if(pbuffer->getRemaining()<size && size<=maxEnsurePacked)
+            pcontrol->ensureData(size);
+        if(pbuffer->getRemaining()>=size) {
+            deserializePacked(pbuffer);
+            return;
+        }
+    }
+
     size_t fieldsSize = pvFields.size();
     for(size_t i = 0; i<fieldsSize; i++)
         pvFields[i]->deserialize(pbuffer, pcontrol);
@@ -266,6 +356,65 @@ void PVStructure::serialize(ByteBuffer *pbuffer,
     }
 }
 
+size_t PVStructure::getSerializedSize() const
+{
+    const Structure *pstructure = structurePtr.get();
+    size_t size = pstructure->fixedValueSize;
+    if(!pstructure->variableValueFields.empty())
+        size += getVariableSerializedSize();
+    return size;
+}
+
+// serialized size of the fields not included in Structure::fixedValueSize
+size_t PVStructure::getVariableSerializedSize() const
+{
+    const std::vector<size_t>& variable = structurePtr->variableValueFields;
+    size_t size = 0;
+    for(size_t i = 0, N = variable.size(); i<N; i++) {
+        const PVField *pvField = pvFields[variable[i]].get();
+        if(pvField->getField()->getType()==structure)
+            size += static_cast<const PVStructure*>(pvField)->getVariableSerializedSize();
+        else
+            size += pvField->getSerializedSize();
+    }
+    return size;
+}
+
+size_t PVStructure::getSerializedSize(const BitSet& bitSet) const
+{
+    size_t offset = getFieldOffset();
+    size_t numberFields = getNumberFields();
+    int32 next = bitSet.nextSetBit(static_cast<uint32>(offset));
+
+    // no more changes or no changes in this structure
+    if(next<0||next>=static_cast<int32>(offset+numberFields)) return 0;
+
+    // entire structure
+    if(static_cast<int32>(offset)==next)
+        return getSerializedSize();
+
+    size_t size = 0;
+    size_t fieldsSize = pvFields.size();
+    for(size_t i = 0; i<fieldsSize; i++) {
+        const PVField* pvField = pvFields[i].get();
+        offset = pvField->getFieldOffset();
+        int32 inumberFields = static_cast<int32>(pvField->getNumberFields());
+        next = bitSet.nextSetBit(static_cast<uint32>(offset));
+
+        // no more changes
+        if(next<0) break;
+        //  no change in this pvField
+        if(next>=static_cast<int32>(offset+inumberFields)) continue;
+
+        if(inumberFields==1) {
+            size += pvField->getSerializedSize();
+        } else {
+            size += static_cast<const PVStructure*>(pvField)->getSerializedSize(bitSet);
+        }
+    }
+    return size;
+}
+
 void PVStructure::deserialize(ByteBuffer *pbuffer,
         DeserializableControl *pcontrol, BitSet *pbitSet) {
     size_t offset = getFieldOffset();
@@ -351,6 +500,86 @@ void PVStructure::copyUnchecked(const PVStructure& from)
     }
 }
 
+PVStructure::const_shared_pointer PVStructure::snapshot(const BitSet& changed, const const_shared_pointer& previous) const
+{
+    if(previous && previous->structurePtr!=structurePtr && *previous->structurePtr!=*structurePtr)
+        throw std::invalid_argument("previous snapshot is of a different type");
+
+    const uint32 base = uint32(getFieldOffset());
+
+    if(!previous || changed.get(0)) {
+        PVStructurePtr ret(getPVDataCreate()->createPVStructure(structurePtr));
+        ret->copyUnchecked(*this);
+        ret->setImmutable();
+        detach(*ret, *this, base);
+        return ret;
+    }
+
+    // sub-fields of previous must already know their offsets, as they will not be re-computed
+    (void)previous->getNumberFields();
+    return snapshotOf(*this, *previous, changed, base);
+}
+
+PVStructurePtr PVStructure::snapshotOf(const PVStructure& current, const PVStructure& previous,
+                                       const BitSet& changed, uint32 base)
+{
+    const PVFieldPtrArray& from = current.pvFields;
+    PVFieldPtrArray fields(from.size());
+    // Use the Structure of previous, which holds the names of the shared sub-fields
+    const StringArray& names = previous.structurePtr->getFieldNames();
+
+    for(size_t i=0, N=from.size(); i<N; i++) {
+        const PVField& cur = *from[i];
+        const uint32 offset = uint32(cur.getFieldOffset()) - base,
+                     next = uint32(cur.getNextFieldOffset()) - base;
+        const int32 bit = changed.nextSetBit(offset);
+
+        if(bit<0 || uint32(bit)>=next) {
+            // unchanged
+            fields[i] = previous.pvFields[i];
+            continue;
+
+        } else if(uint32(bit)==offset) {
+            // changed, including all sub-fields
+            PVFieldPtr copy(getPVDataCreate()->createPVField(cur.getField()));
+            copy->copyUnchecked(cur);
+            copy->setImmutable();
+            detach(*copy, cur, base);
+            fields[i] = copy;
+
+        } else {
+            // some sub-fields changed
+            fields[i] = snapshotOf(static_cast<const PVStructure&>(cur),
+                                   static_cast<const PVStructure&>(*previous.pvFields[i]),
+                                   changed, base);
+        }
+        fields[i]->fieldName = &names[i];
+    }
+
+    PVStructurePtr ret(new PVStructure(previous.structurePtr, fields, Snapshot()));
+    ret->fieldOffset = uint32(current.getFieldOffset()) - base;
+    ret->nextFieldOffset = uint32(current.getNextFieldOffset()) - base;
+    // not setImmutable(), which would visit the shared sub-fields
+    ret->immutable = true;
+    return ret;
+}
+
+// Set the offsets of a copy of src, and remove its sub-fields from their parent,
+// so that they are not modified when shared with later snapshots.
+void PVStructure::detach(PVField& dest, const PVField& src, uint32 base)
+{
+    dest.fieldOffset = uint32(src.getFieldOffset()) - base;
+    dest.nextFieldOffset = uint32(src.getNextFieldOffset()) - base;
+    if(src.getField()->getType()==structure) {
+        const PVFieldPtrArray& to = static_cast<PVStructure&>(dest).pvFields;
+        const PVFieldPtrArray& from = static_cast<const PVStructure&>(src).pvFields;
+        for(size_t i=0, N=from.size(); i<N; i++) {
+            detach(*to[i], *from[i], base);
+            to[i]->parent = NULL;
+        }
+    }
+}
+
 void PVStructure::copyUnchecked(const PVStructure& from, const BitSet& maskBitSet, bool inverse)
 {
     if (this == &from)
@@ -212,6 +212,21 @@ void PVStructureArray::serialize(ByteBuffer *pbuffer,
     }
 }
 
+size_t PVStructureArray::getSerializedSize() const
+{
+    size_t size = 0;
+    if (this->getArray()->getArraySizeType() != Array::fixed)
+        size += SerializeHelper::getSizeSerializedSize(value.size());
+
+    // one byte for each element to mark NULL
+    size += value.size();
+    for(size_t i = 0; i<value.size(); i++) {
+        if(value[i].get())
+            size += value[i]->getSerializedSize();
+    }
+    return size;
+}
+
 std::ostream& PVStructureArray::dumpValue(std::ostream& o) const
 {
     o << format::indent() << getStructureArray()->getID() << ' ' << getFieldName() << std::endl;
@@ -40,8 +40,70 @@ PVUnion::PVUnion(UnionConstPtr const & unionPtr)
 
 #undef PVUNION_UNDEFINED_INDEX
 
+namespace {
+// number of replaced values kept by each PVUnion
+const size_t maxRecentValues = 4;
+
+// Only values of a fixed size are kept, so that the storage
+// of large arrays is not held after they are replaced.
+bool keepRecent(const Field& field)
+{
+    switch (field.getType())
+    {
+    case scalar:
+        return true;
+    case structure:
+    {
+        const Structure::Layout& layout = static_cast<const Structure&>(field).getLayout();
+        for (size_t i = 1; i < layout.size(); i++)
+        {
+            Type type = layout[i].field->getType();
+            if (type != scalar && type != structure)
+                return false;
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+}
+
 PVUnion::~PVUnion() {}
 
+// Make 'value' an instance of 'field', whose content will be overwritten.
+// Reuses the current value, or a recently replaced value which is not
+// referenced elsewhere.  Fields are interned by FieldCreate, so identity
+// is sufficient to match types.
+void PVUnion::prepareValue(FieldConstPtr const & field)
+{
+    if (value.get() && value->getField().get() == field.get())
+        return;
+
+    PVFieldPtr next;
+    for (size_t i = recent.size(); i > 0; i--)
+    {
+        PVFieldPtr& cand = recent[i-1];
+        if (cand->getField().get() == field.get() && cand.unique())
+        {
+            next.swap(cand);
+            recent.erase(recent.begin()+(i-1));
+            break;
+        }
+    }
+
+    if (!next.get())
+        next = pvDataCreate->createPVField(field);
+
+    if (value.get() && keepRecent(*value->getField()))
+    {
+        if (recent.size() >= maxRecentValues)
+            recent.erase(recent.begin());
+        recent.push_back(value);
+    }
+    value.swap(next);
+}
+
 string PVUnion::getSelectedFieldName() const
 {
     // no name for undefined and for variant unions
@@ -141,6 +203,23 @@ void PVUnion::serialize(ByteBuffer *pbuffer, SerializableControl *pflusher) cons
     }
 }
 
+size_t PVUnion::getSerializedSize() const
+{
+    if (variant)
+    {
+        if (value.get() == 0)
+            return 1;
+        return value->getField()->getSerializedSize() + value->getSerializedSize();
+    }
+    else
+    {
+        size_t size = SerializeHelper::getSizeSerializedSize(selector);
+        if (selector != UNDEFINED_INDEX)
+            size += value->getSerializedSize();
+        return size;
+    }
+}
+
 void PVUnion::deserialize(ByteBuffer *pbuffer, DeserializableControl *pcontrol)
 {
     if (variant)
@@ -149,8 +228,7 @@ void PVUnion::deserialize(ByteBuffer *pbuffer, DeserializableControl *pcontrol)
         if (field.get())
         {
             // try to reuse existing field instance
-            if (!value.get() || *value->getField() != *field)
-                value = pvDataCreate->createPVField(field);
+            prepareValue(field);
             value->deserialize(pbuffer, pcontrol);
         }
         else
@@ -162,12 +240,10 @@ void PVUnion::deserialize(ByteBuffer *pbuffer, DeserializableControl *pcontrol)
         selector = static_cast<int32>(SerializeHelper::readSize(pbuffer, pcontrol));
         if (selector != UNDEFINED_INDEX)
         {
-            if (selector != previousSelector)
+            if (selector != previousSelector || !value.get())
             {
-                FieldConstPtr field = unionPtr->getField(selector);
                 // try to reuse existing field instance
-                if (!value.get() || *value->getField() != *field)
-                    value = pvDataCreate->createPVField(field);
+                prepareValue(unionPtr->getField(selector));
             }
             value->deserialize(pbuffer, pcontrol);
         }
@@ -219,18 +295,9 @@ void PVUnion::copyUnchecked(const PVUnion& from)
         }
         else
         {
-            PVFieldPtr toValue = get();
-            if (toValue.get() == 0 || *toValue->getField() != *fromValue->getField())
-            {
-                toValue = pvDataCreate->createPVField(fromValue->getField());
-                toValue->copyUnchecked(*fromValue);
-                set(toValue);
-            }
-            else
-            {
-                toValue->copyUnchecked(*fromValue);
-                postPut();
-            }
+            prepareValue(fromValue->getField());
+            value->copyUnchecked(*fromValue);
+            postPut();
         }
     }
     else
@@ -211,6 +211,21 @@ void PVUnionArray::serialize(ByteBuffer *pbuffer,
     }
 }
 
+size_t PVUnionArray::getSerializedSize() const
+{
+    size_t size = 0;
+    if (this->getArray()->getArraySizeType() != Array::fixed)
+        size += SerializeHelper::getSizeSerializedSize(value.size());
+
+    // one byte for each element to mark NULL
+    size += value.size();
+    for(size_t i = 0; i<value.size(); i++) {
+        if(value[i].get())
+            size += value[i]->getSerializedSize();
+    }
+    return size;
+}
+
 std::ostream& PVUnionArray::dumpValue(std::ostream& o) const
 {
     o << format::indent() << getUnionArray()->getID() << ' ' << getFieldName() << std::endl;
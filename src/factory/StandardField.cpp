@@ -9,6 +9,7 @@
 #include <string>
 #include <cstdio>
 #include <stdexcept>
+#include <algorithm>
 
 #include <epicsMutex.h>
 #include <epicsThread.h>
@@ -101,23 +102,53 @@ StandardField::StandardField()
                           ->add("stateSeverity", pvInt)
                           ->add("changeStateSeverity", pvInt)
                           ->createStructure())
+
+    ,enumeratedField(FieldBuilder::begin()
+                     ->setId("enum_t")
+                     ->add("index", pvInt)
+                     ->addArray("choices", pvString)
+                     ->createStructure())
+    ,propPrune(64u)
 {}
 
 StandardField::~StandardField(){}
 
-StructureConstPtr StandardField::createProperties(string id,FieldConstPtr field,string properties)
+namespace {
+enum {
+    propAlarm = 1u,
+    propTimeStamp = 2u,
+    propDisplay = 4u,
+    propControl = 8u,
+    propValueAlarm = 16u
+};
+}
+
+StructureConstPtr StandardField::createProperties(const string& id,const FieldConstPtr& field,const string& properties)
 {
-    bool gotAlarm = false;
-    bool gotTimeStamp = false;
-    bool gotDisplay = false;
-    bool gotControl = false;
-    bool gotValueAlarm = false;
-    int numProp = 0;
-    if(properties.find("alarm")!=string::npos) { gotAlarm = true; numProp++; }
-    if(properties.find("timeStamp")!=string::npos) { gotTimeStamp = true; numProp++; }
-    if(properties.find("display")!=string::npos) { gotDisplay = true; numProp++; }
-    if(properties.find("control")!=string::npos) { gotControl = true; numProp++; }
-    if(properties.find("valueAlarm")!=string::npos) { gotValueAlarm = true; numProp++; }
+    unsigned mask = 0u;
+    if(properties.find("alarm")!=string::npos) mask |= propAlarm;
+    if(properties.find("timeStamp")!=string::npos) mask |= propTimeStamp;
+    if(properties.find("display")!=string::npos) mask |= propDisplay;
+    if(properties.find("control")!=string::npos) mask |= propControl;
+    if(properties.find("valueAlarm")!=string::npos) mask |= propValueAlarm;
+
+    const propKey_t key(id, std::make_pair(field.get(), mask));
+    {
+        Lock G(propLock);
+        propCache_t::const_iterator it(propCache.find(key));
+        if(it!=propCache.end()) {
+            StructureConstPtr ret(it->second.lock());
+            if(ret)
+                return ret;
+        }
+    }
+
+    const bool gotAlarm = mask&propAlarm;
+    const bool gotTimeStamp = mask&propTimeStamp;
+    const bool gotDisplay = mask&propDisplay;
+    const bool gotControl = mask&propControl;
+    const bool gotValueAlarm = mask&propValueAlarm;
+    int numProp = gotAlarm + gotTimeStamp + gotDisplay + gotControl + gotValueAlarm;
     StructureConstPtr valueAlarm;
     Type type= field->getType();
     while(gotValueAlarm) {
@@ -196,7 +227,20 @@ StructureConstPtr StandardField::createProperties(string id,FieldConstPtr field,
         names[next] = "valueAlarm";
         fields[next++] = valueAlarm;
     }
-    return fieldCreate->createStructure(id,names,fields);
+    StructureConstPtr ret(fieldCreate->createStructure(id,names,fields));
+
+    Lock G(propLock);
+    if(propCache.size()>=propPrune) {
+        for(propCache_t::iterator it(propCache.begin()); it!=propCache.end();) {
+            if(it->second.expired())
+                propCache.erase(it++);
+            else
+                ++it;
+        }
+        propPrune = std::max(size_t(64u), 2u*propCache.size());
+    }
+    propCache[key] = ret;
+    return ret;
 }
 
 StructureConstPtr StandardField::scalar(
@@ -246,14 +290,7 @@ StructureConstPtr StandardField::unionArray(
 
 StructureConstPtr StandardField::enumerated()
 {
-    size_t num = 2;
-    FieldConstPtrArray fields(num);
-    StringArray names(num);
-    names[0] = "index";
-    names[1] = "choices";
-    fields[0] = fieldCreate->createScalar(pvInt);
-    fields[1] = fieldCreate->createScalarArray(pvString);
-    return fieldCreate->createStructure("enum_t",names,fields);
+    return enumeratedField;
     // NOTE: if this method is used to get NTEnum without properties the ID will be wrong!
 }
 
@@ -11,10 +11,16 @@
 #define HAVE_ISATTY
 #endif
 
-#include <deque>
+#include <locale.h>
+#include <string.h>
+
+#include <limits>
+#include <locale>
+#include <sstream>
 
 #include <epicsTime.h>
 #include <epicsString.h>
+#include <epicsStdio.h>
 
 #define epicsExportSharedSymbols
 #include <pv/bitSet.h>
@@ -73,8 +79,377 @@ bool useEscapes(std::ostream& strm) {
 #endif
 }
 
+char hexdigit(char c) {
+    c &= 0xf;
+    if(c<9)
+        return '0'+c;
+    else
+        return 'A'+c-10;
+}
+
+void appendEscaped(std::string& out, const std::string& orig, escape::style_t S)
+{
+    for(size_t pos = 0, len = orig.size(); pos < len; pos++) {
+        const char C = orig[pos];
+        char quote = '\\', next;
+        // compare me with epicsStrnEscapedFromRaw()
+        switch(C) {
+        case '\a': next = 'a'; break;
+        case '\b': next = 'b'; break;
+        case '\f': next = 'f'; break;
+        case '\n': next = 'n'; break;
+        case '\r': next = 'r'; break;
+        case '\t': next = 't'; break;
+        case '\v': next = 'v'; break;
+        case '\\': next = '\\'; break;
+        case '\'': next = '\''; break;
+        case '\"': next = '\"'; if(S==escape::CSV) quote = '"'; break;
+        default:
+            if(!isprint(C)) {
+                // print three charator escape
+                out += "\\x";
+                out.push_back(hexdigit(C>>4));
+                out.push_back(hexdigit(C));
+            } else {
+                // literal
+                out.push_back(C);
+            }
+            continue;
+        }
+        // print two charactor escape
+        out.push_back(quote);
+        out.push_back(next);
+    }
+}
+
+void appendMaybeQuoted(std::string& out, const std::string& s)
+{
+    bool esc = false;
+    for(size_t i=0, N=s.size(); i<N && !esc; i++) {
+        switch(s[i]) {
+        case '\a':
+        case '\b':
+        case '\f':
+        case '\n':
+        case '\r':
+        case '\t':
+        case ' ':
+        case '\v':
+        case '\\':
+        case '\'':
+        case '\"':
+            esc = true;
+            break;
+        default:
+            if(!isprint(s[i])) {
+                esc = true;
+            }
+            break;
+        }
+    }
+    if(esc) {
+        out.push_back('"');
+        appendEscaped(out, s, escape::C);
+        out.push_back('"');
+    } else {
+        out += s;
+    }
+}
+
+/* Text output appended to a caller owned buffer.
+ *
+ * Numbers are formatted here when the options of the originating stream
+ * are the defaults, apart from precision.  Otherwise (hex, fixed, showpos, a locale, ...)
+ * each number goes through a temporary std::ostringstream with those options.
+ * Either way the text is the same as writing directly to the stream.
+ */
+class TextOut {
+    std::string& out;
+    const std::ios *opts;
+    int precision;
+    char fill;
+    bool simple;
+
+    static const char spaces[];
+    enum {maxSpaces = 128, maxPrecision = 40};
+
+    void formatInt(uint64 v, bool neg) {
+        char buf[24];
+        char *end = buf+sizeof(buf), *pos = end;
+        do {
+            *--pos = char('0' + v%10u);
+            v /= 10u;
+        } while(v);
+        if(neg)
+            *--pos = '-';
+        out.append(pos, end-pos);
+    }
+
+    void formatInt(int64 v) {
+        if(v<0)
+            formatInt(uint64(0u)-uint64(v), true);
+        else
+            formatInt(uint64(v), false);
+    }
+
+    // what num_put does for the default floatfield
+    void formatReal(double v) {
+        char buf[64];
+        int n = epicsSnprintf(buf, sizeof(buf), "%.*g", precision, v);
+        if(n<0 || size_t(n)>=sizeof(buf)) {
+            slowNumber(v);
+            return;
+        }
+        const char dp = *localeconv()->decimal_point;
+        if(dp!='.') {
+            // printf() follows the C locale, while the stream is "C"
+            for(int i=0; i<n; i++)
+                if(buf[i]==dp) buf[i] = '.';
+        }
+        out.append(buf, n);
+    }
+
+    template<typename T>
+    void slowNumber(T v) {
+        std::ostringstream strm;
+        if(opts)
+            strm.copyfmt(*opts);
+        strm.width(0);
+        strm<<v;
+        out += strm.str();
+    }
+
+public:
+    explicit TextOut(std::string& out)
+        :out(out)
+        ,opts(0)
+        ,precision(6)
+        ,fill(' ')
+        ,simple(true)
+    {}
+    // use the number formatting options of strm
+    TextOut(std::string& out, const std::ios& strm)
+        :out(out)
+        ,opts(&strm)
+        ,precision(int(strm.precision()))
+        ,fill(strm.fill())
+        ,simple((strm.flags()&(std::ios_base::basefield|std::ios_base::floatfield|std::ios_base::showpos
+                               |std::ios_base::showbase|std::ios_base::showpoint|std::ios_base::uppercase))==std::ios_base::dec
+                && precision>=0 && precision<=maxPrecision
+                && strm.getloc()==std::locale::classic())
+    {}
+
+    std::string& str() { return out; }
+
+    TextOut& operator<<(char c) { out.push_back(c); return *this; }
+    TextOut& operator<<(const char *s) { out += s; return *this; }
+    TextOut& operator<<(const std::string& s) { out += s; return *this; }
+    TextOut& operator<<(const maybeQuote& q) { appendMaybeQuoted(out, q.s); return *this; }
+
+    TextOut& operator<<(int32 v) { number(v); return *this; }
+    TextOut& operator<<(uint32 v) { number(v); return *this; }
+    TextOut& operator<<(int64 v) { number(v); return *this; }
+
+    // in units of four spaces
+    void indent(long level) {
+        for(long n = level*4; n>0; n-=maxSpaces)
+            out.append(spaces, std::min(n, long(maxSpaces)));
+    }
+
+    // left justify in a field of width characters
+    void padded(const char *s, size_t width) {
+        size_t len = strlen(s);
+        out.append(s, len);
+        if(len<width)
+            out.append(width-len, fill);
+    }
+
+    // as std::ostream<<print_cast(v)
+    template<typename T>
+    void number(T v) {
+        if(!simple)
+            slowNumber(v);
+        else if(!std::numeric_limits<T>::is_integer)
+            formatReal(double(v));
+        else if(std::numeric_limits<T>::is_signed)
+            formatInt(int64(v));
+        else
+            formatInt(uint64(v), false);
+    }
+
+    void value(const PVScalar *fld);
+    void value(const PVScalarArray *fld);
+    // as PVField::dumpValue()
+    void dump(const PVField *fld, long level);
+};
+
+const char TextOut::spaces[] = "                                                                "
+                               "                                                                ";
+
+template<typename T>
+void scalarValue(TextOut& O, const PVScalar *fld)
+{
+    O.number(print_cast(static_cast<const PVScalarValue<T>*>(fld)->get()));
+}
+
+template<>
+void scalarValue<boolean>(TextOut& O, const PVScalar *fld)
+{
+    O<<(static_cast<const PVBoolean*>(fld)->get() ? "true" : "false");
+}
+
+template<>
+void scalarValue<std::string>(TextOut& O, const PVScalar *fld)
+{
+    O<<maybeQuote(static_cast<const PVString*>(fld)->get());
+}
+
+template<typename T>
+void arrayValue(TextOut& O, const PVScalarArray *fld)
+{
+    typename PVValueArray<T>::const_svector V(static_cast<const PVValueArray<T>*>(fld)->view());
+    O<<'[';
+    for(size_t i=0, N=V.size(); i<N; i++) {
+        if(i)
+            O<<',';
+        O.number(print_cast(V[i]));
+    }
+    O<<']';
+}
+
+template<>
+void arrayValue<boolean>(TextOut& O, const PVScalarArray *fld)
+{
+    PVBooleanArray::const_svector V(static_cast<const PVBooleanArray*>(fld)->view());
+    O<<'[';
+    for(size_t i=0, N=V.size(); i<N; i++) {
+        if(i)
+            O<<',';
+        O<<print_cast(V[i]);
+    }
+    O<<']';
+}
+
+template<>
+void arrayValue<std::string>(TextOut& O, const PVScalarArray *fld)
+{
+    PVStringArray::const_svector V(static_cast<const PVStringArray*>(fld)->view());
+    O<<'[';
+    for(size_t i=0, N=V.size(); i<N; i++) {
+        if(i)
+            O<<", ";
+        O<<maybeQuote(V[i]);
+    }
+    O<<']';
+}
+
+void TextOut::value(const PVScalar *fld)
+{
+    switch(fld->getScalar()->getScalarType()) {
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv ## PVACODE: scalarValue<PVATYPE>(*this, fld); return;
+#define CASE_REAL_INT64
+#define CASE_STRING
+#include <pv/typemap.h>
+#undef CASE_STRING
+#undef CASE_REAL_INT64
+#undef CASE
+    }
+}
+
+void TextOut::value(const PVScalarArray *fld)
+{
+    switch(fld->getScalarArray()->getElementType()) {
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv ## PVACODE: arrayValue<PVATYPE>(*this, fld); return;
+#define CASE_REAL_INT64
+#define CASE_STRING
+#include <pv/typemap.h>
+#undef CASE_STRING
+#undef CASE_REAL_INT64
+#undef CASE
+    }
+}
+
+void TextOut::dump(const PVField *fld, long level)
+{
+    const Field *type = fld->getField().get();
+
+    switch(type->getType()) {
+    case scalar:
+        value(static_cast<const PVScalar*>(fld));
+        return;
+    case scalarArray:
+        value(static_cast<const PVScalarArray*>(fld));
+        return;
+    case structure: {
+        indent(level);
+        *this<<type->getID()<<' '<<fld->getFieldName()<<'\n';
+        const PVFieldPtrArray& flds = static_cast<const PVStructure*>(fld)->getPVFields();
+        for(size_t i=0, N=flds.size(); i<N; i++) {
+            const PVField *sub = flds[i].get();
+            Type subtype = sub->getField()->getType();
+            if(subtype==scalar || subtype==scalarArray) {
+                indent(level+1);
+                *this<<sub->getField()->getID()<<' '<<sub->getFieldName()<<' ';
+                dump(sub, level+1);
+                *this<<'\n';
+            } else {
+                dump(sub, level+1);
+            }
+        }
+    }
+        return;
+    case union_: {
+        indent(level);
+        *this<<type->getID()<<' '<<fld->getFieldName()<<'\n';
+        const PVField *sub = static_cast<const PVUnion*>(fld)->get().get();
+        if(!sub) {
+            indent(level+1);
+            *this<<"(none)\n";
+        } else {
+            Type subtype = sub->getField()->getType();
+            if(subtype==scalar || subtype==scalarArray) {
+                indent(level+1);
+                *this<<sub->getField()->getID()<<' '<<sub->getFieldName()<<' ';
+                dump(sub, level+1);
+                *this<<'\n';
+            } else {
+                dump(sub, level+1);
+            }
+        }
+    }
+        return;
+    case structureArray: {
+        indent(level);
+        *this<<type->getID()<<' '<<fld->getFieldName()<<'\n';
+        PVStructureArray::const_svector V(static_cast<const PVStructureArray*>(fld)->view());
+        for(size_t i=0, N=V.size(); i<N; i++) {
+            if(V[i]) {
+                dump(V[i].get(), level+1);
+            } else {
+                indent(level+1);
+                *this<<"(none)\n";
+            }
+        }
+    }
+        return;
+    case unionArray: {
+        indent(level);
+        *this<<type->getID()<<' '<<fld->getFieldName()<<'\n';
+        PVUnionArray::const_svector V(static_cast<const PVUnionArray*>(fld)->view());
+        for(size_t i=0, N=V.size(); i<N; i++) {
+            if(V[i]) {
+                dump(V[i].get(), level+1);
+            } else {
+                indent(level+1);
+                *this<<"(none)\n";
+            }
+        }
+    }
+        return;
+    }
+}
 
-void printAlarmTx(std::ostream& strm, const PVStructure& sub)
+void printAlarmTx(TextOut& strm, const PVStructure& sub)
 {
     PVScalar::const_shared_pointer pvSeverity(sub.getSubField<PVInt>("severity"));
     PVScalar::const_shared_pointer pvStatus(sub.getSubField<PVInt>("status"));
@@ -106,14 +481,14 @@ void printAlarmTx(std::ostream& strm, const PVStructure& sub)
 }
 
 
-void printAlarmT(std::ostream& strm, const PVStructure& top)
+void printAlarmT(TextOut& strm, const PVStructure& top)
 {
     PVStructure::const_shared_pointer sub(top.getSubField<PVStructure>("alarm"));
     if(sub)
         printAlarmTx(strm, *sub);
 }
 
-void printTimeTx(std::ostream& strm, const PVStructure& tsubop)
+void printTimeTx(TextOut& strm, const PVStructure& tsubop)
 {
     char timeText[32];
     epicsTimeStamp epicsTS;
@@ -131,7 +506,8 @@ void printTimeTx(std::ostream& strm, const PVStructure& tsubop)
         epicsTS.secPastEpoch = 0;
 
     epicsTimeToStrftime(timeText, sizeof(timeText), "%Y-%m-%d %H:%M:%S.%03f", &epicsTS);
-    strm <<std::setw(24) <<std::left <<timeText <<' ';
+    strm.padded(timeText, 24);
+    strm<<' ';
     if (tagf) {
         int64 tagv = tagf->getAs<int64>();
         if(tagv)
@@ -140,14 +516,14 @@ void printTimeTx(std::ostream& strm, const PVStructure& tsubop)
 }
 
 
-void printTimeT(std::ostream& strm, const PVStructure& top)
+void printTimeT(TextOut& strm, const PVStructure& top)
 {
     PVStructure::const_shared_pointer sub(top.getSubField<PVStructure>("timeStamp"));
     if(sub)
         printTimeTx(strm, *sub);
 }
 
-bool printEnumT(std::ostream& strm, const PVStructure& top, bool fromtop)
+bool printEnumT(TextOut& strm, const PVStructure& top, bool fromtop, long level)
 {
     PVStructure::const_shared_pointer value;
     if(fromtop) {
@@ -160,7 +536,7 @@ bool printEnumT(std::ostream& strm, const PVStructure& top, bool fromtop)
     if(!idx || !choices) return false;
 
     if(fromtop) {
-        strm<<format::indent();
+        strm.indent(level);
         printTimeT(strm, top);
         printAlarmT(strm, top);
     }
@@ -176,6 +552,33 @@ bool printEnumT(std::ostream& strm, const PVStructure& top, bool fromtop)
     return true;
 }
 
+// std::ostream adapters
+
+void printAlarmT(std::ostream& strm, const PVStructure& top)
+{
+    std::string buf;
+    TextOut O(buf, strm);
+    printAlarmT(O, top);
+    strm.write(buf.data(), buf.size());
+}
+
+void printTimeT(std::ostream& strm, const PVStructure& top)
+{
+    std::string buf;
+    TextOut O(buf, strm);
+    printTimeT(O, top);
+    strm.write(buf.data(), buf.size());
+}
+
+bool printEnumT(std::ostream& strm, const PVStructure& top, bool fromtop)
+{
+    std::string buf;
+    TextOut O(buf, strm);
+    bool ret = printEnumT(O, top, fromtop, format::indent_value(strm));
+    strm.write(buf.data(), buf.size());
+    return ret;
+}
+
 void csvEscape(std::string& S)
 {
     // concise, not particularly efficient...
@@ -293,20 +696,27 @@ void expandBS(const PVStructure& top, BitSet& mask, bool parents) {
         }
 
     } else {
-        for(int32 idx = mask.nextSetBit(0), N=top.getNumberFields(); idx>=0 && idx<N; idx=mask.nextSetBit(idx+1)) {
-            PVField::const_shared_pointer fld = top.getSubFieldT(idx);
+        const Structure::Layout& layout = top.getStructure()->getLayout();
 
+        const int32 N = int32(layout.size());
+        int32 idx = mask.nextSetBit(0);
+        while(idx>=0 && idx<N) {
             // look forward and mark all children
-            for(size_t i=idx+1, N=fld->getNextFieldOffset(); i<N; i++)
+            const uint32 next = layout[idx].nextOffset;
+            for(uint32 i=idx+1; i<next; i++)
                 mask.set(i);
 
             if(parents) {
                 // look back and mark all parents
                 // we've already stepped past all parents so siblings will not be automatically marked
-                for(const PVStructure *parent = fld->getParent(); parent; parent = parent->getParent()) {
-                    mask.set(parent->getFieldOffset());
+                for(uint32 parent = layout[idx].parentOffset; ; parent = layout[parent].parentOffset) {
+                    mask.set(parent);
+                    if(parent==0u)
+                        break;
                 }
             }
+            // skip over the children, which are already expanded
+            idx = mask.nextSetBit(next);
         }
     }
 }
@@ -314,89 +724,115 @@ void expandBS(const PVStructure& top, BitSet& mask, bool parents) {
 }
 namespace epics { namespace pvData {
 
-void printRaw(std::ostream& strm, const PVStructure::Formatter& format, const PVStructure& cur)
-{
-    typedef std::deque<std::pair<const PVField*, size_t> > todo_t;
-    todo_t todo;
-    BitSet show, highlight;
-
-    const long orig_indent = format::indent_value(strm);
-
+namespace {
+// walk the fields selected by 'show' depth first
+struct RawPrinter {
+    TextOut& O;
+    const BitSet& show;
+    const BitSet& highlight;
+    const bool ansi;
+
+    RawPrinter(TextOut& O, const BitSet& show, const BitSet& highlight, bool ansi)
+        :O(O), show(show), highlight(highlight), ansi(ansi)
+    {}
+
+    void print(const PVField *fld, long level)
     {
-        if(format.xshow)
-            show = *format.xshow;
-        else
-            show.set(0);
-
-        if(format.xhighlight)
-            highlight = *format.xhighlight;
-
-        expandBS(format.xtop, show, true);
-        expandBS(format.xtop, highlight, false);
-        highlight &= show; // can't highlight hidden fields (paranoia)
-    }
-
-    if(!show.get(0)) return; // nothing to do here...
-
-    todo.push_front(std::make_pair(&format.xtop, orig_indent));
-
-    while(!todo.empty()) {
-        todo_t::value_type cur(todo.front());
-        todo.pop_front();
-
-        format::indent_value(strm) = cur.second;
-
-        bool hl = highlight.get(cur.first->getFieldOffset()) && format.xmode==PVStructure::Formatter::ANSI;
+        bool hl = ansi && highlight.get(fld->getFieldOffset());
         if(hl)
-            strm<<"\x1b[1m"; // Bold
+            O<<"\x1b[1m"; // Bold
 
-        switch(cur.first->getField()->getType()) {
+        switch(fld->getField()->getType()) {
         case structure: {
-            const PVStructure* str = static_cast<const PVStructure*>(cur.first);
-
-            const PVFieldPtrArray& flds = str->getPVFields();
-
-            for(PVFieldPtrArray::const_reverse_iterator it(flds.rbegin()), end(flds.rend()); it!=end; ++it) {
-                const PVField *fld = (*it).get();
-                if(!show.get(fld->getFieldOffset())) continue;
-
-                todo.push_front(std::make_pair(fld, cur.second+1));
+            const PVStructure* str = static_cast<const PVStructure*>(fld);
+            const std::string& id(fld->getField()->getID());
+
+            O.indent(level);
+            O<<id<<' '<<fld->getFieldName();
+            switch(fld->getField()->getTypeTag()) {
+            case TypeTag::Alarm:
+                O<<' ';
+                printAlarmTx(O, *str);
+                break;
+            case TypeTag::TimeStamp:
+                O<<' ';
+                printTimeTx(O, *str);
+                break;
+            case TypeTag::Enumerated:
+                O<<' ';
+                printEnumT(O, *str, false, level);
+                break;
+            default:
+                break;
             }
+            O<<'\n';
+            if(hl)
+                O<<"\x1b[0m"; // reset
 
-            std::string id(cur.first->getField()->getID());
-
-            strm<<format::indent()<<id<<' '<<cur.first->getFieldName();
-            if(id=="alarm_t") {
-                strm.put(' ');
-                printAlarmTx(strm, *str);
-            } else if(id=="time_t") {
-                strm.put(' ');
-                printTimeTx(strm, *str);
-            } else if(id=="enum_t") {
-                strm.put(' ');
-                printEnumT(strm, *str, false);
+            const PVFieldPtrArray& flds = str->getPVFields();
+            for(size_t i=0, N=flds.size(); i<N; i++) {
+                if(show.get(flds[i]->getFieldOffset()))
+                    print(flds[i].get(), level+1);
             }
-            strm.put('\n');
+            return;
         }
-            break;
         case scalar:
         case scalarArray:
-            strm<<format::indent()<<cur.first->getField()->getID()<<' '<<cur.first->getFieldName()
-                <<' '<<*cur.first
-                <<'\n';
+            O.indent(level);
+            O<<fld->getField()->getID()<<' '<<fld->getFieldName()<<' ';
+            O.dump(fld, level);
+            O<<'\n';
             break;
         case structureArray:
         case union_:
         case unionArray:
-            strm<<*cur.first;
+            O.dump(fld, level);
             break;
         }
 
         if(hl)
-            strm<<"\x1b[0m"; // reset
+            O<<"\x1b[0m"; // reset
     }
+};
+
+void printRaw(TextOut& O, const PVStructure& top,
+              const BitSet* xshow, const BitSet* xhighlight, bool ansi, long level)
+{
+    BitSet show, highlight;
+
+    {
+        if(xshow)
+            show = *xshow;
+        else
+            show.set(0);
+
+        if(xhighlight)
+            highlight = *xhighlight;
+
+        expandBS(top, show, true);
+        expandBS(top, highlight, false);
+        highlight &= show; // can't highlight hidden fields (paranoia)
+    }
+
+    if(!show.get(0)) return; // nothing to do here...
 
-    format::indent_value(strm) = orig_indent;
+    RawPrinter(O, show, highlight, ansi).print(&top, level);
+}
+} // namespace
+
+void printRaw(std::ostream& strm, const PVStructure::Formatter& format, const PVStructure& cur)
+{
+    std::string buf;
+    TextOut O(buf, strm);
+    printRaw(O, format.xtop, format.xshow, format.xhighlight,
+             format.xmode==PVStructure::Formatter::ANSI, format::indent_value(strm));
+    strm.write(buf.data(), buf.size());
+}
+
+void PVStructure::Formatter::appendRaw(std::string& out) const
+{
+    TextOut O(out);
+    printRaw(O, xtop, xshow, xhighlight, xmode==ANSI, 0);
 }
 
 std::ostream& operator<<(std::ostream& strm, const PVStructure::Formatter& format)
@@ -409,11 +845,8 @@ std::ostream& operator<<(std::ostream& strm, const PVStructure::Formatter& forma
         return strm;
 
     } else if(format.xfmt==PVStructure::Formatter::NT) {
-        std::string id(format.xtop.getStructure()->getID()),
-                    idprefix(id.substr(0, id.find_first_of('.')));
-
         // NTTable
-        if(idprefix=="epics:nt/NTTable:1") {
+        if(format.xtop.getStructure()->getTypeTag()==TypeTag::NTTable) {
             if(printTable(strm, format.xtop))
                 return strm;
         } else {
@@ -461,90 +894,30 @@ std::ostream& operator<<(std::ostream& strm, const PVStructure::Formatter& forma
     return strm;
 }
 
-static char hexdigit(char c) {
-    c &= 0xf;
-    if(c<9)
-        return '0'+c;
-    else
-        return 'A'+c-10;
-}
-
 escape::~escape() {}
 
 std::string escape::str() const
 {
-    std::ostringstream strm;
-    strm<<(*this);
-    return strm.str();
+    std::string ret;
+    appendEscaped(ret, orig, S);
+    return ret;
 }
 
 epicsShareFunc
 std::ostream& operator<<(std::ostream& strm, const escape& Q)
 {
-    for(size_t pos = 0, len = Q.orig.size(); pos < len; pos++) {
-        const char C = Q.orig[pos];
-        char quote = '\\', next;
-        // compare me with epicsStrnEscapedFromRaw()
-        switch(C) {
-        case '\a': next = 'a'; break;
-        case '\b': next = 'b'; break;
-        case '\f': next = 'f'; break;
-        case '\n': next = 'n'; break;
-        case '\r': next = 'r'; break;
-        case '\t': next = 't'; break;
-        case '\v': next = 'v'; break;
-        case '\\': next = '\\'; break;
-        case '\'': next = '\''; break;
-        case '\"': next = '\"'; if(Q.S==escape::CSV) quote = '"'; break;
-        default:
-            if(!isprint(C)) {
-                // print three charator escape
-                strm<<"\\x"<<hexdigit(C>>4)<<hexdigit(C);
-            } else {
-                // literal
-                strm.put(C);
-            }
-            continue;
-        }
-        // print two charactor escape
-        strm.put(quote);
-        strm.put(next);
-    }
-
+    std::string buf;
+    appendEscaped(buf, Q.orig, Q.S);
+    strm.write(buf.data(), buf.size());
     return strm;
 }
 
 
 std::ostream& operator<<(std::ostream& strm, const maybeQuote& q)
 {
-    bool esc = false;
-    for(size_t i=0, N=q.s.size(); i<N && !esc; i++) {
-        switch(q.s[i]) {
-        case '\a':
-        case '\b':
-        case '\f':
-        case '\n':
-        case '\r':
-        case '\t':
-        case ' ':
-        case '\v':
-        case '\\':
-        case '\'':
-        case '\"':
-            esc = true;
-            break;
-        default:
-            if(!isprint(q.s[i])) {
-                esc = true;
-            }
-            break;
-        }
-    }
-    if(esc) {
-        strm<<'"'<<escape(q.s)<<'"';
-    } else {
-        strm<<q.s;
-    }
+    std::string buf;
+    appendMaybeQuoted(buf, q.s);
+    strm.write(buf.data(), buf.size());
     return strm;
 }
 
@@ -40,9 +40,15 @@ void copy(
     shared_vector<T> temp(capacity);
     typename PVValueArray<T>::const_svector vecFrom = pvFrom.view();
     typename PVValueArray<T>::const_svector vecTo = pvTo.view();
-    for(size_t i=0; i<pvTo.getLength(); ++i) temp[i] = vecTo[i];
-    for(size_t i=pvTo.getLength(); i< capacity; ++i) temp[i] = T();
-    for(size_t i=0; i<count; ++i) temp[i*toStride + toOffset] = vecFrom[i*fromStride+fromOffset];
+    detail::copy_elements<T>::op(vecTo.data(), vecTo.data()+vecTo.size(), temp.data());
+    for(size_t i=vecTo.size(); i< capacity; ++i) temp[i] = T();
+    if(fromStride==1 && toStride==1) {
+        // contiguous, so may be done in parallel
+        const T *first = vecFrom.data()+fromOffset;
+        detail::copy_elements<T>::op(first, first+count, temp.data()+toOffset);
+    } else {
+        for(size_t i=0; i<count; ++i) temp[i*toStride + toOffset] = vecFrom[i*fromStride+fromOffset];
+    }
     shared_vector<const T> temp2(freeze(temp));
     pvTo.replace(temp2);
 }
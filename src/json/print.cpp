@@ -195,20 +195,27 @@ void expandBS(const pvd::PVStructure& top, pvd::BitSet& mask, bool parents) {
         }
 
     } else {
-        for(pvd::int32 idx = mask.nextSetBit(0), N=top.getNumberFields(); idx>=0 && idx<N; idx=mask.nextSetBit(idx+1)) {
-            pvd::PVField::const_shared_pointer fld = top.getSubFieldT(idx);
+        const pvd::Structure::Layout& layout = top.getStructure()->getLayout();
 
+        const pvd::int32 N = pvd::int32(layout.size());
+        pvd::int32 idx = mask.nextSetBit(0);
+        while(idx>=0 && idx<N) {
             // look forward and mark all children
-            for(size_t i=idx+1, N=fld->getNextFieldOffset(); i<N; i++)
+            const pvd::uint32 next = layout[idx].nextOffset;
+            for(pvd::uint32 i=idx+1; i<next; i++)
                 mask.set(i);
 
             if(parents) {
                 // look back and mark all parents
                 // we've already stepped past all parents so siblings will not be automatically marked
-                for(const pvd::PVStructure *parent = fld->getParent(); parent; parent = parent->getParent()) {
-                    mask.set(parent->getFieldOffset());
+                for(pvd::uint32 parent = layout[idx].parentOffset; ; parent = layout[parent].parentOffset) {
+                    mask.set(parent);
+                    if(parent==0u)
+                        break;
                 }
             }
+            // skip over the children, which are already expanded
+            idx = mask.nextSetBit(next);
         }
     }
 }
@@ -0,0 +1,287 @@
+/* arrayAllocator.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#include <stdlib.h>
+
+#if defined(__linux__)
+#  include <sys/mman.h>
+#endif
+
+#include <new>
+#include <stdexcept>
+
+#include <epicsAtomic.h>
+
+#define epicsExportSharedSymbols
+#include <pv/arrayAllocator.h>
+
+namespace {
+using namespace epics::pvData;
+
+// guards theAllocator, which is only looked at when installed!=0
+Mutex allocatorLock;
+ArrayAllocator::shared_pointer theAllocator;
+size_t installed;
+
+struct AllocatorDeleter {
+    ArrayAllocator::shared_pointer alloc;
+    size_t nbytes;
+    AllocatorDeleter(const ArrayAllocator::shared_pointer& alloc, size_t nbytes)
+        :alloc(alloc), nbytes(nbytes) {}
+    void operator()(void *ptr) { alloc->deallocate(ptr, nbytes); }
+};
+
+// smallest n with (1<<n) >= size
+int ceilLog2(size_t size)
+{
+    int n = 0;
+    while(n < int(sizeof(size_t)*8u-1u) && (size_t(1u)<<n) < size)
+        n++;
+    return n;
+}
+
+void* mallocOrThrow(size_t nbytes)
+{
+    void *ret = malloc(nbytes ? nbytes : 1u);
+    if(!ret)
+        throw std::bad_alloc();
+    return ret;
+}
+
+#if defined(__linux__)
+// mmap() lengths are rounded up to a multiple of the (usual) huge page size
+const size_t hugePageSize = 2u*1024u*1024u;
+const size_t mapAlignment = 4096u;
+
+size_t hugeRound(size_t nbytes)
+{
+    return (nbytes + hugePageSize - 1u) & ~(hugePageSize - 1u);
+}
+#endif
+
+} // namespace
+
+namespace epics { namespace pvData {
+
+ArrayAllocator::~ArrayAllocator() {}
+
+void ArrayAllocator::install(const shared_pointer& alloc)
+{
+    Lock G(allocatorLock);
+    theAllocator = alloc;
+    epics::atomic::set(installed, size_t(alloc ? 1u : 0u));
+}
+
+ArrayAllocator::shared_pointer ArrayAllocator::current()
+{
+    Lock G(allocatorLock);
+    return theAllocator;
+}
+
+ArrayPool::ArrayPool(size_t minSize, size_t maxSize, size_t maxCached,
+                     const ArrayAllocator::shared_pointer& upstream)
+    :minSize(minSize)
+    ,maxSize(maxSize)
+    ,maxCached(maxCached)
+    ,upstream(upstream)
+    ,minShift(ceilLog2(minSize))
+    ,hits(0u), misses(0u), bypass(0u)
+{
+    if(minSize==0u || minSize>maxSize)
+        throw std::invalid_argument("ArrayPool requires 0 < minSize <= maxSize");
+    cache.resize(ceilLog2(maxSize) - minShift + 1);
+}
+
+ArrayPool::~ArrayPool()
+{
+    drain();
+}
+
+int ArrayPool::sizeClass(size_t nbytes) const
+{
+    if(nbytes<minSize || nbytes>maxSize)
+        return -1;
+    return ceilLog2(nbytes) - minShift;
+}
+
+void* ArrayPool::rawAllocate(size_t nbytes)
+{
+    return upstream ? upstream->allocate(nbytes) : mallocOrThrow(nbytes);
+}
+
+void ArrayPool::rawDeallocate(void *ptr, size_t nbytes)
+{
+    if(upstream)
+        upstream->deallocate(ptr, nbytes);
+    else
+        free(ptr);
+}
+
+void* ArrayPool::allocate(size_t nbytes)
+{
+    const int cls = sizeClass(nbytes);
+    {
+        Lock G(mutex);
+        if(cls<0) {
+            bypass++;
+        } else if(!cache[cls].empty()) {
+            hits++;
+            void *ret = cache[cls].back();
+            cache[cls].pop_back();
+            return ret;
+        } else {
+            misses++;
+        }
+    }
+    return rawAllocate(cls<0 ? nbytes : size_t(1u)<<(cls+minShift));
+}
+
+void ArrayPool::deallocate(void *ptr, size_t nbytes)
+{
+    const int cls = sizeClass(nbytes);
+    if(cls>=0) {
+        Lock G(mutex);
+        if(cache[cls].size()<maxCached) {
+            try {
+                cache[cls].push_back(ptr);
+                return;
+            } catch(std::bad_alloc&) {
+                // fall through to free
+            }
+        }
+    }
+    rawDeallocate(ptr, cls<0 ? nbytes : size_t(1u)<<(cls+minShift));
+}
+
+ArrayPool::Stats ArrayPool::getStats() const
+{
+    Stats ret;
+    Lock G(mutex);
+    ret.hits = hits;
+    ret.misses = misses;
+    ret.bypass = bypass;
+    ret.cached = ret.cachedBytes = 0u;
+    for(size_t i=0; i<cache.size(); i++) {
+        ret.cached += cache[i].size();
+        ret.cachedBytes += cache[i].size() << (i+minShift);
+    }
+    return ret;
+}
+
+void ArrayPool::resetStats()
+{
+    Lock G(mutex);
+    hits = misses = bypass = 0u;
+}
+
+void ArrayPool::drain()
+{
+    std::vector<std::vector<void*> > temp(cache.size());
+    {
+        Lock G(mutex);
+        temp.swap(cache);
+    }
+    for(size_t i=0; i<temp.size(); i++)
+        for(size_t j=0; j<temp[i].size(); j++)
+            rawDeallocate(temp[i][j], size_t(1u)<<(i+minShift));
+}
+
+AlignedAllocator::AlignedAllocator(size_t alignment, size_t hugeThreshold)
+    :alignment(alignment)
+    ,hugeThreshold(hugeThreshold)
+    ,nmapped(0u)
+    ,noHugeTLB(0u)
+{
+    if(alignment<sizeof(void*) || (alignment&(alignment-1u))!=0u)
+        throw std::invalid_argument("AlignedAllocator alignment must be a power of two, and at least sizeof(void*)");
+}
+
+AlignedAllocator::~AlignedAllocator() {}
+
+bool AlignedAllocator::useMap(size_t nbytes) const
+{
+#if defined(__linux__)
+    // page alignment from mmap() is sufficient
+    return hugeThreshold!=0u && nbytes>=hugeThreshold && alignment<=mapAlignment;
+#else
+    (void)nbytes;
+    return false;
+#endif
+}
+
+void* AlignedAllocator::allocate(size_t nbytes)
+{
+#if defined(__linux__)
+    if(useMap(nbytes)) {
+        const size_t len = hugeRound(nbytes);
+        void *ret = MAP_FAILED;
+#  ifdef MAP_HUGETLB
+        if(!epics::atomic::get(noHugeTLB)) {
+            ret = mmap(0, len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+            if(ret==MAP_FAILED)
+                epics::atomic::set(noHugeTLB, size_t(1u)); // no reserved huge pages
+        }
+#  endif
+        if(ret==MAP_FAILED) {
+            ret = mmap(0, len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+            if(ret==MAP_FAILED)
+                throw std::bad_alloc();
+#  ifdef MADV_HUGEPAGE
+            (void)madvise(ret, len, MADV_HUGEPAGE); // only a hint
+#  endif
+        }
+        epics::atomic::increment(nmapped);
+        return ret;
+    }
+#endif
+    // over-allocate, and remember the original pointer just before the aligned block
+    if(nbytes > size_t(-1) - alignment - sizeof(void*))
+        throw std::bad_alloc();
+    char *raw = static_cast<char*>(mallocOrThrow(nbytes + alignment + sizeof(void*)));
+    size_t addr = reinterpret_cast<size_t>(raw + sizeof(void*));
+    addr = (addr + alignment - 1u) & ~(alignment - 1u);
+    void **ret = reinterpret_cast<void**>(addr);
+    ret[-1] = raw;
+    return ret;
+}
+
+void AlignedAllocator::deallocate(void *ptr, size_t nbytes)
+{
+    if(!ptr)
+        return;
+#if defined(__linux__)
+    if(useMap(nbytes)) {
+        munmap(ptr, hugeRound(nbytes));
+        epics::atomic::decrement(nmapped);
+        return;
+    }
+#endif
+    free(static_cast<void**>(ptr)[-1]);
+}
+
+size_t AlignedAllocator::numMapped() const
+{
+    return epics::atomic::get(nmapped);
+}
+
+namespace detail {
+
+std::tr1::shared_ptr<void> allocateArray(size_t nbytes)
+{
+    std::tr1::shared_ptr<void> ret;
+    if(!epics::atomic::get(installed))
+        return ret;
+
+    ArrayAllocator::shared_pointer alloc(ArrayAllocator::current());
+    if(alloc) {
+        // on failure, shared_ptr ctor calls the deleter
+        ret.reset(alloc->allocate(nbytes), AllocatorDeleter(alloc, nbytes));
+    }
+    return ret;
+}
+
+} // namespace detail
+
+}} // namespace epics::pvData
@@ -137,6 +137,81 @@ namespace epics { namespace pvData {
         words.clear();
     }
 
+    // mask of the bits in word WORD_INDEX(fromIndex) which are >= fromIndex
+    #define FIRST_WORD_MASK(fromIndex) (WORD_MASK << WORD_OFFSET(fromIndex))
+    // mask of the bits in word WORD_INDEX(toIndex-1) which are < toIndex
+    #define LAST_WORD_MASK(toIndex) (WORD_MASK >> (BIT_INDEX_MASK - WORD_OFFSET((toIndex)-1u)))
+
+    BitSet& BitSet::clear(uint32 fromIndex, uint32 toIndex) {
+        if (fromIndex >= toIndex)
+            return *this;
+
+        uint32 first = WORD_INDEX(fromIndex),
+               last = WORD_INDEX(toIndex-1u);
+        if (first >= words.size())
+            return *this;
+
+        if (first == last) {
+            words[first] &= ~(FIRST_WORD_MASK(fromIndex) & LAST_WORD_MASK(toIndex));
+        } else {
+            words[first] &= ~FIRST_WORD_MASK(fromIndex);
+            uint32 end = std::min(last, uint32(words.size()));
+            for (uint32 i = first+1u; i < end; i++)
+                words[i] = 0;
+            if (last < words.size())
+                words[last] &= ~LAST_WORD_MASK(toIndex);
+        }
+
+        recalculateWordsInUse();
+        return *this;
+    }
+
+    bool BitSet::anySet(uint32 fromIndex, uint32 toIndex) const {
+        if (fromIndex >= toIndex)
+            return false;
+
+        uint32 first = WORD_INDEX(fromIndex),
+               last = WORD_INDEX(toIndex-1u);
+        if (first >= words.size())
+            return false;
+
+        if (first == last)
+            return (words[first] & FIRST_WORD_MASK(fromIndex) & LAST_WORD_MASK(toIndex)) != 0;
+
+        if (words[first] & FIRST_WORD_MASK(fromIndex))
+            return true;
+        uint32 end = std::min(last, uint32(words.size()));
+        for (uint32 i = first+1u; i < end; i++)
+            if (words[i])
+                return true;
+        return last < words.size() && (words[last] & LAST_WORD_MASK(toIndex)) != 0;
+    }
+
+    bool BitSet::allSet(uint32 fromIndex, uint32 toIndex) const {
+        if (fromIndex >= toIndex)
+            return true;
+
+        uint32 first = WORD_INDEX(fromIndex),
+               last = WORD_INDEX(toIndex-1u);
+        if (last >= words.size())
+            return false; // trailing zeros
+
+        if (first == last) {
+            uint64 mask = FIRST_WORD_MASK(fromIndex) & LAST_WORD_MASK(toIndex);
+            return (words[first] & mask) == mask;
+        }
+
+        if ((words[first] & FIRST_WORD_MASK(fromIndex)) != FIRST_WORD_MASK(fromIndex))
+            return false;
+        for (uint32 i = first+1u; i < last; i++)
+            if (words[i] != WORD_MASK)
+                return false;
+        return (words[last] & LAST_WORD_MASK(toIndex)) == LAST_WORD_MASK(toIndex);
+    }
+
+    #undef FIRST_WORD_MASK
+    #undef LAST_WORD_MASK
+
     uint32 BitSet::numberOfTrailingZeros(uint64 i) {
         // HD, Figure 5-14
         uint32 x, y;
@@ -336,6 +411,18 @@ namespace epics { namespace pvData {
                 buffer->putByte((int8) (x & 0xff));
     }
 
+    std::size_t BitSet::getSerializedSize() const {
+        uint32 n = words.size();
+        if (n == 0)
+            return SerializeHelper::getSizeSerializedSize(0);
+
+        uint32 len = BYTES_PER_WORD * (n-1);
+        for (uint64 x = words[n - 1]; x != 0; x >>= 8)
+            len++;
+
+        return SerializeHelper::getSizeSerializedSize(len) + len;
+    }
+
     void BitSet::deserialize(ByteBuffer* buffer, DeserializableControl* control) {
 
         uint32 bytes = static_cast<uint32>(SerializeHelper::readSize(buffer, control)); // in bytes
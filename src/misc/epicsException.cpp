@@ -11,14 +11,66 @@
 #include <cstring>
 #include <cstdlib>
 #include <string>
+#include <climits>
+
+#include <epicsAtomic.h>
 
 #define epicsExportSharedSymbols
 #include <pv/epicsException.h>
 
 using std::string;
 
+namespace {
+// <0 until read from $EPICS_PVD_EXCEPT_STACK
+int stackPeriod = -1;
+size_t stackCount;
+
+int initStackPeriod()
+{
+    int period = 1;
+    const char *env = getenv("EPICS_PVD_EXCEPT_STACK");
+    if(env && *env) {
+        char *end = 0;
+        unsigned long val = strtoul(env, &end, 10);
+        if(*end=='\0')
+            period = val>INT_MAX ? INT_MAX : int(val);
+        else
+            fprintf(stderr, "Ignoring invalid EPICS_PVD_EXCEPT_STACK='%s'\n", env);
+    }
+    // setStackCapturePeriod() may have been called meanwhile
+    epics::atomic::compareAndSwap(stackPeriod, -1, period);
+    return epics::atomic::get(stackPeriod);
+}
+}
+
 namespace epics{ namespace pvData {
 
+bool
+ExceptionMixin::captureStack()
+{
+    int period = epics::atomic::get(stackPeriod);
+    if(period<0)
+        period = initStackPeriod();
+    if(period<=1)
+        return period==1;
+    return epics::atomic::increment(stackCount)%size_t(period)==0;
+}
+
+void
+ExceptionMixin::setStackCapturePeriod(unsigned period)
+{
+    epics::atomic::set(stackPeriod, period>INT_MAX ? INT_MAX : int(period));
+}
+
+unsigned
+ExceptionMixin::getStackCapturePeriod()
+{
+    int period = epics::atomic::get(stackPeriod);
+    if(period<0)
+        period = initStackPeriod();
+    return unsigned(period);
+}
+
 void
 ExceptionMixin::print(FILE *fp) const
 {
@@ -0,0 +1,236 @@
+/* memorySerialize.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <string.h>
+#include <stdexcept>
+
+#define epicsExportSharedSymbols
+#include <pv/pvIntrospect.h>
+#include <pv/memorySerialize.h>
+
+namespace {
+// type codes of the pvAccess introspection registry
+const epics::pvData::int8 NULL_TYPE_CODE = (epics::pvData::int8)0xFF;
+const epics::pvData::int8 ONLY_ID_TYPE_CODE = (epics::pvData::int8)0xFE;
+const epics::pvData::int8 FULL_WITH_ID_TYPE_CODE = (epics::pvData::int8)0xFD;
+// largest id which may be assigned
+const size_t maxCacheId = 0x7fff;
+}
+
+namespace epics { namespace pvData {
+
+static std::size_t checkStageSize(std::size_t stageSize)
+{
+    if(stageSize<64)
+        throw std::invalid_argument("MemorySerializer stage size must be at least 64 bytes");
+    return stageSize;
+}
+
+MemorySerializer::MemorySerializer(int byteOrder,
+                                   std::size_t stageSize,
+                                   std::size_t directThreshold,
+                                   bool cacheIntrospection)
+    :stage(checkStageSize(stageSize))
+    ,buffer(&stage[0], stage.size(), byteOrder)
+    ,total(0u)
+    ,directThreshold(directThreshold)
+    ,cacheIntrospection(cacheIntrospection)
+{}
+
+MemorySerializer::~MemorySerializer() {}
+
+void MemorySerializer::flushSerializeBuffer()
+{
+    const std::size_t n = buffer.getPosition();
+    if(n==0)
+        return;
+
+    const std::size_t offset = owned.size();
+    owned.insert(owned.end(), stage.begin(), stage.begin()+n);
+
+    if(!ranges.empty() && !ranges.back().data) {
+        // extend preceding owned range
+        ranges.back().size += n;
+    } else {
+        Range R = {0, offset, n};
+        ranges.push_back(R);
+    }
+    total += n;
+    buffer.clear();
+}
+
+void MemorySerializer::ensureBuffer(std::size_t size)
+{
+    if(buffer.getRemaining()>=size)
+        return;
+    if(size>buffer.getSize())
+        throw std::logic_error("MemorySerializer::ensureBuffer() request larger than stage");
+    flushSerializeBuffer();
+}
+
+bool MemorySerializer::directSerialize(ByteBuffer *existingBuffer,
+                                       const char* toSerialize,
+                                       std::size_t elementCount,
+                                       std::size_t elementSize)
+{
+    const std::size_t n = elementCount*elementSize;
+    if(directThreshold==0 || n<directThreshold || existingBuffer!=&buffer)
+        return false;
+
+    flushSerializeBuffer();
+    Range R = {toSerialize, 0, n};
+    ranges.push_back(R);
+    total += n;
+    return true;
+}
+
+void MemorySerializer::cachedSerialize(std::tr1::shared_ptr<const Field> const & field,
+                                       ByteBuffer* buffer)
+{
+    if(!cacheIntrospection) {
+        field->serialize(buffer, this);
+        return;
+    }
+
+    if(!field) {
+        ensureBuffer(1);
+        buffer->putByte(NULL_TYPE_CODE);
+        return;
+    }
+
+    cache_t::const_iterator it(cache.find(field));
+    if(it!=cache.end()) {
+        ensureBuffer(3);
+        buffer->putByte(ONLY_ID_TYPE_CODE);
+        buffer->putShort(it->second);
+
+    } else if(cache.size()<=maxCacheId) {
+        const int16 key = int16(cache.size());
+        cache[field] = key;
+        ensureBuffer(3);
+        buffer->putByte(FULL_WITH_ID_TYPE_CODE);
+        buffer->putShort(key);
+        field->serialize(buffer, this);
+
+    } else {
+        // out of ids
+        field->serialize(buffer, this);
+    }
+}
+
+const MemorySerializer::segments_t& MemorySerializer::getSegments()
+{
+    flushSerializeBuffer();
+
+    // resolve offsets now as 'owned' may have been reallocated since
+    segments.resize(ranges.size());
+    for(size_t i=0, N=ranges.size(); i<N; i++) {
+        const Range& R = ranges[i];
+        segments[i].data = R.data ? R.data : &owned[R.offset];
+        segments[i].size = R.size;
+    }
+    return segments;
+}
+
+void MemorySerializer::copyTo(std::vector<epicsUInt8>& out)
+{
+    const segments_t& segs(getSegments());
+
+    std::size_t pos = out.size();
+    out.resize(pos+total);
+    for(size_t i=0, N=segs.size(); i<N; i++) {
+        memcpy(&out[pos], segs[i].data, segs[i].size);
+        pos += segs[i].size;
+    }
+}
+
+void MemorySerializer::clear()
+{
+    buffer.clear();
+    owned.clear();
+    ranges.clear();
+    segments.clear();
+    total = 0u;
+}
+
+void MemorySerializer::resetCache()
+{
+    cache.clear();
+}
+
+
+MemoryDeserializer::MemoryDeserializer(const char *data, std::size_t size,
+                                       int byteOrder,
+                                       bool cacheIntrospection)
+    :pbuffer(new ByteBuffer((char*)data, size, byteOrder))
+    ,byteOrder(byteOrder)
+    ,cacheIntrospection(cacheIntrospection)
+{}
+
+MemoryDeserializer::~MemoryDeserializer() {}
+
+void MemoryDeserializer::reset(const char *data, std::size_t size)
+{
+    // ByteBuffer can't be re-pointed
+    pbuffer.reset(new ByteBuffer((char*)data, size, byteOrder));
+}
+
+void MemoryDeserializer::ensureData(std::size_t size)
+{
+    if(size>pbuffer->getRemaining())
+        throw std::logic_error("MemoryDeserializer: incomplete buffer");
+}
+
+bool MemoryDeserializer::directDeserialize(ByteBuffer *existingBuffer,
+                                           char* deserializeTo,
+                                           std::size_t elementCount,
+                                           std::size_t elementSize)
+{
+    const std::size_t n = elementCount*elementSize;
+    if(existingBuffer!=pbuffer.get() || n>existingBuffer->getRemaining())
+        return false;
+
+    const std::size_t pos = existingBuffer->getPosition();
+    memcpy(deserializeTo, existingBuffer->getBuffer()+pos, n);
+    existingBuffer->setPosition(pos+n);
+    return true;
+}
+
+std::tr1::shared_ptr<const Field> MemoryDeserializer::cachedDeserialize(ByteBuffer* buffer)
+{
+    FieldCreatePtr create(getFieldCreate());
+
+    if(!cacheIntrospection)
+        return create->deserialize(buffer, this);
+
+    ensureData(1);
+    const int8 code = buffer->getByte();
+
+    if(code==NULL_TYPE_CODE) {
+        return FieldConstPtr();
+
+    } else if(code==ONLY_ID_TYPE_CODE) {
+        ensureData(2);
+        cache_t::const_iterator it(cache.find(buffer->getShort()));
+        if(it==cache.end())
+            throw std::runtime_error("MemoryDeserializer: unknown introspection id");
+        return it->second;
+
+    } else if(code==FULL_WITH_ID_TYPE_CODE) {
+        ensureData(2);
+        const int16 key = buffer->getShort();
+        FieldConstPtr field(create->deserialize(buffer, this));
+        cache[key] = field;
+        return field;
+
+    } else {
+        // full description without id
+        buffer->setPosition(buffer->getPosition()-1);
+        return create->deserialize(buffer, this);
+    }
+}
+
+}} // namespace epics::pvData
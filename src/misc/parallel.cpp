@@ -0,0 +1,208 @@
+/* parallel.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#include <string.h>
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include <epicsThread.h>
+#include <epicsAtomic.h>
+
+#define epicsExportSharedSymbols
+#include <pv/sharedPtr.h>
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/thread.h>
+#include <pv/parallel.h>
+
+namespace {
+using namespace epics::pvData;
+
+struct Pool;
+
+struct Worker {
+    Pool *pool;
+    Event wake;
+    epics::auto_ptr<Thread> thread;
+
+    explicit Worker(Pool *pool) :pool(pool) {}
+    void run();
+};
+
+struct Pool {
+    // held while a job is in progress, and while (re)configuring
+    Mutex busy;
+    std::vector<Worker*> workers;
+    // nworkers and threshold are also read without the lock
+    size_t nworkers, threshold, chunk;
+    bool stop;
+
+    // current job
+    epics::pvData::detail::bulk_fn fn;
+    void *arg;
+    size_t count, step, next, active;
+    Event done;
+
+    Pool() :nworkers(0u), threshold(0u), chunk(0u), stop(false),
+        fn(0), arg(0), count(0u), step(1u), next(0u), active(0u) {}
+
+    // claim and process chunks until none remain
+    void work() {
+        for(;;) {
+            size_t first = epics::atomic::add(next, step) - step;
+            if(first>=count)
+                break;
+            (*fn)(arg, first, std::min(first+step, count));
+        }
+    }
+
+    // call with busy locked
+    void stopAll() {
+        epics::atomic::set(nworkers, size_t(0u));
+        stop = true;
+        for(size_t i=0; i<workers.size(); i++)
+            workers[i]->wake.signal();
+        for(size_t i=0; i<workers.size(); i++)
+            delete workers[i]; // joins
+        workers.clear();
+        stop = false;
+    }
+};
+
+void Worker::run()
+{
+    while(wake.wait() && !pool->stop) {
+        pool->work();
+        if(epics::atomic::decrement(pool->active)==0u)
+            pool->done.signal();
+    }
+}
+
+// Pool*, published once created.  Read without locking by parallelFor()
+void *thePool;
+// the size in bytes below which parallelFor() returns without looking at the pool.
+// The configured threshold while there are workers, otherwise never.
+size_t fastThreshold = size_t(-1);
+epicsThreadOnceId poolOnce = EPICS_THREAD_ONCE_INIT;
+
+void poolInit(void *)
+{
+    epics::atomic::set(thePool, static_cast<void*>(new Pool)); // never free'd
+}
+
+Pool& getPool()
+{
+    epicsThreadOnce(&poolOnce, &poolInit, 0);
+    return *static_cast<Pool*>(epics::atomic::get(thePool));
+}
+
+struct UnlockGuard {
+    Mutex& M;
+    explicit UnlockGuard(Mutex& M) :M(M) {}
+    ~UnlockGuard() { M.unlock(); }
+};
+
+struct CopyJob {
+    char *dest;
+    const char *src;
+};
+
+void copyChunk(void *raw, size_t first, size_t last)
+{
+    CopyJob *job = static_cast<CopyJob*>(raw);
+    memcpy(job->dest+first, job->src+first, last-first);
+}
+
+} // namespace
+
+namespace epics { namespace pvData {
+
+void ParallelPolicy::configure(unsigned workers, size_t threshold, size_t chunk)
+{
+    if(chunk==0u)
+        throw std::invalid_argument("ParallelPolicy chunk size must be non-zero");
+
+    Pool& P = getPool();
+    Lock G(P.busy);
+
+    epics::atomic::set(fastThreshold, size_t(-1));
+    P.stopAll();
+    epics::atomic::set(P.threshold, threshold);
+    P.chunk = chunk;
+
+    P.workers.reserve(workers);
+    for(unsigned i=0; i<workers; i++) {
+        epics::auto_ptr<Worker> W(new Worker(&P));
+        W->thread.reset(new Thread(Thread::Config(W.get(), &Worker::run)
+                                   .prio(epicsThreadPriorityMedium)
+                                   .stack(epicsThreadStackSmall)
+                                   <<"PVDBulk"<<i));
+        P.workers.push_back(W.release());
+    }
+    epics::atomic::set(P.nworkers, P.workers.size());
+    if(!P.workers.empty())
+        epics::atomic::set(fastThreshold, threshold);
+}
+
+unsigned ParallelPolicy::workers()
+{
+    return unsigned(epics::atomic::get(getPool().nworkers));
+}
+
+size_t ParallelPolicy::threshold()
+{
+    return epics::atomic::get(getPool().threshold);
+}
+
+namespace detail {
+
+bool parallelFor(size_t count, size_t elementSize, bulk_fn fn, void *arg)
+{
+    // cheap tests for the usual cases of no pool, or a small buffer.
+    // Called for every primitive array copy, so never wait for epicsThreadOnce()
+    if(count==0u || count*elementSize < epics::atomic::get(fastThreshold))
+        return false;
+    Pool *pool = static_cast<Pool*>(epics::atomic::get(thePool));
+    if(!pool)
+        return false;
+    Pool& P = *pool;
+    if(epics::atomic::get(P.nworkers)==0u || !P.busy.tryLock())
+        return false;
+    UnlockGuard G(P.busy);
+
+    if(P.workers.empty())
+        return false;
+
+    const size_t step = std::max(size_t(1u), P.chunk/elementSize);
+    const size_t nwake = std::min(P.workers.size(), (count-1u)/step);
+    if(nwake==0u)
+        return false;
+
+    P.fn = fn;
+    P.arg = arg;
+    P.count = count;
+    P.step = step;
+    P.next = 0u;
+    P.active = nwake;
+    for(size_t i=0; i<nwake; i++)
+        P.workers[i]->wake.signal();
+
+    P.work();
+    P.done.wait();
+    return true;
+}
+
+void bulkCopy(void *dest, const void *src, size_t nbytes)
+{
+    CopyJob job = {static_cast<char*>(dest), static_cast<const char*>(src)};
+    if(!parallelFor(nbytes, 1u, &copyChunk, &job))
+        memcpy(dest, src, nbytes);
+}
+
+} // namespace detail
+
+}} // namespace epics::pvData
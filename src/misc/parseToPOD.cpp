@@ -7,6 +7,9 @@
 #include <errno.h>
 #include <float.h>
 #include <limits.h>
+#include <math.h>
+
+#include <limits>
 
 #include <epicsVersion.h>
 
@@ -90,6 +93,136 @@ epicsParseULongLong(const char *str, unsigned long long *to, int base, char **un
 }
 #endif
 
+/* Fast paths for plain decimal text, which is what we usually see.
+ * These return false, without changing *out, for anything else
+ * (white space, hex, octal, out of range, ...)
+ * which is then left to the epicsParse*() functions to accept or reject.
+ */
+
+// [+-]digits without redundant leading zeros
+static bool parseDecimal(const char *s, epicsUInt64 *mag, bool *neg)
+{
+    *neg = false;
+    if(*s=='-' || *s=='+')
+        *neg = *s++=='-';
+    if(s[0]=='0' && s[1]=='\0') {
+        // leading zeros would mean octal
+        *mag = 0u;
+        return true;
+    } else if(*s<'1' || *s>'9') {
+        return false;
+    }
+
+    epicsUInt64 v = 0u;
+    unsigned ndigits = 0u;
+    for(; *s>='0' && *s<='9'; s++) {
+        if(++ndigits>19u)
+            return false; // may overflow
+        v = v*10u + unsigned(*s-'0');
+    }
+    if(*s)
+        return false;
+    *mag = v;
+    return true;
+}
+
+template<typename T>
+static bool fastParseInt(const char *in, T *out)
+{
+    typedef std::numeric_limits<T> limits;
+    epicsUInt64 mag;
+    bool neg;
+    if(!parseDecimal(in, &mag, &neg))
+        return false;
+
+    if(!neg) {
+        if(mag > epicsUInt64(limits::max()))
+            return false;
+        *out = T(mag);
+    } else if(limits::is_signed && mag <= epicsUInt64(limits::max())+1u) {
+        *out = T(epicsInt64(epicsUInt64(0u)-mag));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Exact when the mantissa and the power of ten are both exactly representable,
+// and each operation is rounded to double (not extended) precision.
+#if (defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD==0) || \
+    (defined(__FLT_EVAL_METHOD__) && __FLT_EVAL_METHOD__==0) || defined(_WIN64)
+static bool fastParseDouble(const char *s, double *out)
+{
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+    bool neg = false;
+    if(*s=='-' || *s=='+')
+        neg = *s++=='-';
+
+    epicsUInt64 mant = 0u;
+    unsigned ndigits = 0u;
+    int exp = 0;
+    bool any = false;
+
+    for(; *s>='0' && *s<='9'; s++) {
+        any = true;
+        if(mant==0u && *s=='0')
+            continue;
+        if(++ndigits>15u)
+            return false;
+        mant = mant*10u + unsigned(*s-'0');
+    }
+    if(*s=='.') {
+        for(s++; *s>='0' && *s<='9'; s++) {
+            any = true;
+            exp--;
+            if(mant==0u && *s=='0')
+                continue;
+            if(++ndigits>15u)
+                return false;
+            mant = mant*10u + unsigned(*s-'0');
+        }
+    }
+    if(!any)
+        return false;
+
+    if(*s=='e' || *s=='E') {
+        s++;
+        bool eneg = false;
+        if(*s=='-' || *s=='+')
+            eneg = *s++=='-';
+        if(*s<'0' || *s>'9')
+            return false;
+        int e = 0;
+        for(; *s>='0' && *s<='9'; s++) {
+            if(e<10000)
+                e = e*10 + (*s-'0');
+        }
+        exp += eneg ? -e : e;
+    }
+    if(*s)
+        return false;
+
+    double v;
+    if(mant==0u)
+        v = 0.0;
+    else if(exp<-22 || exp>22)
+        return false;
+    else if(exp<0)
+        v = double(mant)/pow10[-exp];
+    else
+        v = double(mant)*pow10[exp];
+
+    *out = neg ? -v : v;
+    return true;
+}
+#else
+static bool fastParseDouble(const char *, double *) { return false; }
+#endif
+
 static
 void handleParseError(int err)
 {
@@ -107,22 +240,30 @@ void handleParseError(int err)
 
 namespace epics { namespace pvData { namespace detail {
 
-void parseToPOD(const char* in, boolean *out)
+int tryParseToPOD(const char* in, boolean *out)
 {
     if(epicsStrCaseCmp(in,"true")==0)
         *out = 1;
     else if(epicsStrCaseCmp(in,"false")==0)
         *out = 0;
     else
+        return S_stdlib_noConversion;
+    return 0;
+}
+
+void parseToPOD(const char* in, boolean *out)
+{
+    if(tryParseToPOD(in, out))
         throw std::runtime_error("parseToPOD: string no match true/false");
 }
 
 #define INTFN(T, S) \
-void parseToPOD(const char* in, T *out) { \
+int tryParseToPOD(const char* in, T *out) { \
+    if(fastParseInt(in, out)) return 0; \
     epics ## S temp; \
     int err = epicsParse ## S (in, &temp, 0, NULL); \
-    if(err)   handleParseError(err); \
-    else      *out = temp; \
+    if(!err)  *out = temp; \
+    return err; \
 }
 
 INTFN(int8, Int8);
@@ -132,38 +273,47 @@ INTFN(uint16_t, UInt16);
 INTFN(int32_t, Int32);
 INTFN(uint32_t, UInt32);
 
-void parseToPOD(const char* in, int64_t *out) {
+int tryParseToPOD(const char* in, int64_t *out) {
+    if(fastParseInt(in, out))
+        return 0;
 #ifdef NEED_LONGLONG
-    int err = epicsParseLongLong(in, out, 0, NULL);
+    return epicsParseLongLong(in, out, 0, NULL);
 #else
-    int err = epicsParseLong(in, out, 0, NULL);
+    return epicsParseLong(in, out, 0, NULL);
 #endif
-    if(err)   handleParseError(err);
 }
 
-void parseToPOD(const char* in, uint64_t *out) {
+int tryParseToPOD(const char* in, uint64_t *out) {
+    if(fastParseInt(in, out))
+        return 0;
 #ifdef NEED_LONGLONG
-    int err = epicsParseULongLong(in, out, 0, NULL);
+    return epicsParseULongLong(in, out, 0, NULL);
 #else
-    int err = epicsParseULong(in, out, 0, NULL);
+    return epicsParseULong(in, out, 0, NULL);
 #endif
-    if(err)   handleParseError(err);
 }
 
-void parseToPOD(const char* in, float *out) {
-    int err = epicsParseFloat(in, out, NULL);
-    if(err)   handleParseError(err);
+int tryParseToPOD(const char* in, float *out) {
+    // epicsParseFloat() rounds the double result when in range
+    double temp;
+    if(fastParseDouble(in, &temp) && (temp==0.0 || (fabs(temp)>FLT_MIN && fabs(temp)<FLT_MAX))) {
+        *out = float(temp);
+        return 0;
+    }
+    return epicsParseFloat(in, out, NULL);
 }
 
-void parseToPOD(const char* in, double *out) {
-    int err = epicsParseDouble(in, out, NULL);
-    if(err)   handleParseError(err);
+int tryParseToPOD(const char* in, double *out) {
+    if(fastParseDouble(in, out))
+        return 0;
 #if defined(vxWorks)
+    double temp;
+    int err = epicsParseDouble(in, &temp, NULL);
     /* vxWorks strtod returns [-]epicsINF when it should return ERANGE error.
      * If [-]epicsINF is returned and the first char is a digit we translate
      * this into an ERANGE error
      */
-    else if (*out == epicsINF || *out == -epicsINF) {
+    if (!err && (temp == epicsINF || temp == -epicsINF)) {
         const char* s = in;
         int c;
 
@@ -176,9 +326,31 @@ void parseToPOD(const char* in, double *out) {
             c = *s++;
 
         if (isdigit(c))
-            handleParseError(S_stdlib_overflow);
+            err = S_stdlib_overflow;
     }
+    if (!err)
+        *out = temp;
+    return err;
+#else
+    return epicsParseDouble(in, out, NULL);
 #endif
 }
 
+#define THROWFN(T) \
+void parseToPOD(const char* in, T *out) { \
+    int err = tryParseToPOD(in, out); \
+    if(err)   handleParseError(err); \
+}
+
+THROWFN(int8);
+THROWFN(uint8);
+THROWFN(int16_t);
+THROWFN(uint16_t);
+THROWFN(int32_t);
+THROWFN(uint32_t);
+THROWFN(int64_t);
+THROWFN(uint64_t);
+THROWFN(float);
+THROWFN(double);
+
 }}}
@@ -0,0 +1,175 @@
+/* arrayAllocator.h */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef ARRAYALLOCATOR_H
+#define ARRAYALLOCATOR_H
+
+#include <stddef.h>
+
+#include <vector>
+
+#include <pv/sharedPtr.h>
+#include <pv/lock.h>
+#include <pv/noDefaultMethods.h>
+
+#include <shareLib.h>
+
+namespace epics { namespace pvData {
+
+/**
+ * @brief Provider of storage for shared_vector arrays of primitive elements.
+ *
+ * By default shared_vector allocates with new[].
+ * When an ArrayAllocator is installed, arrays of the numeric types and boolean
+ * are instead allocated from it.  This includes construction, reserve(), resize() and make_unique().
+ * Storage is given back through deallocate() when the last shared_vector referencing it goes away.
+ * The allocator is kept alive until then, even if it has been replaced.
+ *
+ * Arrays of std::string, and of other element types, are not affected.
+ *
+ @code
+   ArrayAllocator::install(std::tr1::shared_ptr<ArrayAllocator>(new ArrayPool));
+ @endcode
+ */
+class epicsShareClass ArrayAllocator {
+public:
+    POINTER_DEFINITIONS(ArrayAllocator);
+
+    virtual ~ArrayAllocator();
+
+    /** Return storage for nbytes, suitably aligned for any primitive type.
+     * @throws std::bad_alloc on failure
+     */
+    virtual void* allocate(size_t nbytes) =0;
+    //! Return storage previously given by allocate(nbytes).  Must not throw.
+    virtual void deallocate(void *ptr, size_t nbytes) =0;
+
+    //! Use alloc for new arrays.  NULL restores the default (new[]).
+    static void install(const shared_pointer& alloc);
+    //! The currently installed allocator, or NULL.
+    static shared_pointer current();
+};
+
+/**
+ * @brief ArrayAllocator which recycles buffers in power of two size classes.
+ *
+ * Requests between minSize and maxSize bytes are rounded up to a power of two.
+ * On deallocate(), up to maxCached buffers of each size are kept for re-use,
+ * which avoids repeated large malloc() and page faults when arrays of similar size
+ * are continually allocated and released.  Requests outside this range are not cached.
+ *
+ * Buffers come from malloc(), or from an upstream ArrayAllocator if one is given.
+ @code
+   ArrayAllocator::shared_pointer aligned(new AlignedAllocator);
+   ArrayAllocator::install(ArrayAllocator::shared_pointer(new ArrayPool(64u*1024u, 256u*1024u*1024u, 4u, aligned)));
+ @endcode
+ */
+class epicsShareClass ArrayPool : public ArrayAllocator {
+    EPICS_NOT_COPYABLE(ArrayPool)
+public:
+    POINTER_DEFINITIONS(ArrayPool);
+
+    struct Stats {
+        //! Number of allocate() satisfied from a cached buffer
+        size_t hits;
+        //! Number of allocate() which needed a new buffer
+        size_t misses;
+        //! Number of allocate() outside of [minSize, maxSize]
+        size_t bypass;
+        //! Number of buffers currently cached
+        size_t cached;
+        //! Total size in bytes of buffers currently cached
+        size_t cachedBytes;
+    };
+
+    /**
+     * @param minSize Smallest request (in bytes) which is cached.
+     * @param maxSize Largest request (in bytes) which is cached.
+     * @param maxCached Number of buffers of each size which are kept.
+     * @param upstream Source of buffers.  NULL to use malloc().
+     * @throws std::invalid_argument unless 0 < minSize <= maxSize
+     */
+    explicit ArrayPool(size_t minSize = 64u*1024u,
+                       size_t maxSize = 256u*1024u*1024u,
+                       size_t maxCached = 4u,
+                       const ArrayAllocator::shared_pointer& upstream = ArrayAllocator::shared_pointer());
+    virtual ~ArrayPool();
+
+    virtual void* allocate(size_t nbytes);
+    virtual void deallocate(void *ptr, size_t nbytes);
+
+    Stats getStats() const;
+    //! Zero the hits, misses, and bypass counters
+    void resetStats();
+    //! Free all cached buffers
+    void drain();
+
+private:
+    // size class for nbytes, or -1 if not pooled
+    int sizeClass(size_t nbytes) const;
+    void* rawAllocate(size_t nbytes);
+    void rawDeallocate(void *ptr, size_t nbytes);
+
+    const size_t minSize, maxSize, maxCached;
+    const ArrayAllocator::shared_pointer upstream;
+    int minShift;
+    mutable Mutex mutex;
+    std::vector<std::vector<void*> > cache;
+    size_t hits, misses, bypass;
+};
+
+/**
+ * @brief ArrayAllocator which aligns storage for vectorized loops, and backs large arrays with huge pages.
+ *
+ * All buffers are aligned to at least alignment bytes, by default one cache line.
+ *
+ * On Linux, requests of at least hugeThreshold bytes are mapped directly with mmap().
+ * Pages from the reserved huge page pool (MAP_HUGETLB) are tried first.
+ * If none are available, normal pages are mapped and the kernel is asked to
+ * use transparent huge pages (MADV_HUGEPAGE), which it may or may not do.
+ * Elsewhere, or with hugeThreshold==0, all requests are satisfied from malloc().
+ *
+ @code
+   getPVDataCreate()->setArrayAllocator(ArrayAllocator::shared_pointer(new AlignedAllocator));
+ @endcode
+ */
+class epicsShareClass AlignedAllocator : public ArrayAllocator {
+    EPICS_NOT_COPYABLE(AlignedAllocator)
+public:
+    POINTER_DEFINITIONS(AlignedAllocator);
+
+    /**
+     * @param alignment Power of two, at least sizeof(void*).
+     * @param hugeThreshold Size in bytes from which huge pages are used.  Zero to never use them.
+     * @throws std::invalid_argument if alignment is not valid.
+     */
+    explicit AlignedAllocator(size_t alignment = 64u,
+                              size_t hugeThreshold = 2u*1024u*1024u);
+    virtual ~AlignedAllocator();
+
+    virtual void* allocate(size_t nbytes);
+    virtual void deallocate(void *ptr, size_t nbytes);
+
+    size_t getAlignment() const { return alignment; }
+    //! Number of buffers currently mapped with mmap() (huge page candidates).
+    size_t numMapped() const;
+
+private:
+    bool useMap(size_t nbytes) const;
+
+    const size_t alignment, hugeThreshold;
+    size_t nmapped;
+    // MAP_HUGETLB failed once, so don't try again
+    size_t noHugeTLB;
+};
+
+namespace detail {
+    // Storage from the installed ArrayAllocator, or NULL if none is installed.
+    epicsShareExtern std::tr1::shared_ptr<void> allocateArray(size_t nbytes);
+}
+
+}} // namespace epics::pvData
+
+#endif  /* ARRAYALLOCATOR_H */
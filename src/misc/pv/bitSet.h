@@ -131,6 +131,31 @@ namespace epics { namespace pvData {
          */
         void clear();
 
+        /**
+         * Sets the bits from @c fromIndex (inclusive) to @c toIndex (exclusive) to @c false.
+         *
+         * @param  fromIndex index of the first bit to be cleared
+         * @param  toIndex index after the last bit to be cleared
+         */
+        BitSet& clear(uint32 fromIndex, uint32 toIndex);
+
+        /**
+         * Returns true if any bit from @c fromIndex (inclusive) to @c toIndex (exclusive) is set.
+         *
+         * @param  fromIndex index of the first bit to test
+         * @param  toIndex index after the last bit to test
+         */
+        bool anySet(uint32 fromIndex, uint32 toIndex) const;
+
+        /**
+         * Returns true if every bit from @c fromIndex (inclusive) to @c toIndex (exclusive) is set.
+         * An empty range is always set.
+         *
+         * @param  fromIndex index of the first bit to test
+         * @param  toIndex index after the last bit to test
+         */
+        bool allSet(uint32 fromIndex, uint32 toIndex) const;
+
         /**
          * Returns the index of the first bit that is set to @c true that
          * occurs on or after the specified starting index. If no such bit
@@ -254,6 +279,12 @@ namespace epics { namespace pvData {
         virtual void deserialize(ByteBuffer *buffer,
             DeserializableControl *flusher);
 
+        /**
+         * Number of bytes which serialize() will write.
+         * @return serialized size in bytes
+         */
+        std::size_t getSerializedSize() const;
+
     private:
 
         typedef std::vector<uint64> words_t;
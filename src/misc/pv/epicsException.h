@@ -66,8 +66,8 @@
 namespace epics { namespace pvData {
 
 
-/* Stores file and line number given, and when possible the call stack
- * at the point where it was constructed
+/* Stores file and line number given, and when possible and enabled
+ * the call stack at the point where it was constructed
  */
 class epicsShareClass ExceptionMixin {
     const char *m_file;
@@ -76,6 +76,7 @@ class epicsShareClass ExceptionMixin {
     void *m_stack[EXCEPT_DEPTH];
     int m_depth; // always <= EXCEPT_DEPTH
 #endif
+    static bool captureStack();
 public:
     // allow the ctor to be inlined if possible
     ExceptionMixin(const char* file, int line)
@@ -83,11 +84,11 @@ public:
         ,m_line(line)
 #if defined(EXCEPT_USE_BACKTRACE)
     {
-        m_depth=backtrace(m_stack,EXCEPT_DEPTH);
+        m_depth=captureStack() ? backtrace(m_stack,EXCEPT_DEPTH) : 0;
     }
 #elif defined(EXCEPT_USE_CAPTURE)
     {
-        m_depth=CaptureStackBackTrace(0,EXCEPT_DEPTH,m_stack,0);
+        m_depth=captureStack() ? CaptureStackBackTrace(0,EXCEPT_DEPTH,m_stack,0) : 0;
     }
 #else
     {}
@@ -96,6 +97,18 @@ public:
     void print(FILE *fp=stderr) const;
 
     std::string show() const;
+
+    /* Control capture of the call stack, which dominates the cost of
+     * constructing an exception.
+     *
+     * period 0 never captures, 1 captures for every exception (the default),
+     * and N captures for one in every N exceptions.
+     *
+     * The initial period is taken from the environment variable
+     * EPICS_PVD_EXCEPT_STACK when set (eg. "0" to disable).
+     */
+    static void setStackCapturePeriod(unsigned period);
+    static unsigned getStackCapturePeriod();
 };
 
 #ifndef THROW_EXCEPTION_COMPAT
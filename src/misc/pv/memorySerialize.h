@@ -0,0 +1,197 @@
+/* memorySerialize.h */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef MEMORYSERIALIZE_H
+#define MEMORYSERIALIZE_H
+
+#include <vector>
+#include <map>
+
+#include <epicsEndian.h>
+#include <epicsTypes.h>
+
+#include <pv/pvType.h>
+#include <pv/serialize.h>
+#include <pv/byteBuffer.h>
+#include <pv/sharedPtr.h>
+#include <pv/noDefaultMethods.h>
+
+#include <shareLib.h>
+
+namespace epics { namespace pvData {
+
+class Field;
+
+/**
+ * @brief SerializableControl which collects output in memory.
+ *
+ * Serialized bytes are staged in a fixed size ByteBuffer (see getBuffer())
+ * and appended to an internal growable store on each flush.
+ *
+ * Primitive arrays of at least directThreshold bytes are not copied.
+ * directSerialize() records a reference to the caller's array as a separate segment.
+ * So the output is a list of segments (see getSegments()) which may be passed
+ * to writev() or similar without first being made contiguous.
+ *
+ * @warning Referenced array data must remain valid and unchanged until
+ *          the output has been consumed, or clear() is called.
+ *          Use a directThreshold of zero to always copy.
+ *
+ * When cacheIntrospection is true, cachedSerialize() sends each Field in full
+ * only once, then refers to it by a 16-bit id (the pvAccess 0xFD/0xFE encoding).
+ * A MemoryDeserializer with cacheIntrospection enabled is needed to decode.
+ *
+ @code
+   MemorySerializer S(EPICS_ENDIAN_LITTLE);
+   S.serialize(*pvStructure);
+   const MemorySerializer::segments_t& segs(S.getSegments());
+   std::vector<struct iovec> iov(segs.size());
+   for(size_t i=0; i<segs.size(); i++) {
+       iov[i].iov_base = (void*)segs[i].data;
+       iov[i].iov_len = segs[i].size;
+   }
+   writev(fd, &iov[0], iov.size());
+ @endcode
+ */
+class epicsShareClass MemorySerializer : public SerializableControl
+{
+    EPICS_NOT_COPYABLE(MemorySerializer)
+public:
+    //! A contiguous range of output bytes
+    struct Segment {
+        const char *data;
+        std::size_t size;
+    };
+    typedef std::vector<Segment> segments_t;
+
+    /**
+     * @param byteOrder Byte order to write (EPICS_ENDIAN_LITTLE or EPICS_ENDIAN_BIG)
+     * @param stageSize Size of the staging ByteBuffer.  Limits the largest ensureBuffer() request.
+     *                  Must be at least 64 bytes.
+     * @param directThreshold Arrays of at least this many bytes are referenced instead of copied.
+     *                        Zero to always copy.
+     * @param cacheIntrospection Enable the Field cache for cachedSerialize().
+     */
+    explicit MemorySerializer(int byteOrder = EPICS_BYTE_ORDER,
+                              std::size_t stageSize = 16*1024,
+                              std::size_t directThreshold = 4*1024,
+                              bool cacheIntrospection = false);
+    virtual ~MemorySerializer();
+
+    //! The buffer to pass to Serializable::serialize() along with this control.
+    ByteBuffer* getBuffer() { return &buffer; }
+
+    //! Append the serialization of S to the output.
+    void serialize(const Serializable& S) { S.serialize(&buffer, this); }
+
+    /**
+     * Segments of the output so far, in order.
+     * Implicitly calls flushSerializeBuffer().
+     * Pointers are valid until the next call to a non-const method.
+     */
+    const segments_t& getSegments();
+
+    //! Total number of output bytes so far, including any not yet flushed.
+    std::size_t getSize() const { return total + buffer.getPosition(); }
+
+    //! Append a contiguous copy of the output to out.
+    void copyTo(std::vector<epicsUInt8>& out);
+
+    /**
+     * Discard all output, and references to direct array data.
+     * The introspection cache is kept, as the peer may already know its ids.
+     */
+    void clear();
+
+    //! Forget all Field ids sent so far.
+    void resetCache();
+
+    virtual void flushSerializeBuffer() OVERRIDE FINAL;
+    virtual void ensureBuffer(std::size_t size) OVERRIDE FINAL;
+    virtual bool directSerialize(ByteBuffer *existingBuffer,
+                                 const char* toSerialize,
+                                 std::size_t elementCount,
+                                 std::size_t elementSize) OVERRIDE FINAL;
+    virtual void cachedSerialize(std::tr1::shared_ptr<const Field> const & field,
+                                 ByteBuffer* buffer) OVERRIDE FINAL;
+
+private:
+    // data==NULL for ranges of 'owned', where offset is used.
+    struct Range {
+        const char *data;
+        std::size_t offset, size;
+    };
+    std::vector<char> stage;
+    ByteBuffer buffer;
+    std::vector<char> owned;
+    std::vector<Range> ranges;
+    segments_t segments;
+    std::size_t total;
+    const std::size_t directThreshold;
+    const bool cacheIntrospection;
+    typedef std::map<std::tr1::shared_ptr<const Field>, int16> cache_t;
+    cache_t cache;
+};
+
+/**
+ * @brief DeserializableControl which reads from a contiguous span of memory.
+ *
+ * The span is not copied, and must remain valid while deserializing.
+ * Primitive arrays which need no byte swapping are copied out with a single memcpy().
+ * ensureData() throws std::logic_error when the span is exhausted.
+ *
+ * When cacheIntrospection is true, cachedDeserialize() understands
+ * the Field id encoding written by a MemorySerializer with cacheIntrospection enabled.
+ * Ids are remembered across calls.
+ */
+class epicsShareClass MemoryDeserializer : public DeserializableControl
+{
+    EPICS_NOT_COPYABLE(MemoryDeserializer)
+public:
+    /**
+     * @param data Start of span.  May not be NULL.
+     * @param size Length of span in bytes.
+     * @param byteOrder Byte order to read (EPICS_ENDIAN_LITTLE or EPICS_ENDIAN_BIG)
+     * @param cacheIntrospection Enable the Field cache for cachedDeserialize().
+     */
+    MemoryDeserializer(const char *data, std::size_t size,
+                       int byteOrder = EPICS_BYTE_ORDER,
+                       bool cacheIntrospection = false);
+    virtual ~MemoryDeserializer();
+
+    //! The buffer to pass to Serializable::deserialize() along with this control.
+    ByteBuffer* getBuffer() { return pbuffer.get(); }
+
+    //! Replace the contents of S with the next value in the span.
+    void deserialize(Serializable& S) { S.deserialize(pbuffer.get(), this); }
+
+    //! Number of bytes not yet consumed.
+    std::size_t getRemaining() const { return pbuffer->getRemaining(); }
+
+    /**
+     * Continue with a new span.  Any bytes not consumed from the previous span are discarded.
+     * The introspection cache is kept.
+     * Replaces the ByteBuffer, so getBuffer() must be called again.
+     */
+    void reset(const char *data, std::size_t size);
+
+    virtual void ensureData(std::size_t size) OVERRIDE FINAL;
+    virtual bool directDeserialize(ByteBuffer *existingBuffer,
+                                   char* deserializeTo,
+                                   std::size_t elementCount,
+                                   std::size_t elementSize) OVERRIDE FINAL;
+    virtual std::tr1::shared_ptr<const Field> cachedDeserialize(ByteBuffer* buffer) OVERRIDE FINAL;
+
+private:
+    epics::auto_ptr<ByteBuffer> pbuffer;
+    const int byteOrder;
+    const bool cacheIntrospection;
+    typedef std::map<int16, std::tr1::shared_ptr<const Field> > cache_t;
+    cache_t cache;
+};
+
+}} // namespace epics::pvData
+
+#endif  /* MEMORYSERIALIZE_H */
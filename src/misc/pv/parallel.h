@@ -0,0 +1,66 @@
+/* parallel.h */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+
+#include <shareLib.h>
+
+namespace epics { namespace pvData {
+
+/**
+ * @brief Opt-in multi-threaded execution of bulk array kernels.
+ *
+ * When enabled, castUnsafeV() between numeric types, copies made by shared_vector
+ * (eg. by thaw() of shared data), and pvSubArrayCopy() of numeric arrays
+ * split buffers of at least threshold() bytes into chunks,
+ * which are processed by a pool of worker threads and by the calling thread.
+ *
+ * Disabled by default.  Only one bulk operation uses the pool at a time.
+ * Other callers meanwhile proceed on their own thread.
+ *
+ @code
+   // use 3 workers (4 threads in total) for arrays of 4MB or more
+   ParallelPolicy::configure(3);
+ @endcode
+ */
+class epicsShareClass ParallelPolicy {
+public:
+    /** Start, resize, or stop the worker pool.
+     *
+     * Waits for any bulk operation in progress to complete.
+     *
+     * @param workers Number of worker threads.  Zero disables.
+     * @param threshold Smaller buffers are always processed by the calling thread.
+     * @param chunk Size in bytes of each piece of work.  Sized to fit in cache.
+     * @throws std::invalid_argument if chunk is zero.
+     */
+    static void configure(unsigned workers,
+                          size_t threshold = 4u*1024u*1024u,
+                          size_t chunk = 256u*1024u);
+    //! Current number of worker threads.
+    static unsigned workers();
+    //! Current size threshold in bytes.
+    static size_t threshold();
+};
+
+namespace detail {
+    // process elements [first, last)
+    typedef void (*bulk_fn)(void *arg, size_t first, size_t last);
+
+    // Call fn with sub-ranges of [0, count) from the worker pool, and return true when all have completed.
+    // Returns false, having done nothing, if the caller should process all elements itself.
+    // fn must not throw.
+    epicsShareExtern bool parallelFor(size_t count, size_t elementSize, bulk_fn fn, void *arg);
+
+    // memcpy(), in parallel when worthwhile
+    epicsShareExtern void bulkCopy(void *dest, const void *src, size_t nbytes);
+}
+
+}} // namespace epics::pvData
+
+#endif  /* PARALLEL_H */
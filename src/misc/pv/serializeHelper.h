@@ -54,6 +54,15 @@ namespace epics {
              */
             static std::size_t readSize(ByteBuffer* buffer,
                     DeserializableControl* control);
+            /**
+             * Number of bytes written by writeSize().
+             *
+             * @param[in] s size to encode
+             * @returns 1 or 5
+             */
+            static std::size_t getSizeSerializedSize(std::size_t s) {
+                return (s==(std::size_t)-1 || s<254) ? 1u : 5u;
+            }
 
             /**
              * std::string serialization helper method.
@@ -64,6 +73,15 @@ namespace epics {
              */
             static void serializeString(const std::string& value, ByteBuffer* buffer,
                     SerializableControl* flusher);
+            /**
+             * Number of bytes written by serializeString().
+             *
+             * @param[in] value std::string to serialize
+             * @returns serialized size in bytes
+             */
+            static std::size_t getStringSerializedSize(const std::string& value) {
+                return getSizeSerializedSize(value.length()) + value.length();
+            }
 
             /**
              * std::string serialization helper method.
@@ -9,6 +9,7 @@
 #include <ostream>
 #include <algorithm>
 #include <stdexcept>
+#include <new>
 #include <iterator>
 
 #if __cplusplus>=201103L
@@ -21,6 +22,8 @@
 #include "pv/pvIntrospect.h"
 #include "pv/typeCast.h"
 #include "pv/templateMeta.h"
+#include "pv/parallel.h"
+#include "pv/arrayAllocator.h"
 
 namespace epics { namespace pvData {
 
@@ -35,6 +38,59 @@ namespace detail {
     template<typename E>
     struct default_array_deleter {void operator()(E a){delete[] a;}};
 
+    // primitive element types, which need no construction,
+    // and so may come from an ArrayAllocator, and be copied with memcpy()
+    template<typename E> struct is_primitive { enum {value=0}; };
+#define PVD_PRIMITIVE(TYPE) template<> struct is_primitive<TYPE> { enum {value=1}; }
+    PVD_PRIMITIVE(boolean);
+    PVD_PRIMITIVE(int8);
+    PVD_PRIMITIVE(uint8);
+    PVD_PRIMITIVE(int16);
+    PVD_PRIMITIVE(uint16);
+    PVD_PRIMITIVE(int32);
+    PVD_PRIMITIVE(uint32);
+    PVD_PRIMITIVE(int64);
+    PVD_PRIMITIVE(uint64);
+    PVD_PRIMITIVE(float);
+    PVD_PRIMITIVE(double);
+#undef PVD_PRIMITIVE
+
+    // allocate storage for a new array
+    template<typename E, int P = is_primitive<E>::value>
+    struct alloc_elements {
+        static FORCE_INLINE std::tr1::shared_ptr<E> op(size_t count) {
+            return std::tr1::shared_ptr<E>(new E[count], default_array_deleter<E*>());
+        }
+    };
+    template<typename E>
+    struct alloc_elements<E, 1> {
+        static inline std::tr1::shared_ptr<E> op(size_t count) {
+            std::tr1::shared_ptr<void> raw;
+            if(count > size_t(-1)/sizeof(E))
+                throw std::bad_alloc();
+            if(count)
+                raw = allocateArray(count*sizeof(E));
+            if(raw)
+                return std::tr1::static_pointer_cast<E>(raw);
+            return std::tr1::shared_ptr<E>(new E[count], default_array_deleter<E*>());
+        }
+    };
+
+    // copy elements when (re)allocating.
+    // arrays of primitive types go through bulkCopy(), which may run in parallel
+    template<typename E, int P = is_primitive<E>::value>
+    struct copy_elements {
+        static FORCE_INLINE void op(const E* first, const E* last, E* dest) {
+            std::copy(first, last, dest);
+        }
+    };
+    template<typename E>
+    struct copy_elements<E, 1> {
+        static FORCE_INLINE void op(const E* first, const E* last, E* dest) {
+            bulkCopy(dest, first, (last-first)*sizeof(E));
+        }
+    };
+
     // How values should be passed as arguments to shared_vector methods
     // really should use boost::call_traits
     template<typename T> struct call_with { typedef T type; };
@@ -215,6 +271,16 @@ namespace detail {
         //! @brief Data is not shared?
         bool unique() const {return !m_sdata || m_sdata.use_count()<=1;}
 
+        /** @brief Views of the same elements of the same buffer?
+         *
+         * Such vectors are equal without comparing elements.
+         * Two empty vectors are the same.
+         */
+        bool same(const shared_vector_base& o) const {
+            return m_count==o.m_count && (m_count==0 ||
+                   (m_offset==o.m_offset && m_sdata.get()==o.m_sdata.get()));
+        }
+
 
         //! @brief Number of elements visible through this vector
         size_t size() const{return m_count;}
@@ -318,21 +384,21 @@ public:
 #if __cplusplus>=201103L
     template<typename A>
     shared_vector(std::initializer_list<A> L)
-        :base_t(new _E_non_const[L.size()], 0, L.size())
+        :base_t(detail::alloc_elements<_E_non_const>::op(L.size()), 0, L.size())
     {
         _E_non_const *raw = const_cast<_E_non_const*>(data());
         std::copy(L.begin(), L.end(), raw);
     }
 #endif
 
-    //! @brief Allocate (with new[]) a new vector of size c
+    //! @brief Allocate (with new[], or the ArrayAllocator) a new vector of size c
     explicit shared_vector(size_t c)
-        :base_t(new _E_non_const[c], 0, c)
+        :base_t(detail::alloc_elements<_E_non_const>::op(c), 0, c)
     {}
 
-    //! @brief Allocate (with new[]) a new vector of size c and fill with value e
+    //! @brief Allocate (with new[], or the ArrayAllocator) a new vector of size c and fill with value e
     shared_vector(size_t c, param_type e)
-        :base_t(new _E_non_const[c], 0, c)
+        :base_t(detail::alloc_elements<_E_non_const>::op(c), 0, c)
     {
         std::fill_n((_E_non_const*)this->m_sdata.get(), this->m_count, e);
     }
@@ -431,14 +497,9 @@ public:
         size_t new_count = this->m_count;
         if(new_count > i)
             new_count = i;
-        _E_non_const* temp=new _E_non_const[i];
-        try{
-            std::copy(begin(), begin()+new_count, temp);
-            this->m_sdata.reset(temp, detail::default_array_deleter<E*>());
-        }catch(...){
-            delete[] temp;
-            throw;
-        }
+        std::tr1::shared_ptr<_E_non_const> temp(detail::alloc_elements<_E_non_const>::op(i));
+        detail::copy_elements<_E_non_const>::op(begin(), begin()+new_count, temp.get());
+        this->m_sdata = temp;
         this->m_offset = 0;
         this->m_count = new_count;
         this->m_total = i;
@@ -471,21 +532,16 @@ public:
         size_t new_total = this->m_total;
         if(new_total < i)
             new_total = i;
-        _E_non_const* temp=new _E_non_const[new_total];
-        try{
-            size_t n = this->size();
-            if(n > i)
-                n = i;
-            // Copy as much as possible from old,
-            // remaining elements are uninitialized.
-            std::copy(begin(),
-                      begin()+n,
-                      temp);
-            this->m_sdata.reset(temp, detail::default_array_deleter<pointer>());
-        }catch(...){
-            delete[] temp;
-            throw;
-        }
+        std::tr1::shared_ptr<_E_non_const> temp(detail::alloc_elements<_E_non_const>::op(new_total));
+        size_t n = this->size();
+        if(n > i)
+            n = i;
+        // Copy as much as possible from old,
+        // remaining elements are uninitialized.
+        detail::copy_elements<_E_non_const>::op(begin(),
+                                                begin()+n,
+                                                temp.get());
+        this->m_sdata = temp;
         this->m_offset= 0;
         this->m_count = i;
         this->m_total = new_total;
@@ -506,7 +562,8 @@ public:
     /** @brief Ensure (by copying) that this shared_vector is the sole
      *  owner of the data array.
      *
-     * If a copy is needed, memory is allocated with new[].  If this is
+     * If a copy is needed, memory is allocated with new[],
+     * or from the ArrayAllocator for primitive types.  If this is
      * not desirable then do something like the following.
      @code
        shared_vector<E> original(...);
@@ -527,16 +584,11 @@ public:
         if(this->unique())
             return;
         // at this point we know that !!m_sdata, so get()!=NULL
-        _E_non_const *d = new _E_non_const[this->m_total];
-        try {
-            std::copy(this->m_sdata.get()+this->m_offset,
-                      this->m_sdata.get()+this->m_offset+this->m_count,
-                      d);
-        }catch(...){
-            delete[] d;
-            throw;
-        }
-        this->m_sdata.reset(d, detail::default_array_deleter<E*>());
+        std::tr1::shared_ptr<_E_non_const> d(detail::alloc_elements<_E_non_const>::op(this->m_total));
+        detail::copy_elements<_E_non_const>::op(this->m_sdata.get()+this->m_offset,
+                                                this->m_sdata.get()+this->m_offset+this->m_count,
+                                                d.get());
+        this->m_sdata = d;
         this->m_offset=0;
     }
 
@@ -67,6 +67,7 @@ private:
 /**
  * @brief Support for delayed or periodic callback execution.
  *
+ * Reads the current time from the clock selected by TimeStamp::setClockSource().
  */
 class epicsShareClass Timer : private Runnable {
 public:
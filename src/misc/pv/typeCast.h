@@ -46,6 +46,64 @@ namespace detail {
     static inline void parseToPOD(const std::string& str, float *out) { return parseToPOD(str.c_str(), out); }
     static inline void parseToPOD(const std::string& str, double *out) { return parseToPOD(str.c_str(), out); }
 
+    // as parseToPOD(), but returns 0 on success, or an S_stdlib_* error code (see epicsStdlib.h).
+    // *out is not changed on error.
+    epicsShareExtern int tryParseToPOD(const char*, boolean *out);
+    epicsShareExtern int tryParseToPOD(const char*, int8 *out);
+    epicsShareExtern int tryParseToPOD(const char*, uint8 *out);
+    epicsShareExtern int tryParseToPOD(const char*, int16_t *out);
+    epicsShareExtern int tryParseToPOD(const char*, uint16_t *out);
+    epicsShareExtern int tryParseToPOD(const char*, int32_t *out);
+    epicsShareExtern int tryParseToPOD(const char*, uint32_t *out);
+    epicsShareExtern int tryParseToPOD(const char*, int64_t *out);
+    epicsShareExtern int tryParseToPOD(const char*, uint64_t *out);
+    epicsShareExtern int tryParseToPOD(const char*, float *out);
+    epicsShareExtern int tryParseToPOD(const char*, double *out);
+
+    static inline int tryParseToPOD(const std::string& str, boolean *out) { return tryParseToPOD(str.c_str(), out); }
+    static inline int tryParseToPOD(const std::string& str, int8 *out) { return tryParseToPOD(str.c_str(), out); }
+    static inline int tryParseToPOD(const std::string& str, uint8 *out) { return tryParseToPOD(str.c_str(), out); }
+    static inline int tryParseToPOD(const std::string& str, int16_t *out) { return tryParseToPOD(str.c_str(), out); }
+    static inline int tryParseToPOD(const std::string& str, uint16_t *out) { return tryParseToPOD(str.c_str(), out); }
+    static inline int tryParseToPOD(const std::string& str, int32_t *out) { return tryParseToPOD(str.c_str(), out); }
+    static inline int tryParseToPOD(const std::string& str, uint32_t *out) { return tryParseToPOD(str.c_str(), out); }
+    static inline int tryParseToPOD(const std::string& str, int64_t *out) { return tryParseToPOD(str.c_str(), out); }
+    static inline int tryParseToPOD(const std::string& str, uint64_t *out) { return tryParseToPOD(str.c_str(), out); }
+    static inline int tryParseToPOD(const std::string& str, float *out) { return tryParseToPOD(str.c_str(), out); }
+    static inline int tryParseToPOD(const std::string& str, double *out) { return tryParseToPOD(str.c_str(), out); }
+
+    // printPOD appends the text of a value to out.
+    // The same as std::ostringstream()<<print_convolute<T>::op(v),
+    // but without the stream when the global locale is the classic "C" locale.
+    epicsShareExtern void printPOD(std::string& out, boolean v);
+    epicsShareExtern void printPOD(std::string& out, int8 v);
+    epicsShareExtern void printPOD(std::string& out, uint8 v);
+    epicsShareExtern void printPOD(std::string& out, int16_t v);
+    epicsShareExtern void printPOD(std::string& out, uint16_t v);
+    epicsShareExtern void printPOD(std::string& out, int32_t v);
+    epicsShareExtern void printPOD(std::string& out, uint32_t v);
+    epicsShareExtern void printPOD(std::string& out, int64_t v);
+    epicsShareExtern void printPOD(std::string& out, uint64_t v);
+    epicsShareExtern void printPOD(std::string& out, float v);
+    epicsShareExtern void printPOD(std::string& out, double v);
+    static inline void printPOD(std::string& out, const char* v) {
+        if(!v)
+            throw std::runtime_error("Cast to string failed");
+        out += v;
+    }
+    // as printPOD(), but a NULL C string fails instead of throwing
+    template<typename T>
+    static inline bool tryPrintPOD(std::string& out, T v) {
+        printPOD(out, v);
+        return true;
+    }
+    static inline bool tryPrintPOD(std::string& out, const char* v) {
+        if(!v)
+            return false;
+        out += v;
+        return true;
+    }
+
     /* want to pass POD types by value,
      * and std::string by const reference
      */
@@ -86,6 +144,10 @@ namespace detail {
         static FORCE_INLINE TO op(FROM from) {
             return static_cast<TO>(from);
         }
+        static FORCE_INLINE bool try_op(TO& to, FROM from) {
+            to = static_cast<TO>(from);
+            return true;
+        }
     };
 
     // special handling when down-casting double to float
@@ -94,6 +156,10 @@ namespace detail {
         static FORCE_INLINE float op(double from) {
             return epicsConvertDoubleToFloat(from);
         }
+        static FORCE_INLINE bool try_op(float& to, double from) {
+            to = epicsConvertDoubleToFloat(from);
+            return true;
+        }
     };
 
     // print POD to string
@@ -101,11 +167,13 @@ namespace detail {
     template<typename FROM>
     struct cast_helper<std::string, FROM, typename meta::not_same_type<std::string,FROM>::type> {
         static std::string op(FROM from) {
-            std::ostringstream strm;
-            strm << print_convolute<FROM>::op(from);
-            if(strm.fail())
-                throw std::runtime_error("Cast to string failed");
-            return strm.str();
+            std::string ret;
+            printPOD(ret, from);
+            return ret;
+        }
+        static bool try_op(std::string& to, FROM from) {
+            to.clear();
+            return tryPrintPOD(to, from);
         }
     };
 
@@ -118,6 +186,9 @@ namespace detail {
             parseToPOD(from, &ret);
             return ret;
         }
+        static FORCE_INLINE bool try_op(TO& to, const std::string& from) {
+            return tryParseToPOD(from, &to)==0;
+        }
     };
 
     // parse POD from C string
@@ -133,6 +204,9 @@ namespace detail {
             parseToPOD(from, &ret);
             return ret;
         }
+        static FORCE_INLINE bool try_op(TO& to, const char* from) {
+            return tryParseToPOD(from, &to)==0;
+        }
     };
 
 } // end detail
@@ -197,8 +271,39 @@ static FORCE_INLINE TO castUnsafe(const FROM& from)
     return detail::cast_helper<TO,FROM>::op(from);
 }
 
+/** @brief As castUnsafe(), but returns false instead of throwing.
+ *
+ * For input which is expected to be frequently invalid, where an exception
+ * per bad value is too costly.
+ @code
+   int32 val;
+   if(!tryCastUnsafe(val, str))
+       val = 0; // default
+ @endcode
+ * @param to Set to the converted value.  Unchanged when false is returned.
+ * @param from The value to convert.
+ * @returns true on success, false when the value can not be converted.
+ */
+template<typename TO, typename FROM>
+static FORCE_INLINE bool tryCastUnsafe(TO& to, const FROM& from)
+{
+    return detail::cast_helper<TO,FROM>::try_op(to, from);
+}
+
 epicsShareExtern void castUnsafeV(size_t count, ScalarType to, void *dest, ScalarType from, const void *src);
 
+/** @brief As castUnsafeV(), but returns false instead of throwing.
+ *
+ * Elements before the first which can not be converted are stored in dest.
+ *
+ * @param nconverted If not NULL, set to the number of elements converted before the first failure.
+ *                   So the index of the first bad element.
+ * @returns true if all count elements were converted.  false if an element
+ *          could not be converted, or if the conversion is not supported.
+ */
+epicsShareExtern bool tryCastUnsafeV(size_t count, ScalarType to, void *dest, ScalarType from, const void *src,
+                                     size_t *nconverted = 0);
+
 //! Cast value to printable type
 //! A no-op except for int8 and uint8, which are cast to int
 //! so that they are printed as numbers std::ostream operators,
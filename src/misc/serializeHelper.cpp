@@ -19,6 +19,7 @@
 #include <pv/epicsException.h>
 #include <pv/byteBuffer.h>
 #include <pv/serializeHelper.h>
+#include <pv/pvData.h>
 
 using namespace std;
 
@@ -199,6 +200,12 @@ namespace epics {
                                int byteOrder,
                                std::vector<epicsUInt8>& out)
         {
+            // allocate once when the size is known
+            if(const PVField *F = dynamic_cast<const PVField*>(S))
+                out.reserve(out.size()+F->getSerializedSize());
+            else if(const Field *T = dynamic_cast<const Field*>(S))
+                out.reserve(out.size()+T->getSerializedSize());
+
             ToString TS(out, byteOrder);
             S->serialize(&TS.bufwrap, &TS);
             TS.flushSerializeBuffer();
@@ -16,11 +16,25 @@
 
 #define epicsExportSharedSymbols
 #include <pv/timer.h>
+#include <pv/timeStamp.h>
 
 using std::string;
 
 namespace epics { namespace pvData {
 
+namespace {
+// current time from the clock selected with TimeStamp::setClockSource()
+epicsTime currentTime()
+{
+    TimeStamp now;
+    now.getCurrent();
+    epicsTimeStamp stamp;
+    stamp.secPastEpoch = epicsUInt32(now.getSecondsPastEpoch() - posixEpochAtEpicsEpoch);
+    stamp.nsec = epicsUInt32(now.getNanoseconds());
+    return epicsTime(stamp);
+}
+}
+
 TimerCallback::TimerCallback()
 : period(0.0),
   onList(false)
@@ -88,7 +102,7 @@ void Timer::run()
 {
     epicsGuard<epicsMutex> G(mutex);
 
-    epicsTime now(epicsTime::getCurrent());
+    epicsTime now(currentTime());
 
     while(alive) {
         double waitfor;
@@ -99,7 +113,7 @@ void Timer::run()
             epicsGuardRelease<epicsMutex> U(G);
 
             waitForWork.wait();
-            now = epicsTime::getCurrent();
+            now = currentTime();
 
         } else if((waitfor = queue.front()->timeToRun - now) <= 0) {
             // execute first expired job
@@ -128,7 +142,7 @@ void Timer::run()
             epicsGuardRelease<epicsMutex> U(G);
 
             waitForWork.wait(waitfor);
-            now = epicsTime::getCurrent();
+            now = currentTime();
         }
         waiting = false;
     }
@@ -170,7 +184,7 @@ void Timer::schedulePeriodic(
     double delay,
     double period)
 {
-    epicsTime now(epicsTime::getCurrent());
+    epicsTime now(currentTime());
 
     bool wakeup;
     {
@@ -198,7 +212,7 @@ void Timer::dump(std::ostream& o) const
 {
     Lock xx(mutex);
     if(!alive) return;
-    epicsTime now(epicsTime::getCurrent());
+    epicsTime now(currentTime());
 
     for(queue_t::const_iterator it(queue.begin()), end(queue.end()); it!=end; ++it) {
         const TimerCallbackPtr& nodeToCall = *it;
@@ -5,273 +5,496 @@
 /* Author:  Michael Davidsaver */
 #include <algorithm>
 #include <sstream>
+#include <locale>
 
 #include <string.h>
+#include <float.h>
+#include <locale.h>
 
 #include <epicsConvert.h>
+#include <epicsMath.h>
+#include <epicsStdio.h>
 
 #define epicsExportSharedSymbols
 #include "pv/typeCast.h"
+#include "pv/parallel.h"
 
-using epics::pvData::castUnsafe;
-using epics::pvData::ScalarType;
-using epics::pvData::pvString;
+using namespace epics::pvData;
 using std::string;
 
 namespace {
 
-static void noconvert()
+// returned by castV() for an unsupported conversion
+const size_t unsupported = (size_t)-1;
+
+static size_t noconvert(bool throws)
 {
-    throw std::runtime_error("castUnsafeV: Conversion not supported");
+    if(throws)
+        throw std::runtime_error("castUnsafeV: Conversion not supported");
+    return unsupported;
 }
 
 template<typename TO, typename FROM>
-static void castVTyped(size_t count, void *draw, const void *sraw)
+static void castFailed(size_t count, size_t index, const FROM& from)
 {
-    TO *dest=(TO*)draw;
-    const FROM *src=(FROM*)sraw;
-
-    //std::transform(src, src+count, dest, castUnsafe<TO,FROM>);
-
+    // repeat with the throwing form for the reason
     try {
-        for(size_t i=0; i<count; i++) {
-            dest[i] = castUnsafe<TO,FROM>(src[i]);
-        }
+        (void)castUnsafe<TO,FROM>(from);
     } catch (std::exception& ex) {
         // do not report index for scalars (or arrays with one element)
         if (count > 1)
         {
             std::ostringstream os;
-            os << "failed to parse element at index " << (src - (FROM*)sraw);
+            os << "failed to parse element at index " << index;
             os << ": " << ex.what();
             throw std::runtime_error(os.str());
         }
         else
             throw;
     }
+    throw std::runtime_error("castUnsafeV: conversion failed");
+}
+
+template<typename TO, typename FROM>
+static size_t castVTyped(size_t count, void *draw, const void *sraw, bool throws)
+{
+    TO *dest=(TO*)draw;
+    const FROM *src=(FROM*)sraw;
+
+    for(size_t i=0; i<count; i++) {
+        if(!tryCastUnsafe<TO,FROM>(dest[i], src[i])) {
+            if(throws)
+                castFailed<TO,FROM>(count, i, src[i]);
+            return i;
+        }
+    }
+    return count;
+}
+
+// std::ostream formats numbers as printf() does when the locale is classic
+static bool classicLocale()
+{
+    return std::locale()==std::locale::classic();
+}
+
+static void formatUInt(std::string& out, epicsUInt64 v, bool neg)
+{
+    char buf[24];
+    char *end = buf+sizeof(buf), *pos = end;
+    do {
+        *--pos = char('0' + v%10u);
+        v /= 10u;
+    } while(v);
+    if(neg)
+        *--pos = '-';
+    out.append(pos, end-pos);
+}
+
+static void formatInt(std::string& out, epicsInt64 v)
+{
+    if(v<0)
+        formatUInt(out, epicsUInt64(0u)-epicsUInt64(v), true);
+    else
+        formatUInt(out, epicsUInt64(v), false);
+}
+
+// what num_put does with the default floatfield and precision
+static void formatReal(std::string& out, double v)
+{
+    char buf[32];
+    int n = epicsSnprintf(buf, sizeof(buf), "%.6g", v);
+    if(n<0 || size_t(n)>=sizeof(buf)) {
+        std::ostringstream strm;
+        strm<<v;
+        out += strm.str();
+        return;
+    }
+    const char dp = *localeconv()->decimal_point;
+    if(dp!='.') {
+        // printf() follows the C locale, while the stream is "C"
+        for(int i=0; i<n; i++)
+            if(buf[i]==dp) buf[i] = '.';
+    }
+    out.append(buf, n);
+}
+
+static FORCE_INLINE void formatPOD(std::string& out, boolean v) { out += v ? "true" : "false"; }
+static FORCE_INLINE void formatPOD(std::string& out, int8 v) { formatInt(out, v); }
+static FORCE_INLINE void formatPOD(std::string& out, uint8 v) { formatUInt(out, v, false); }
+static FORCE_INLINE void formatPOD(std::string& out, int16_t v) { formatInt(out, v); }
+static FORCE_INLINE void formatPOD(std::string& out, uint16_t v) { formatUInt(out, v, false); }
+static FORCE_INLINE void formatPOD(std::string& out, int32_t v) { formatInt(out, v); }
+static FORCE_INLINE void formatPOD(std::string& out, uint32_t v) { formatUInt(out, v, false); }
+static FORCE_INLINE void formatPOD(std::string& out, int64_t v) { formatInt(out, v); }
+static FORCE_INLINE void formatPOD(std::string& out, uint64_t v) { formatUInt(out, v, false); }
+static FORCE_INLINE void formatPOD(std::string& out, float v) { formatReal(out, v); }
+static FORCE_INLINE void formatPOD(std::string& out, double v) { formatReal(out, v); }
+
+template<typename T>
+static void printPODT(std::string& out, T v)
+{
+    if(classicLocale()) {
+        formatPOD(out, v);
+    } else {
+        std::ostringstream strm;
+        strm << epics::pvData::detail::print_convolute<T>::op(v);
+        out += strm.str();
+    }
+}
+
+// numeric -> numeric can not fail, so the loop is kept free of calls
+// and branches which would prevent the compiler from vectorizing it.
+template<typename TO, typename FROM>
+struct castVHelper {
+    static size_t op(size_t count, void *draw, const void *sraw, bool)
+    {
+        TO* dest=(TO*)draw;
+        const FROM* src=(const FROM*)sraw;
+        for(size_t i=0; i<count; i++)
+            dest[i] = static_cast<TO>(src[i]);
+        return count;
+    }
+};
+
+// inline equivalent of epicsConvertDoubleToFloat()
+static FORCE_INLINE float clipToFloat(double v)
+{
+    const double a = fabs(v);
+    double c = a>=FLT_MAX && a!=HUGE_VAL ? (v>0.0 ? FLT_MAX : -FLT_MAX) : v;
+    c = a<=FLT_MIN ? (v>0.0 ? FLT_MIN : -FLT_MIN) : c;
+    return v==0.0 ? 0.0f : static_cast<float>(c);
 }
 
+template<>
+struct castVHelper<float, double> {
+    static size_t op(size_t count, void *draw, const void *sraw, bool)
+    {
+        float* dest=(float*)draw;
+        const double* src=(const double*)sraw;
+        for(size_t i=0; i<count; i++)
+            dest[i] = clipToFloat(src[i]);
+        return count;
+    }
+};
+
+// printing can not fail.  Existing storage of dest is re-used.
+template<typename FROM>
+struct castVHelper<std::string, FROM> {
+    static size_t op(size_t count, void *draw, const void *sraw, bool throws)
+    {
+        if(!classicLocale())
+            return castVTyped<std::string, FROM>(count, draw, sraw, throws);
+
+        std::string *dest=(std::string*)draw;
+        const FROM *src=(const FROM*)sraw;
+        for(size_t i=0; i<count; i++) {
+            dest[i].clear();
+            formatPOD(dest[i], src[i]);
+        }
+        return count;
+    }
+};
+
+template<typename TO>
+struct castVHelper<TO, std::string> {
+    static size_t op(size_t count, void *draw, const void *sraw, bool throws)
+    { return castVTyped<TO, std::string>(count, draw, sraw, throws); }
+};
+
 template<typename T>
-static void copyV(size_t count, void *draw, const void *sraw)
+static size_t copyV(size_t count, void *draw, const void *sraw)
 {
     T *dest=(T*)draw;
     const T *src=(const T*)sraw;
     std::copy(src, src+count, dest);
+    return count;
 }
 
 template<int N>
-static void copyMem(size_t count, void *draw, const void *sraw)
+static size_t copyMem(size_t count, void *draw, const void *sraw)
 {
     memcpy(draw, sraw, count*N);
+    return count;
 }
 
-} // end namespace
-
-namespace epics { namespace pvData {
-
-void castUnsafeV(size_t count, ScalarType to, void *dest, ScalarType from, const void *src)
+// returns the number of elements converted.
+// When !throws, less than count if an element can't be converted,
+// or 'unsupported'.
+static size_t castV(size_t count, ScalarType to, void *dest, ScalarType from, const void *src, bool throws)
 {
 #define COPYMEM(N) copyMem<N>(count, dest, src)
-#define CAST(TO, FROM) castVTyped<TO, FROM>(count, dest, src)
+#define CAST(TO, FROM) castVHelper<TO, FROM>::op(count, dest, src, throws)
 
     switch(to) {
     case pvBoolean:
         switch(from) {
-        case pvBoolean: COPYMEM(1); return;
-        case pvString: CAST(boolean, std::string); return;
-        default: noconvert(); return;
+        case pvBoolean: return COPYMEM(1);
+        case pvString: return CAST(boolean, std::string);
+        default: return noconvert(throws);
         }
         break;
 
     case pvByte:
         switch(from) {
-        case pvBoolean: noconvert(); return;
+        case pvBoolean: return noconvert(throws);
         case pvByte:
-        case pvUByte:   COPYMEM(1); return;
-        case pvShort:   CAST(int8, int16); return;
-        case pvUShort:  CAST(int8, uint16); return;
-        case pvInt:     CAST(int8, int32); return;
-        case pvUInt:    CAST(int8, uint32); return;
-        case pvLong:    CAST(int8, int64); return;
-        case pvULong:   CAST(int8, uint64); return;
-        case pvFloat:   CAST(int8, float); return;
-        case pvDouble:  CAST(int8, double); return;
-        case pvString:  CAST(int8, std::string); return;
+        case pvUByte:   return COPYMEM(1);
+        case pvShort:   return CAST(int8, int16);
+        case pvUShort:  return CAST(int8, uint16);
+        case pvInt:     return CAST(int8, int32);
+        case pvUInt:    return CAST(int8, uint32);
+        case pvLong:    return CAST(int8, int64);
+        case pvULong:   return CAST(int8, uint64);
+        case pvFloat:   return CAST(int8, float);
+        case pvDouble:  return CAST(int8, double);
+        case pvString:  return CAST(int8, std::string);
         }
         break;
 
     case pvUByte:
         switch(from) {
-        case pvBoolean: noconvert(); return;
+        case pvBoolean: return noconvert(throws);
         case pvByte:
-        case pvUByte:   COPYMEM(1); return;
-        case pvShort:   CAST(uint8, int16); return;
-        case pvUShort:  CAST(uint8, uint16); return;
-        case pvInt:     CAST(uint8, int32); return;
-        case pvUInt:    CAST(uint8, uint32); return;
-        case pvLong:    CAST(uint8, int64); return;
-        case pvULong:   CAST(uint8, uint64); return;
-        case pvFloat:   CAST(uint8, float); return;
-        case pvDouble:  CAST(uint8, double); return;
-        case pvString:  CAST(uint8, std::string); return;
+        case pvUByte:   return COPYMEM(1);
+        case pvShort:   return CAST(uint8, int16);
+        case pvUShort:  return CAST(uint8, uint16);
+        case pvInt:     return CAST(uint8, int32);
+        case pvUInt:    return CAST(uint8, uint32);
+        case pvLong:    return CAST(uint8, int64);
+        case pvULong:   return CAST(uint8, uint64);
+        case pvFloat:   return CAST(uint8, float);
+        case pvDouble:  return CAST(uint8, double);
+        case pvString:  return CAST(uint8, std::string);
         }
         break;
 
     case pvShort:
         switch(from) {
-        case pvBoolean: noconvert(); return;
-        case pvByte:    CAST(int16, int8); return;
-        case pvUByte:   CAST(int16, uint8); return;
+        case pvBoolean: return noconvert(throws);
+        case pvByte:    return CAST(int16, int8);
+        case pvUByte:   return CAST(int16, uint8);
         case pvShort:
-        case pvUShort:  COPYMEM(2); return;
-        case pvInt:     CAST(int16, int32); return;
-        case pvUInt:    CAST(int16, uint32); return;
-        case pvLong:    CAST(int16, int64); return;
-        case pvULong:   CAST(int16, uint64); return;
-        case pvFloat:   CAST(int16, float); return;
-        case pvDouble:  CAST(int16, double); return;
-        case pvString:  CAST(int16, std::string); return;
+        case pvUShort:  return COPYMEM(2);
+        case pvInt:     return CAST(int16, int32);
+        case pvUInt:    return CAST(int16, uint32);
+        case pvLong:    return CAST(int16, int64);
+        case pvULong:   return CAST(int16, uint64);
+        case pvFloat:   return CAST(int16, float);
+        case pvDouble:  return CAST(int16, double);
+        case pvString:  return CAST(int16, std::string);
         }
         break;
 
     case pvUShort:
         switch(from) {
-        case pvBoolean: noconvert(); return;
-        case pvByte:    CAST(uint16, int8); return;
-        case pvUByte:   CAST(uint16, uint8); return;
+        case pvBoolean: return noconvert(throws);
+        case pvByte:    return CAST(uint16, int8);
+        case pvUByte:   return CAST(uint16, uint8);
         case pvShort:
-        case pvUShort:  COPYMEM(2); return;
-        case pvInt:     CAST(uint16, int32); return;
-        case pvUInt:    CAST(uint16, uint32); return;
-        case pvLong:    CAST(uint16, int64); return;
-        case pvULong:   CAST(uint16, uint64); return;
-        case pvFloat:   CAST(uint16, float); return;
-        case pvDouble:  CAST(uint16, double); return;
-        case pvString:  CAST(uint16, std::string); return;
+        case pvUShort:  return COPYMEM(2);
+        case pvInt:     return CAST(uint16, int32);
+        case pvUInt:    return CAST(uint16, uint32);
+        case pvLong:    return CAST(uint16, int64);
+        case pvULong:   return CAST(uint16, uint64);
+        case pvFloat:   return CAST(uint16, float);
+        case pvDouble:  return CAST(uint16, double);
+        case pvString:  return CAST(uint16, std::string);
         }
         break;
 
     case pvInt:
         switch(from) {
-        case pvBoolean: noconvert(); return;
-        case pvByte:    CAST(int32, int8); return;
-        case pvUByte:   CAST(int32, uint8); return;
-        case pvShort:   CAST(int32, int16); return;
-        case pvUShort:  CAST(int32, uint16); return;
+        case pvBoolean: return noconvert(throws);
+        case pvByte:    return CAST(int32, int8);
+        case pvUByte:   return CAST(int32, uint8);
+        case pvShort:   return CAST(int32, int16);
+        case pvUShort:  return CAST(int32, uint16);
         case pvInt:
-        case pvUInt:    COPYMEM(4); return;
-        case pvLong:    CAST(int32, int64); return;
-        case pvULong:   CAST(int32, uint64); return;
-        case pvFloat:   CAST(int32, float); return;
-        case pvDouble:  CAST(int32, double); return;
-        case pvString:  CAST(int32, std::string); return;
+        case pvUInt:    return COPYMEM(4);
+        case pvLong:    return CAST(int32, int64);
+        case pvULong:   return CAST(int32, uint64);
+        case pvFloat:   return CAST(int32, float);
+        case pvDouble:  return CAST(int32, double);
+        case pvString:  return CAST(int32, std::string);
         }
         break;
 
     case pvUInt:
         switch(from) {
-        case pvBoolean: noconvert(); return;
-        case pvByte:    CAST(uint32, int8); return;
-        case pvUByte:   CAST(uint32, uint8); return;
-        case pvShort:   CAST(uint32, int16); return;
-        case pvUShort:  CAST(uint32, uint16); return;
+        case pvBoolean: return noconvert(throws);
+        case pvByte:    return CAST(uint32, int8);
+        case pvUByte:   return CAST(uint32, uint8);
+        case pvShort:   return CAST(uint32, int16);
+        case pvUShort:  return CAST(uint32, uint16);
         case pvInt:
-        case pvUInt:    COPYMEM(4); return;
-        case pvLong:    CAST(uint32, int64); return;
-        case pvULong:   CAST(uint32, uint64); return;
-        case pvFloat:   CAST(uint32, float); return;
-        case pvDouble:  CAST(uint32, double); return;
-        case pvString:  CAST(uint32, std::string); return;
+        case pvUInt:    return COPYMEM(4);
+        case pvLong:    return CAST(uint32, int64);
+        case pvULong:   return CAST(uint32, uint64);
+        case pvFloat:   return CAST(uint32, float);
+        case pvDouble:  return CAST(uint32, double);
+        case pvString:  return CAST(uint32, std::string);
         }
         break;
 
     case pvLong:
         switch(from) {
-        case pvBoolean: noconvert(); return;
-        case pvByte:    CAST(int64, int8); return;
-        case pvUByte:   CAST(int64, uint8); return;
-        case pvShort:   CAST(int64, int16); return;
-        case pvUShort:  CAST(int64, uint16); return;
-        case pvInt:     CAST(int64, int32); return;
-        case pvUInt:    CAST(int64, uint32); return;
+        case pvBoolean: return noconvert(throws);
+        case pvByte:    return CAST(int64, int8);
+        case pvUByte:   return CAST(int64, uint8);
+        case pvShort:   return CAST(int64, int16);
+        case pvUShort:  return CAST(int64, uint16);
+        case pvInt:     return CAST(int64, int32);
+        case pvUInt:    return CAST(int64, uint32);
         case pvLong:
-        case pvULong:   COPYMEM(8); return;
-        case pvFloat:   CAST(int64, float); return;
-        case pvDouble:  CAST(int64, double); return;
-        case pvString:  CAST(int64, std::string); return;
+        case pvULong:   return COPYMEM(8);
+        case pvFloat:   return CAST(int64, float);
+        case pvDouble:  return CAST(int64, double);
+        case pvString:  return CAST(int64, std::string);
         }
         break;
 
     case pvULong:
         switch(from) {
-        case pvBoolean: noconvert(); return;
-        case pvByte:    CAST(uint64, int8); return;
-        case pvUByte:   CAST(uint64, uint8); return;
-        case pvShort:   CAST(uint64, int16); return;
-        case pvUShort:  CAST(uint64, uint16); return;
-        case pvInt:     CAST(uint64, int32); return;
-        case pvUInt:    CAST(uint64, uint32); return;
+        case pvBoolean: return noconvert(throws);
+        case pvByte:    return CAST(uint64, int8);
+        case pvUByte:   return CAST(uint64, uint8);
+        case pvShort:   return CAST(uint64, int16);
+        case pvUShort:  return CAST(uint64, uint16);
+        case pvInt:     return CAST(uint64, int32);
+        case pvUInt:    return CAST(uint64, uint32);
         case pvLong:
-        case pvULong:   COPYMEM(8); return;
-        case pvFloat:   CAST(uint64, float); return;
-        case pvDouble:  CAST(uint64, double); return;
-        case pvString:  CAST(uint64, std::string); return;
+        case pvULong:   return COPYMEM(8);
+        case pvFloat:   return CAST(uint64, float);
+        case pvDouble:  return CAST(uint64, double);
+        case pvString:  return CAST(uint64, std::string);
         }
         break;
 
     case pvFloat:
         switch(from) {
-        case pvBoolean: noconvert(); return;
-        case pvByte:    CAST(float, int8); return;
-        case pvUByte:   CAST(float, uint8); return;
-        case pvShort:   CAST(float, int16); return;
-        case pvUShort:  CAST(float, uint16); return;
-        case pvInt:     CAST(float, int32); return;
-        case pvUInt:    CAST(float, uint32); return;
-        case pvLong:    CAST(float, int64); return;
-        case pvULong:   CAST(float, uint64); return;
-        case pvFloat:   COPYMEM(4); return;
-        case pvDouble:  CAST(float, double); return;
-        case pvString:  CAST(float, std::string); return;
+        case pvBoolean: return noconvert(throws);
+        case pvByte:    return CAST(float, int8);
+        case pvUByte:   return CAST(float, uint8);
+        case pvShort:   return CAST(float, int16);
+        case pvUShort:  return CAST(float, uint16);
+        case pvInt:     return CAST(float, int32);
+        case pvUInt:    return CAST(float, uint32);
+        case pvLong:    return CAST(float, int64);
+        case pvULong:   return CAST(float, uint64);
+        case pvFloat:   return COPYMEM(4);
+        case pvDouble:  return CAST(float, double);
+        case pvString:  return CAST(float, std::string);
         }
         break;
 
     case pvDouble:
         switch(from) {
-        case pvBoolean: noconvert(); return;
-        case pvByte:    CAST(double, int8); return;
-        case pvUByte:   CAST(double, uint8); return;
-        case pvShort:   CAST(double, int16); return;
-        case pvUShort:  CAST(double, uint16); return;
-        case pvInt:     CAST(double, int32); return;
-        case pvUInt:    CAST(double, uint32); return;
-        case pvLong:    CAST(double, int64); return;
-        case pvULong:   CAST(double, uint64); return;
-        case pvFloat:   CAST(double, float); return;
-        case pvDouble:  COPYMEM(8); return;
-        case pvString:  CAST(double, std::string); return;
+        case pvBoolean: return noconvert(throws);
+        case pvByte:    return CAST(double, int8);
+        case pvUByte:   return CAST(double, uint8);
+        case pvShort:   return CAST(double, int16);
+        case pvUShort:  return CAST(double, uint16);
+        case pvInt:     return CAST(double, int32);
+        case pvUInt:    return CAST(double, uint32);
+        case pvLong:    return CAST(double, int64);
+        case pvULong:   return CAST(double, uint64);
+        case pvFloat:   return CAST(double, float);
+        case pvDouble:  return COPYMEM(8);
+        case pvString:  return CAST(double, std::string);
         }
         break;
 
     case pvString:
         switch(from) {
-        case pvBoolean: CAST(std::string, boolean); return;
-        case pvByte:    CAST(std::string, int8); return;
-        case pvUByte:   CAST(std::string, uint8); return;
-        case pvShort:   CAST(std::string, int16); return;
-        case pvUShort:  CAST(std::string, uint16); return;
-        case pvInt:     CAST(std::string, int32); return;
-        case pvUInt:    CAST(std::string, uint32); return;
-        case pvLong:    CAST(std::string, int64); return;
-        case pvULong:   CAST(std::string, uint64); return;
-        case pvFloat:   CAST(std::string, float); return;
-        case pvDouble:  CAST(std::string, double); return;
-        case pvString:  copyV<std::string>(count, dest, src); return;
+        case pvBoolean: return CAST(std::string, boolean);
+        case pvByte:    return CAST(std::string, int8);
+        case pvUByte:   return CAST(std::string, uint8);
+        case pvShort:   return CAST(std::string, int16);
+        case pvUShort:  return CAST(std::string, uint16);
+        case pvInt:     return CAST(std::string, int32);
+        case pvUInt:    return CAST(std::string, uint32);
+        case pvLong:    return CAST(std::string, int64);
+        case pvULong:   return CAST(std::string, uint64);
+        case pvFloat:   return CAST(std::string, float);
+        case pvDouble:  return CAST(std::string, double);
+        case pvString:  return copyV<std::string>(count, dest, src);
         }
         break;
     }
 
     THROW_EXCEPTION2(std::logic_error, "Undefined cast");
+#undef COPYMEM
+#undef CAST
+}
+
+// conversions which can not fail, and so may be split up
+static bool parallelSafe(ScalarType to, ScalarType from)
+{
+    if(to==pvString || from==pvString)
+        return false;
+    return to==from || (to!=pvBoolean && from!=pvBoolean);
+}
+
+struct CastJob {
+    ScalarType to, from;
+    char *dest;
+    const char *src;
+    size_t dsize, ssize;
+};
+
+static void castChunk(void *raw, size_t first, size_t last)
+{
+    const CastJob *job = static_cast<const CastJob*>(raw);
+    (void)castV(last-first, job->to, job->dest+first*job->dsize,
+                job->from, job->src+first*job->ssize, false);
+}
+
+static bool castParallel(size_t count, ScalarType to, void *dest, ScalarType from, const void *src)
+{
+    if(!parallelSafe(to, from))
+        return false;
+    CastJob job = {to, from, static_cast<char*>(dest), static_cast<const char*>(src),
+                   ScalarTypeFunc::elementSize(to), ScalarTypeFunc::elementSize(from)};
+    return epics::pvData::detail::parallelFor(count, std::max(job.dsize, job.ssize), &castChunk, &job);
+}
+
+} // end namespace
+
+namespace epics { namespace pvData {
+
+namespace detail {
+
+void printPOD(std::string& out, boolean v) { printPODT(out, v); }
+void printPOD(std::string& out, int8 v) { printPODT(out, v); }
+void printPOD(std::string& out, uint8 v) { printPODT(out, v); }
+void printPOD(std::string& out, int16_t v) { printPODT(out, v); }
+void printPOD(std::string& out, uint16_t v) { printPODT(out, v); }
+void printPOD(std::string& out, int32_t v) { printPODT(out, v); }
+void printPOD(std::string& out, uint32_t v) { printPODT(out, v); }
+void printPOD(std::string& out, int64_t v) { printPODT(out, v); }
+void printPOD(std::string& out, uint64_t v) { printPODT(out, v); }
+void printPOD(std::string& out, float v) { printPODT(out, v); }
+void printPOD(std::string& out, double v) { printPODT(out, v); }
+
+} // namespace detail
+
+void castUnsafeV(size_t count, ScalarType to, void *dest, ScalarType from, const void *src)
+{
+    if(!castParallel(count, to, dest, from, src))
+        (void)castV(count, to, dest, from, src, true);
+}
+
+bool tryCastUnsafeV(size_t count, ScalarType to, void *dest, ScalarType from, const void *src, size_t *nconverted)
+{
+    if(castParallel(count, to, dest, from, src)) {
+        if(nconverted)
+            *nconverted = count;
+        return true;
+    }
+    size_t n = castV(count, to, dest, from, src, false);
+    if(nconverted)
+        *nconverted = n==unsupported ? 0u : n;
+    return n==count;
 }
 
 }}
@@ -40,7 +40,7 @@ public:
      * 
      * Constructor
      */
-    PVAlarm() {}
+    PVAlarm() :pvSeverity(0), pvStatus(0), pvMessage(0) {}
     //default constructors and destructor are OK
     //returns (false,true) if pvField(is not, is) a valid alarm structure
     //An automatic detach is issued if already attached.
@@ -80,9 +80,11 @@ public:
      */
     bool set(Alarm const & alarm);
 private:
-    PVIntPtr pvSeverity;
-    PVIntPtr pvStatus;
-    PVStringPtr pvMessage;
+    // the attached structure, which owns the fields below
+    PVStructurePtr pvStructure;
+    PVInt *pvSeverity;
+    PVInt *pvStatus;
+    PVString *pvMessage;
     static std::string noAlarmFound;
     static std::string notAttached;
 };
@@ -37,7 +37,7 @@ public:
      * 
      * Constructor
      */
-    PVControl(){}
+    PVControl() :pvLow(0), pvHigh(0), pvMinStep(0) {}
     //default constructors and destructor are OK
     //returns (false,true) if pvField(is not, is) a valid control structure
     //An automatic detach is issued if already attached.
@@ -72,9 +72,11 @@ public:
      */
     bool set(Control const & control);
 private:
-    PVDoublePtr pvLow;
-    PVDoublePtr pvHigh;
-    PVDoublePtr pvMinStep;
+    // the attached structure, which owns the fields below
+    PVStructurePtr pvStructure;
+    PVDouble *pvLow;
+    PVDouble *pvHigh;
+    PVDouble *pvMinStep;
     static std::string noControlFound;
     static std::string notAttached;
 };
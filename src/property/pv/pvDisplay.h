@@ -42,7 +42,7 @@ public:
      * 
      * Constructor
      */
-    PVDisplay() {}
+    PVDisplay() :pvDescription(0), pvFormat(0), pvUnits(0), pvLow(0), pvHigh(0) {}
     //default constructors and destructor are OK
     //An automatic detach is issued if already attached.
     /*
@@ -78,11 +78,13 @@ public:
 private:
     static std::string noDisplayFound;
     static std::string notAttached;
-    PVStringPtr pvDescription;
-    PVStringPtr pvFormat;
-    PVStringPtr pvUnits;
-    PVDoublePtr pvLow;
-    PVDoublePtr pvHigh;
+    // the attached structure, which owns the fields below
+    PVStructurePtr pvStructure;
+    PVString *pvDescription;
+    PVString *pvFormat;
+    PVString *pvUnits;
+    PVDouble *pvLow;
+    PVDouble *pvHigh;
 };
     
 }}
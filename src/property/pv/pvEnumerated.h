@@ -36,7 +36,7 @@ public:
     /*
      * Constructor.
      */
-    PVEnumerated() {}
+    PVEnumerated() :pvIndex(0), pvChoices(0) {}
     //default constructors and destructor are OK
     //This class should not be extended
     //returns (false,true) if pvField(is not, is) a valid enumerated structure
@@ -105,8 +105,10 @@ public:
 private:
     static std::string notFound;
     static std::string notAttached;
-    PVIntPtr pvIndex;
-    PVStringArrayPtr pvChoices;
+    // the attached structure, which owns the fields below
+    PVStructurePtr pvStructure;
+    PVInt *pvIndex;
+    PVStringArray *pvChoices;
 };
     
 }}
@@ -41,7 +41,7 @@ public:
      * 
      * Constructor
      */
-    PVTimeStamp(){}
+    PVTimeStamp() :pvSecs(0), pvUserTag(0), pvNano(0) {}
     //default constructors and destructor are OK
     //This class should not be extended
     
@@ -79,9 +79,11 @@ public:
 private:
     static std::string noTimeStamp;
     static std::string notAttached;
-    PVLongPtr pvSecs;
-    PVIntPtr pvUserTag;
-    PVIntPtr pvNano;
+    // the attached structure, which owns the fields below
+    PVStructurePtr pvStructure;
+    PVLong *pvSecs;
+    PVInt *pvUserTag;
+    PVInt *pvNano;
 };
     
 }}
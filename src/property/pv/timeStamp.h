@@ -117,8 +117,31 @@ public:
     void put(int64 milliseconds);
     /**
      * Set the timeStamp to the current time.
+     * The clock used is selected by setClockSource().
      */
     void getCurrent();
+    /**
+     * @brief Clocks which getCurrent() may read.
+     *
+     * Also used by Timer.
+     */
+    enum ClockSource {
+        //! epicsTimeGetCurrent(), which dispatches to the EPICS time providers.  The default.
+        ClockEPICS,
+        //! clock_gettime(CLOCK_REALTIME).  Served from the vDSO on Linux, without a system call.
+        ClockRealtime,
+        //! clock_gettime(CLOCK_REALTIME_COARSE) where available.  Cheaper, with a resolution of one scheduler tick (1-4 ms).
+        ClockRealtimeCoarse
+    };
+    /**
+     * Select the clock used by getCurrent() in all threads.
+     * Where clock_gettime() is not available, all sources use epicsTimeGetCurrent().
+     * Note that the EPICS time providers (eg. a timing system) are not consulted
+     * unless ClockEPICS is selected.
+     */
+    static void setClockSource(ClockSource source);
+    //! The clock currently used by getCurrent()
+    static ClockSource getClockSource();
     /**
      * Convert the timeStamp to a double value that is seconds past epoch.
      * @return seconds past 1970 UTC
@@ -23,42 +23,47 @@ namespace epics { namespace pvData {
 string PVAlarm::noAlarmFound("No alarm structure found");
 string PVAlarm::notAttached("Not attached to an alarm structure");
 
+namespace {
+const char * const alarmNames[] = {"severity", "status", "message"};
+const Type alarmTypes[] = {scalar, scalar, scalar};
+const ScalarType alarmScalarTypes[] = {pvInt, pvInt, pvString};
+const Structure::MemberSet alarmMembers = {3u, alarmNames, alarmTypes, alarmScalarTypes};
+}
+
 bool PVAlarm::attach(PVFieldPtr const & pvField)
 {
     if(pvField->getField()->getType()!=structure) return false;
-    PVStructurePtr pvStructure = static_pointer_cast<PVStructure>(pvField);
-    pvSeverity = pvStructure->getSubField<PVInt>("severity");
-    if(pvSeverity.get()==NULL) return false;
-    pvStatus = pvStructure->getSubField<PVInt>("status");
-    if(pvStatus.get()==NULL) {
-        pvSeverity.reset();
-        return false;
-    }
-    pvMessage = pvStructure->getSubField<PVString>("message");
-    if(pvMessage.get()==NULL) {
-        pvSeverity.reset();
-        pvStatus.reset();
+    PVStructurePtr pvTop = static_pointer_cast<PVStructure>(pvField);
+    const uint32 *idx = pvTop->getStructure()->getMemberIndices(alarmMembers);
+    if(!idx) {
+        detach();
         return false;
     }
+    const PVFieldPtrArray& fields = pvTop->getPVFields();
+    pvSeverity = static_cast<PVInt*>(fields[idx[0]].get());
+    pvStatus = static_cast<PVInt*>(fields[idx[1]].get());
+    pvMessage = static_cast<PVString*>(fields[idx[2]].get());
+    pvStructure.swap(pvTop);
     return true;
 }
 
 void PVAlarm::detach()
 {
-    pvSeverity.reset();
-    pvStatus.reset();
-    pvMessage.reset();
+    pvStructure.reset();
+    pvSeverity = NULL;
+    pvStatus = NULL;
+    pvMessage = NULL;
 }
 
 bool PVAlarm::isAttached()
 {
-    if(pvSeverity.get()==NULL) return false;
+    if(pvSeverity==NULL) return false;
     return true;
 }
 
 void PVAlarm::get(Alarm & alarm) const
 {
-    if(pvSeverity.get()==NULL) {
+    if(pvSeverity==NULL) {
         throw std::logic_error(notAttached);
     }
     alarm.setSeverity(AlarmSeverityFunc::getSeverity(pvSeverity->get()));
@@ -68,7 +73,7 @@ void PVAlarm::get(Alarm & alarm) const
 
 bool PVAlarm::set(Alarm const & alarm)
 {
-    if(pvSeverity.get()==NULL) {
+    if(pvSeverity==NULL) {
         throw std::logic_error(notAttached);
     }
     if(pvSeverity->isImmutable() || pvMessage->isImmutable()) return false;
@@ -23,40 +23,46 @@ using std::string;
 string PVControl::noControlFound("No control structure found");
 string PVControl::notAttached("Not attached to an control structure");
 
+namespace {
+const char * const controlNames[] = {"limitLow", "limitHigh", "minStep"};
+const Type controlTypes[] = {scalar, scalar, scalar};
+const ScalarType controlScalarTypes[] = {pvDouble, pvDouble, pvDouble};
+const Structure::MemberSet controlMembers = {3u, controlNames, controlTypes, controlScalarTypes};
+}
+
 bool PVControl::attach(PVFieldPtr const & pvField)
 {
     if(pvField->getField()->getType()!=structure) return false;
-    PVStructurePtr pvStructure = static_pointer_cast<PVStructure>(pvField);
-    pvLow = pvStructure->getSubField<PVDouble>("limitLow");
-    if(pvLow.get()==NULL) return false;
-    pvHigh = pvStructure->getSubField<PVDouble>("limitHigh");
-    if(pvHigh.get()==NULL) {
-        pvLow.reset();
-        return false;
-    }
-    pvMinStep = pvStructure->getSubField<PVDouble>("minStep");
-    if(pvMinStep.get()==NULL) {
-        pvLow.reset();
-        pvHigh.reset();
+    PVStructurePtr pvTop = static_pointer_cast<PVStructure>(pvField);
+    const uint32 *idx = pvTop->getStructure()->getMemberIndices(controlMembers);
+    if(!idx) {
+        detach();
         return false;
     }
+    const PVFieldPtrArray& fields = pvTop->getPVFields();
+    pvLow = static_cast<PVDouble*>(fields[idx[0]].get());
+    pvHigh = static_cast<PVDouble*>(fields[idx[1]].get());
+    pvMinStep = static_cast<PVDouble*>(fields[idx[2]].get());
+    pvStructure.swap(pvTop);
     return true;
 }
 
 void PVControl::detach()
 {
-    pvLow.reset();
-    pvHigh.reset();
+    pvStructure.reset();
+    pvLow = NULL;
+    pvHigh = NULL;
+    pvMinStep = NULL;
 }
 
 bool PVControl::isAttached(){
-    if(pvLow.get()==NULL) return false;
+    if(pvLow==NULL) return false;
     return true;
 }
 
 void PVControl::get(Control &control) const
 {
-    if(pvLow.get()==NULL) {
+    if(pvLow==NULL) {
         throw std::logic_error(notAttached);
     }
     control.setLow(pvLow->get());
@@ -66,7 +72,7 @@ void PVControl::get(Control &control) const
 
 bool PVControl::set(Control const & control)
 {
-    if(pvLow.get()==NULL) {
+    if(pvLow==NULL) {
         throw std::logic_error(notAttached);
     }
     if(pvLow->isImmutable() || pvHigh->isImmutable() || pvMinStep->isImmutable()) return false;
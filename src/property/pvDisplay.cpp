@@ -23,52 +23,50 @@ namespace epics { namespace pvData {
 string PVDisplay::noDisplayFound("No display structure found");
 string PVDisplay::notAttached("Not attached to an display structure");
 
+namespace {
+const char * const displayNames[] = {"description", "format", "units", "limitLow", "limitHigh"};
+const Type displayTypes[] = {scalar, scalar, scalar, scalar, scalar};
+const ScalarType displayScalarTypes[] = {pvString, pvString, pvString, pvDouble, pvDouble};
+const Structure::MemberSet displayMembers = {5u, displayNames, displayTypes, displayScalarTypes};
+}
+
 bool PVDisplay::attach(PVFieldPtr const & pvField)
 {
     if(pvField->getField()->getType()!=structure) return false;
-    PVStructurePtr pvStructure = static_pointer_cast<PVStructure>(pvField);
-    pvDescription = pvStructure->getSubField<PVString>("description");
-    if(pvDescription.get()==NULL) return false;
-    pvFormat = pvStructure->getSubField<PVString>("format");
-    if(pvFormat.get()==NULL) {
-        detach();
-        return false;
-    }
-    pvUnits = pvStructure->getSubField<PVString>("units");
-    if(pvUnits.get()==NULL) {
-        detach();
-        return false;
-    }
-    pvLow = pvStructure->getSubField<PVDouble>(string("limitLow"));
-    if(pvLow.get()==NULL) {
-        detach();
-        return false;
-    }
-    pvHigh = pvStructure->getSubField<PVDouble>(string("limitHigh"));
-    if(pvHigh.get()==NULL) {
+    PVStructurePtr pvTop = static_pointer_cast<PVStructure>(pvField);
+    const uint32 *idx = pvTop->getStructure()->getMemberIndices(displayMembers);
+    if(!idx) {
         detach();
         return false;
     }
+    const PVFieldPtrArray& fields = pvTop->getPVFields();
+    pvDescription = static_cast<PVString*>(fields[idx[0]].get());
+    pvFormat = static_cast<PVString*>(fields[idx[1]].get());
+    pvUnits = static_cast<PVString*>(fields[idx[2]].get());
+    pvLow = static_cast<PVDouble*>(fields[idx[3]].get());
+    pvHigh = static_cast<PVDouble*>(fields[idx[4]].get());
+    pvStructure.swap(pvTop);
     return true;
 }
 
 void PVDisplay::detach()
 {
-    pvDescription.reset();
-    pvFormat.reset();
-    pvUnits.reset();
-    pvLow.reset();
-    pvHigh.reset();
+    pvStructure.reset();
+    pvDescription = NULL;
+    pvFormat = NULL;
+    pvUnits = NULL;
+    pvLow = NULL;
+    pvHigh = NULL;
 }
 
 bool PVDisplay::isAttached() {
-    if(pvDescription.get()) return false;
+    if(pvDescription) return false;
     return true;
 }
 
 void PVDisplay::get(Display & display) const
 {
-    if(pvDescription.get()==NULL) {
+    if(pvDescription==NULL) {
         throw std::logic_error(notAttached);
     }
     display.setDescription(pvDescription->get());
@@ -80,7 +78,7 @@ void PVDisplay::get(Display & display) const
 
 bool PVDisplay::set(Display const & display)
 {
-    if(pvDescription.get()==NULL) {
+    if(pvDescription==NULL) {
         throw std::logic_error(notAttached);
     }
     if(pvDescription->isImmutable() || pvFormat->isImmutable()) return false;
@@ -23,35 +23,44 @@ namespace epics { namespace pvData {
 string PVEnumerated::notFound("No enumerated structure found");
 string PVEnumerated::notAttached("Not attached to an enumerated structure");
 
+namespace {
+const char * const enumeratedNames[] = {"index", "choices"};
+const Type enumeratedTypes[] = {scalar, scalarArray};
+const ScalarType enumeratedScalarTypes[] = {pvInt, pvString};
+const Structure::MemberSet enumeratedMembers = {2u, enumeratedNames, enumeratedTypes, enumeratedScalarTypes};
+}
+
 bool PVEnumerated::attach(PVFieldPtr const & pvField)
 {
     if(pvField->getField()->getType()!=structure) return false;
-    PVStructurePtr pvStructure = static_pointer_cast<PVStructure>(pvField);
-    pvIndex = pvStructure->getSubField<PVInt>("index");
-    if(pvIndex.get()==NULL) return false;
-    PVStringArrayPtr pvStringArray = pvStructure->getSubField<PVStringArray>("choices");
-    if(pvStringArray.get()==NULL) {
-        pvIndex.reset();
+    PVStructurePtr pvTop = static_pointer_cast<PVStructure>(pvField);
+    const uint32 *idx = pvTop->getStructure()->getMemberIndices(enumeratedMembers);
+    if(!idx) {
+        detach();
         return false;
     }
-    pvChoices = pvStringArray;
+    const PVFieldPtrArray& fields = pvTop->getPVFields();
+    pvIndex = static_cast<PVInt*>(fields[idx[0]].get());
+    pvChoices = static_cast<PVStringArray*>(fields[idx[1]].get());
+    pvStructure.swap(pvTop);
     return true;
 }
 
 void PVEnumerated::detach()
 {
-    pvIndex.reset();
-    pvChoices.reset();
+    pvStructure.reset();
+    pvIndex = NULL;
+    pvChoices = NULL;
 }
 
 bool PVEnumerated::isAttached() {
-    if(pvIndex.get()==NULL) return false;
+    if(pvIndex==NULL) return false;
     return true;
 }
 
 bool PVEnumerated::setIndex(int32 index)
 {
-    if(pvIndex.get()==NULL ) {
+    if(pvIndex==NULL ) {
          throw std::logic_error(notAttached);
     }
     if(pvIndex->isImmutable()) return false;
@@ -61,7 +70,7 @@ bool PVEnumerated::setIndex(int32 index)
 
 int32 PVEnumerated::getIndex()
 {
-    if(pvIndex.get()==NULL ) {
+    if(pvIndex==NULL ) {
          throw std::logic_error(notAttached);
     }
     return pvIndex->get();
@@ -69,7 +78,7 @@ int32 PVEnumerated::getIndex()
 
 string PVEnumerated::getChoice()
 {
-    if(pvIndex.get()==NULL ) {
+    if(pvIndex==NULL ) {
          throw std::logic_error(notAttached);
     }
     size_t index = pvIndex->get();
@@ -83,7 +92,7 @@ string PVEnumerated::getChoice()
 
 bool PVEnumerated::choicesMutable()
 {
-    if(pvIndex.get()==NULL ) {
+    if(pvIndex==NULL ) {
          throw std::logic_error(notAttached);
     }
     return pvChoices->isImmutable();
@@ -91,7 +100,7 @@ bool PVEnumerated::choicesMutable()
 
 int32 PVEnumerated::getNumberChoices()
 {
-    if(pvIndex.get()==NULL ) {
+    if(pvIndex==NULL ) {
          throw std::logic_error(notAttached);
     }
     return static_cast<int32>(pvChoices->getLength());
@@ -99,7 +108,7 @@ int32 PVEnumerated::getNumberChoices()
 
 bool PVEnumerated:: setChoices(const StringArray & choices)
 {
-    if(pvIndex.get()==NULL ) {
+    if(pvIndex==NULL ) {
          throw std::logic_error(notAttached);
     }
     if(pvChoices->isImmutable()) return false;
@@ -23,44 +23,51 @@ namespace epics { namespace pvData {
 string PVTimeStamp::noTimeStamp("No timeStamp structure found");
 string PVTimeStamp::notAttached("Not attached to a timeStamp structure");
 
+namespace {
+const char * const timeStampNames[] = {"secondsPastEpoch", "nanoseconds", "userTag"};
+const Type timeStampTypes[] = {scalar, scalar, scalar};
+const ScalarType timeStampScalarTypes[] = {pvLong, pvInt, pvInt};
+const Structure::MemberSet timeStampMembers = {3u, timeStampNames, timeStampTypes, timeStampScalarTypes};
+}
+
 bool PVTimeStamp::attach(PVFieldPtr const & pvField)
 {
     if(pvField->getField()->getType()!=structure) return false;
-    PVStructurePtr xxx = static_pointer_cast<PVStructure>(pvField);
-    PVStructure* pvStructure = xxx.get();
+    PVStructure* pvTop = static_cast<PVStructure*>(pvField.get());
     while(true) {
-        PVLongPtr pvLong = pvStructure->getSubField<PVLong>("secondsPastEpoch");
-        if(pvLong) {
-            pvSecs = pvLong;
-            pvNano = pvStructure->getSubField<PVInt>("nanoseconds");
-            pvUserTag = pvStructure->getSubField<PVInt>("userTag");
+        const uint32 *idx = pvTop->getStructure()->getMemberIndices(timeStampMembers);
+        if(idx) {
+            const PVFieldPtrArray& fields = pvTop->getPVFields();
+            pvStructure = static_pointer_cast<PVStructure>(pvTop->shared_from_this());
+            pvSecs = static_cast<PVLong*>(fields[idx[0]].get());
+            pvNano = static_cast<PVInt*>(fields[idx[1]].get());
+            pvUserTag = static_cast<PVInt*>(fields[idx[2]].get());
+            return true;
         }
-        if(pvSecs
-        && pvNano
-        && pvUserTag) return true;
-        detach();
-        // look up the tree for a timeSyamp
-        pvStructure = pvStructure->getParent();
-        if(pvStructure==NULL) break;
+        // look up the tree for a timeStamp
+        pvTop = pvTop->getParent();
+        if(pvTop==NULL) break;
     }
+    detach();
     return false;
 }
 
 void PVTimeStamp::detach()
 {
-    pvSecs.reset();
-    pvUserTag.reset();
-    pvNano.reset();
+    pvStructure.reset();
+    pvSecs = NULL;
+    pvNano = NULL;
+    pvUserTag = NULL;
 }
 
 bool PVTimeStamp::isAttached() {
-    if(pvSecs.get()==NULL) return false;
+    if(pvSecs==NULL) return false;
     return true;
 }
 
 void PVTimeStamp::get(TimeStamp & timeStamp) const
 {
-    if(pvSecs.get()==NULL) {
+    if(pvSecs==NULL) {
         throw std::logic_error(notAttached);
     }
     timeStamp.put(pvSecs->get(),pvNano->get());
@@ -69,7 +76,7 @@ void PVTimeStamp::get(TimeStamp & timeStamp) const
 
 bool PVTimeStamp::set(TimeStamp const & timeStamp)
 {
-    if(pvSecs.get()==NULL) {
+    if(pvSecs==NULL) {
         throw std::logic_error(notAttached);
     }
     if(pvSecs->isImmutable() || pvNano->isImmutable()) return false;
@@ -11,8 +11,10 @@
 #include <cstddef>
 #include <string>
 #include <cstdio>
+#include <time.h>
 
 #include <epicsTime.h>
+#include <epicsAtomic.h>
 
 #define epicsExportSharedSymbols
 #include <pv/noDefaultMethods.h>
@@ -67,8 +69,39 @@ void TimeStamp::put(int64 milliseconds)
     nanoseconds = (milliseconds%1000)*1000000;
 }
 
+namespace {
+// TimeStamp::ClockSource.  Read without locking by TimeStamp::getCurrent()
+int clockSource = TimeStamp::ClockEPICS;
+}
+
+void TimeStamp::setClockSource(ClockSource source)
+{
+    epics::atomic::set(clockSource, int(source));
+}
+
+TimeStamp::ClockSource TimeStamp::getClockSource()
+{
+    return ClockSource(epics::atomic::get(clockSource));
+}
+
 void TimeStamp::getCurrent()
 {
+#if defined(CLOCK_REALTIME) && !defined(_WIN32)
+    const int source = epics::atomic::get(clockSource);
+    if(source!=ClockEPICS) {
+        clockid_t id = CLOCK_REALTIME;
+#  ifdef CLOCK_REALTIME_COARSE
+        if(source==ClockRealtimeCoarse)
+            id = CLOCK_REALTIME_COARSE;
+#  endif
+        struct timespec now;
+        if(clock_gettime(id, &now)==0) {
+            secondsPastEpoch = now.tv_sec;
+            nanoseconds = int32(now.tv_nsec);
+            return;
+        }
+    }
+#endif
     epicsTimeStamp epicsTime;
     epicsTimeGetCurrent(&epicsTime);
     secondsPastEpoch = epicsTime.secPastEpoch;
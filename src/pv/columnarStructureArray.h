@@ -0,0 +1,195 @@
+/* columnarStructureArray.h */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef COLUMNARSTRUCTUREARRAY_H
+#define COLUMNARSTRUCTUREARRAY_H
+
+#include <string>
+#include <vector>
+
+#include <pv/pvData.h>
+
+#include <shareLib.h>
+
+namespace epics { namespace pvData {
+
+/** @brief Columnar (struct-of-arrays) storage for an array of scalar only structures.
+ *
+ * A PVStructureArray holds one PVStructure per element.
+ * For large tables this costs far more memory than the data itself,
+ * and makes scans of a single field cache unfriendly.
+ *
+ * ColumnarStructureArray instead holds one contiguous array ("column")
+ * for each leaf field of the element Structure.
+ * The element Structure may contain only scalar fields,
+ * and sub-structures which themselves contain only scalar fields.
+ * Columns are ordered by field offset (depth first, the serialization order)
+ * and named by their path relative to the element (eg. "value" or "alarm.severity").
+ *
+ * Columns are stored as shared_vector<const T>.
+ * getColumn() returns a reference to this storage without copying,
+ * and putColumn() replaces a column by reference when the element type matches.
+ *
+ * serialize() and deserialize() produce and consume the same bytes
+ * as a (variable size) PVStructureArray with the same element Structure.
+ * When no column is a string, rows are (de)serialized in blocks with a single
+ * buffer check per block and one typed loop per column.
+ *
+ @code
+   ColumnarStructureArray table(getFieldCreate()->createFieldBuilder()
+                                    ->add("x", pvDouble)
+                                    ->add("y", pvDouble)
+                                    ->createStructure());
+   table.setLength(1000);
+   shared_vector<double> x(1000);
+   ...
+   table.putColumn("x", freeze(x));
+   shared_vector<const double> y(table.getColumn<double>("y"));
+ @endcode
+ */
+class epicsShareClass ColumnarStructureArray : public Serializable
+{
+public:
+    POINTER_DEFINITIONS(ColumnarStructureArray);
+
+    /**
+     * @param elementType The element Structure.
+     * @throws std::invalid_argument if elementType has a leaf which is not a scalar.
+     */
+    explicit ColumnarStructureArray(StructureConstPtr const & elementType);
+    virtual ~ColumnarStructureArray();
+
+    /**
+     * Get the element introspection interface.
+     * @return The element Structure.
+     */
+    const StructureConstPtr& getStructure() const {return elementType;}
+    /**
+     * Get the number of rows.
+     * @return The number of rows.
+     */
+    std::size_t getLength() const {return length;}
+    /**
+     * Set the number of rows.
+     * Existing rows are preserved.
+     * New rows are zero, false, or the empty string.
+     * @param length The new number of rows.
+     */
+    void setLength(std::size_t length);
+
+    /**
+     * Get the number of columns, which is the number of scalar leaves in the element Structure.
+     * @return The number of columns.
+     */
+    std::size_t getNumberColumns() const {return columns.size();}
+    /**
+     * Get the name of a column.
+     * @param index The column index.
+     * @return The path of the leaf field relative to the element.
+     */
+    const std::string& getColumnName(std::size_t index) const {return columns.at(index).name;}
+    /**
+     * Get the element type of a column.
+     * @param index The column index.
+     * @return The ScalarType of the leaf field.
+     */
+    ScalarType getColumnType(std::size_t index) const {return columns.at(index).type;}
+    /**
+     * Find a column by name.
+     * @param name The path of the leaf field relative to the element.
+     * @return The column index or -1 if not found.
+     */
+    std::size_t getColumnIndex(std::string const & name) const;
+
+    /**
+     * Get a reference to the storage of one column.
+     * original_type() is the ScalarType of the column.
+     * @param index The column index.
+     * @return The column data.
+     */
+    const shared_vector<const void>& getColumn(std::size_t index) const {return columns.at(index).data;}
+    /**
+     * Get a reference to the storage of one column.
+     * @param index The column index.
+     * @return The column data.
+     * @throws std::logic_error if T is not the element type of the column.
+     */
+    template<typename T>
+    shared_vector<const T> getColumn(std::size_t index) const
+    {
+        const Column& col = columns.at(index);
+        if(col.type!=(ScalarType)ScalarTypeID<T>::value)
+            throw std::logic_error("ColumnarStructureArray::getColumn element type mismatch");
+        return static_shared_vector_cast<const T>(col.data);
+    }
+    template<typename T>
+    shared_vector<const T> getColumn(std::string const & name) const
+    {
+        return getColumn<T>(findColumn(name));
+    }
+
+    /**
+     * Replace the contents of one column.
+     * If the element type of data is the type of the column then only a reference is stored,
+     * otherwise the data is converted with castUnsafeV().
+     * @param index The column index.
+     * @param data New column data.  Must have original_type() set.
+     * @throws std::length_error if data does not have getLength() elements.
+     */
+    void putColumn(std::size_t index, shared_vector<const void> const & data);
+    template<typename T>
+    void putColumn(std::size_t index, shared_vector<const T> const & data)
+    {
+        putColumn(index, static_shared_vector_cast<const void>(data));
+    }
+    template<typename T>
+    void putColumn(std::string const & name, shared_vector<const T> const & data)
+    {
+        putColumn(findColumn(name), static_shared_vector_cast<const void>(data));
+    }
+
+    /**
+     * Replace all rows with the contents of a PVStructureArray.
+     * @param from A structure array with the same element Structure.
+     * @throws std::invalid_argument if the element Structure differs.
+     * @throws std::runtime_error if an element of from is NULL.
+     */
+    void copyFrom(PVStructureArray const & from);
+    /**
+     * Replace the contents of a PVStructureArray with one PVStructure per row.
+     * @param to A structure array with the same element Structure.
+     * @throws std::invalid_argument if the element Structure differs.
+     */
+    void copyTo(PVStructureArray & to) const;
+
+    virtual void serialize(ByteBuffer *pbuffer,
+        SerializableControl *pflusher) const OVERRIDE FINAL;
+    /**
+     * Read rows serialized by a PVStructureArray.
+     * @throws std::runtime_error if the serialized array contains a NULL element.
+     */
+    virtual void deserialize(ByteBuffer *pbuffer,
+        DeserializableControl *pflusher) OVERRIDE FINAL;
+
+private:
+    struct Column {
+        std::string name;
+        ScalarType type;
+        shared_vector<const void> data;
+    };
+    std::size_t findColumn(std::string const & name) const;
+
+    StructureConstPtr elementType;
+    std::vector<Column> columns;
+    std::size_t length;
+    // bytes per serialized row (presence flag and all fields), or 0 if any column is a string
+    std::size_t rowSize;
+
+    EPICS_NOT_COPYABLE(ColumnarStructureArray)
+};
+
+}}
+
+#endif  /* COLUMNARSTRUCTUREARRAY_H */
@@ -39,6 +39,7 @@ namespace epics { namespace pvData {
  */
 
 class PostHandler;
+class PostBatchHandler;
 
 class PVField;
 class PVScalar;
@@ -60,6 +61,11 @@ template<typename T> class PVValueArray;
  */
 typedef std::tr1::shared_ptr<PostHandler> PostHandlerPtr;
 
+/**
+ * typedef for a pointer to a PostBatchHandler.
+ */
+typedef std::tr1::shared_ptr<PostBatchHandler> PostBatchHandlerPtr;
+
 /**
  * typedef for a pointer to a PVField.
  */
@@ -142,11 +148,33 @@ public:
     virtual void postPut() = 0;
 };
 
+/**
+ * @brief Receives the changes made to a PVStructure during a PVStructure::PostBatch
+ *
+ * @see PVStructure::setPostBatchHandler()
+ */
+class epicsShareClass PostBatchHandler
+{
+public:
+    POINTER_DEFINITIONS(PostBatchHandler);
+    virtual ~PostBatchHandler(){}
+    /**
+     * Called once when the outermost PostBatch of a PVStructure ends,
+     * if postPut() was called for any of its fields during the batch.
+     * @param changed Offsets, relative to the PVStructure, of the fields which called postPut().
+     */
+    virtual void postPut(const BitSet& changed) = 0;
+};
+
 /**
  * @brief PVField is the base class for each PVData field.
  *
  * Each PVData field has an interface that extends PVField.
  *
+ * The node is kept small as large structures may contain very many fields.
+ * The field name is not copied, but refers to the parent's Structure::getFieldNames(),
+ * and the rarely used postPut() handler is kept out of line.
+ *
  * @ingroup pvcontainer
  */
 class epicsShareClass PVField
@@ -161,9 +189,14 @@ public:
     virtual ~PVField();
     /**
      * Get the fieldName for this field.
+     *
+     * A sub-field may outlive its parent, and then keeps its name but has no parent.
+     * The name is moved out of the parent's Structure while the parent is being destroyed.
+     * So a sub-field must not be used by another thread while its parent is being destroyed,
+     * and a reference to the name must not be kept past the parent's lifetime.
      * @return The name or empty string if top-level field.
      */
-    inline const std::string& getFieldName() const {return fieldName;}
+    inline const std::string& getFieldName() const {return *fieldName;}
     /**
      * Fully expand the name of this field using the
      * names of its parent fields with a dot '.' separating
@@ -234,6 +267,13 @@ public:
      * @return The output stream.
      */
     virtual std::ostream& dumpValue(std::ostream& o) const = 0;
+    /**
+     * Get the number of bytes which serialize() will write.
+     * For a variant union, introspection data is counted as if the
+     * SerializableControl does not cache it.
+     * @return The serialized size in bytes.
+     */
+    virtual std::size_t getSerializedSize() const = 0;
 
     void copy(const PVField& from);
     void copyUnchecked(const PVField& from);
@@ -246,17 +286,26 @@ protected:
         return shared_from_this();
     }
     explicit PVField(FieldConstPtr field);
+    // The address of fieldName is kept.  It must be owned by parent->getStructure()
     void setParentAndName(PVStructure *parent, std::string const & fieldName);
 private:
     static void computeOffset(const PVField *pvField);
     static void computeOffset(const PVField *pvField,std::size_t offset);
-    std::string fieldName;
+    // when the parent is destroyed first
+    void orphan(const PVStructure *oldParent);
+    // record postPut() in any open PostBatch.  false if there is none
+    bool deferPost() const;
+    struct Extra;
+    // points into parent->getStructure()->getFieldNames(), to an empty string,
+    // or to a copy in extra once the parent has been destroyed
+    const std::string *fieldName;
     PVStructure *parent;
     const FieldConstPtr field;
-    size_t fieldOffset;
-    size_t nextFieldOffset;
+    uint32 fieldOffset;
+    uint32 nextFieldOffset;
     bool immutable;
-    PostHandlerPtr postHandler;
+    // allocated by setPostHandler()
+    Extra *extra;
     friend class PVDataCreate;
     friend class PVStructure;
     EPICS_NOT_COPYABLE(PVField)
@@ -310,6 +359,24 @@ public:
 
     virtual void getAs(AnyScalar& v) const =0;
 
+    /**
+     * As getAs(), but returns false instead of throwing
+     * when the value can not be converted.
+     @code
+      PVScalar* pv = ...;
+      int32 val;
+      if(!pv->tryGetAs(val)) { ... }
+     @endcode
+     * @param out Set to the converted value.  Unchanged when false is returned.
+     */
+    template<typename T>
+    inline bool tryGetAs(T& out) const {
+        return this->tryGetAs((void*)&out, (ScalarType)ScalarTypeID<T>::value);
+    }
+protected:
+    virtual bool tryGetAs(void *, ScalarType) const = 0;
+public:
+
     /**
      * Convert and assign the provided value.
      * The value type is determined from the function template argument
@@ -328,6 +395,19 @@ public:
     //! Convert and assign
     virtual void putFrom(const void *, ScalarType) = 0;
 
+    /**
+     * As putFrom(), but returns false instead of throwing
+     * when the value can not be converted.  The current value is then unchanged.
+     * Other errors, eg. a string longer than a bounded string allows, still throw.
+     */
+    template<typename T>
+    inline bool tryPutFrom(T val) {
+        return this->tryPutFrom((const void*)&val, (ScalarType)ScalarTypeID<T>::value);
+    }
+
+    //! Convert and assign.  false if the value can not be converted.
+    virtual bool tryPutFrom(const void *, ScalarType) = 0;
+
     inline void putFrom(const AnyScalar& v) {
         if(v)
             putFrom(v.unsafe(), v.type());
@@ -426,6 +506,20 @@ public:
         put(castUnsafe<T,T1>(val));
     }
 
+    template<typename T1>
+    inline bool tryGetAs(T1& out) const {
+        return tryCastUnsafe<T1,T>(out, get());
+    }
+
+    template<typename T1>
+    inline bool tryPutFrom(typename detail::ScalarStorageOps<T1>::arg_type val) {
+        T result;
+        if(!tryCastUnsafe<T,T1>(result, val))
+            return false;
+        put(result);
+        return true;
+    }
+
     inline void putFrom(const AnyScalar& v) {
         // the template form of putFrom() hides the base class AnyScalar overload
         PVScalar::putFrom(v);
@@ -439,6 +533,7 @@ public:
         SerializableControl *pflusher) const OVERRIDE;
     virtual void deserialize(ByteBuffer *pbuffer,
         DeserializableControl *pflusher) OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
 
 protected:
     explicit PVScalarValue(ScalarConstPtr const & scalar)
@@ -448,6 +543,11 @@ protected:
         const T src = get();
         castUnsafeV(1, rtype, result, typeCode, (const void*)&src);
     }
+    virtual bool tryGetAs(void * result, ScalarType rtype) const OVERRIDE FINAL
+    {
+        const T src = get();
+        return tryCastUnsafeV(1, rtype, result, typeCode, (const void*)&src);
+    }
 public:
     virtual void getAs(AnyScalar& v) const OVERRIDE FINAL
     {
@@ -459,9 +559,18 @@ public:
         castUnsafeV(1, typeCode, (void*)&result, stype, src);
         put(result);
     }
+    virtual bool tryPutFrom(const void *src, ScalarType stype) OVERRIDE FINAL
+    {
+        T result;
+        if(!tryCastUnsafeV(1, typeCode, (void*)&result, stype, src))
+            return false;
+        put(result);
+        return true;
+    }
 protected:
 
     friend class PVDataCreate;
+    friend class PVStructure;
     storage_t storage;
     EPICS_NOT_COPYABLE(PVScalarValue)
 };
@@ -688,6 +797,12 @@ public:
         assign(from);
     }
 
+    /**
+     * Assign the given PVScalarArray's value without the immutable check.
+     *
+     * When both already reference the same elements of the same buffer
+     * the value is not changed, but postPut() is still called.
+     */
     void copyUnchecked(const PVScalarArray& from) {
         if (this==&from)
             return;
@@ -852,6 +967,15 @@ public:
      */
     virtual void deserialize(ByteBuffer *pbuffer,
         DeserializableControl*pflusher,BitSet *pbitSet) OVERRIDE FINAL;
+
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
+    /**
+     * Get the number of bytes which serialize(pbuffer, pflusher, pbitSet) will write.
+     * Only fields of variable size (strings, non-fixed arrays, unions) are visited.
+     * @param bitSet A bitset the specifies which fields to serialize.
+     * @return The serialized size in bytes.
+     */
+    std::size_t getSerializedSize(const BitSet& bitSet) const;
     /**
      * Constructor
      * @param structure The introspection interface.
@@ -871,6 +995,33 @@ public:
     void copyUnchecked(const PVStructure& from);
     void copyUnchecked(const PVStructure& from, const BitSet& maskBitSet, bool inverse = false);
 
+    /**
+     * Take an immutable snapshot of the current values of this structure,
+     * sharing unchanged sub-fields with a previous snapshot.
+     *
+     * Only changed fields are copied, along with the sub-structures enclosing them.
+     * Every other sub-field of the new snapshot is the same PVField as in previous.
+     * So the cost follows the size of the changes, not the size of the structure.
+     @code
+       PVStructure::const_shared_pointer prev(pv->snapshot(BitSet(), PVStructure::const_shared_pointer()));
+       pv->getSubFieldT<PVDouble>("value")->put(1.0);
+       PVStructure::const_shared_pointer next(pv->snapshot(changed, prev)); // next->getSubField("alarm")==prev->getSubField("alarm")
+     @endcode
+     *
+     * As a sub-field may belong to several snapshots, sub-fields of a snapshot have no parent.
+     * getParent() returns NULL, and getFullName() is the same as getFieldName().
+     * Sub-fields are never modified once a snapshot is returned,
+     * so snapshots may be read by other threads while later snapshots are taken or released.
+     * Elements of structure and union arrays are shared with this structure, as with copy().
+     *
+     * @param changed Offsets, relative to this structure, of the fields changed since previous was taken.
+     *        Bit 0 to copy all fields.
+     * @param previous An earlier snapshot of this structure.  If NULL, all fields are copied.
+     * @return The new snapshot, which is a top level structure.
+     * @throws std::invalid_argument if previous is not of the same type.
+     */
+    const_shared_pointer snapshot(const BitSet& changed, const const_shared_pointer& previous) const;
+
     struct Formatter {
         enum mode_t {
             Auto,
@@ -906,12 +1057,56 @@ public:
 
         FORCE_INLINE Formatter& format(format_t f) { xfmt = f; return *this; }
 
+        /** Append Raw format output to a caller owned buffer.
+         *
+         * The text is the same as from format(Raw) and a std::ostream with default options,
+         * without the per-value iostream overhead.  Mode Auto is treated as Plain.
+         * Re-using one buffer (eg. clear() between calls) avoids re-allocation.
+         */
+        epicsShareFunc void appendRaw(std::string& out) const;
+
         friend epicsShareFunc std::ostream& operator<<(std::ostream& strm, const Formatter& format);
         friend void printRaw(std::ostream& strm, const PVStructure::Formatter& format, const PVStructure& cur);
     };
 
     FORCE_INLINE Formatter stream() const { return Formatter(*this); }
 
+    /**
+     * Set the handler which receives the changes made during each PostBatch of this structure.
+     * At most one handler can be set.
+     * @param handler The handler.
+     */
+    void setPostBatchHandler(PostBatchHandlerPtr const &handler);
+
+    /**
+     * @brief Defers postPut() of a PVStructure and its sub-fields until the end of a scope.
+     *
+     @code
+       {
+           PVStructure::PostBatch batch(*pvs);
+           pvValue->put(1.0);
+           pvSeverity->put(2);
+           pvValue->put(2.0);
+       } // PostBatchHandler::postPut() called once.  The PostHandler of pvValue called once.
+     @endcode
+     *
+     * While a batch is open, postPut() of a field records its offset instead of calling its PostHandler.
+     * When the outermost PostBatch of the structure ends, its PostBatchHandler is called once with these offsets.
+     * Then, unless a PostBatch is also open on an enclosing structure,
+     * the PostHandler of each changed field is called once.
+     * Otherwise these are called when the enclosing batch ends.
+     *
+     * Must be used by the thread which writes to the structure.
+     * Exceptions thrown by handlers when the batch ends are printed and ignored.
+     */
+    class epicsShareClass PostBatch {
+        EPICS_NOT_COPYABLE(PostBatch)
+        PVStructure& pvs;
+    public:
+        explicit PostBatch(PVStructure& pvs);
+        ~PostBatch();
+    };
+
 private:
 
     inline PVFieldPtr getSubFieldImpl(const std::string& name, bool throws) const {
@@ -919,6 +1114,19 @@ private:
     }
     PVFieldPtr getSubFieldImpl(const char *name, bool throws) const;
     PVFieldPtr getSubFieldImpl(std::size_t fieldOffset, bool throws) const;
+    std::size_t getVariableSerializedSize() const;
+    void serializePacked(ByteBuffer *pbuffer) const;
+    void deserializePacked(ByteBuffer *pbuffer);
+    // PostBatch
+    void beginBatch();
+    void endBatch();
+    // snapshot()
+    struct Snapshot {};
+    // takes pvFields without setting the parent or name of any sub-field
+    PVStructure(StructureConstPtr const & structure, PVFieldPtrArray& pvFields, Snapshot);
+    static PVStructurePtr snapshotOf(const PVStructure& current, const PVStructure& previous,
+                                     const BitSet& changed, uint32 base);
+    static void detach(PVField& dest, const PVField& src, uint32 base);
 
     PVFieldPtrArray pvFields;
     StructureConstPtr structurePtr;
@@ -1064,6 +1272,7 @@ public:
      */
     virtual void deserialize(
         ByteBuffer *pbuffer,DeserializableControl *pflusher) OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
     /**
      * Constructor
      * @param punion The introspection interface.
@@ -1084,6 +1293,12 @@ private:
         int32 selector;
         PVFieldPtr value;
         bool variant;  
+        // values replaced by deserialize() or copyUnchecked(), for reuse
+        // when the type changes back.  Most recent last.
+        // Up to 4 scalar values, or structures of scalars, are kept in addition to value.
+        // Arrays are not kept, so their storage is free'd when replaced.
+        PVFieldPtrArray recent;
+        void prepareValue(FieldConstPtr const & field);
     EPICS_NOT_COPYABLE(PVUnion)
 };
 
@@ -1215,6 +1430,7 @@ public:
     virtual void deserialize(ByteBuffer *pbuffer,DeserializableControl *pflusher) OVERRIDE FINAL;
     virtual void serialize(ByteBuffer *pbuffer,
                            SerializableControl *pflusher, size_t offset, size_t count) const OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
 
 protected:
     virtual void _getAsVoid(epics::pvData::shared_vector<const void>& out) const OVERRIDE FINAL;
@@ -1308,6 +1524,7 @@ public:
         DeserializableControl *pflusher) OVERRIDE FINAL;
     virtual void serialize(ByteBuffer *pbuffer,
         SerializableControl *pflusher, std::size_t offset, std::size_t count) const OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
 
     virtual std::ostream& dumpValue(std::ostream& o) const OVERRIDE FINAL;
     virtual std::ostream& dumpValue(std::ostream& o, std::size_t index) const OVERRIDE FINAL;
@@ -1407,6 +1624,7 @@ public:
         DeserializableControl *pflusher) OVERRIDE FINAL;
     virtual void serialize(ByteBuffer *pbuffer,
         SerializableControl *pflusher, std::size_t offset, std::size_t count) const OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
 
     virtual std::ostream& dumpValue(std::ostream& o) const OVERRIDE FINAL;
     virtual std::ostream& dumpValue(std::ostream& o, std::size_t index) const OVERRIDE FINAL;
@@ -1632,6 +1850,23 @@ public:
      * @return The variant PVUnionArray implementation. 
      */
     PVUnionArrayPtr createPVVariantUnionArray();
+
+    /**
+     * Set the allocation policy for the storage of arrays of numeric and boolean elements.
+     * This applies to the values of all PVValueArray, and to other shared_vector of these types,
+     * allocated afterwards.  Arrays which already exist keep their storage.
+     * Equivalent to ArrayAllocator::install().
+     @code
+       getPVDataCreate()->setArrayAllocator(ArrayAllocator::shared_pointer(new AlignedAllocator(64u)));
+     @endcode
+     * @param alloc The allocator.  NULL restores the default (new[]).
+     */
+    void setArrayAllocator(ArrayAllocator::shared_pointer const & alloc);
+    /**
+     * The allocation policy set by setArrayAllocator().
+     * @return The current allocator, or NULL for the default.
+     */
+    ArrayAllocator::shared_pointer getArrayAllocator() const;
     
 private:
    PVDataCreate();
@@ -1654,6 +1889,42 @@ bool epicsShareExtern operator==(const PVField&, const PVField&);
 static inline bool operator!=(const PVField& a, const PVField& b)
 {return !(a==b);}
 
+/**
+ * Compare two PVStructures with the same Structure, field by field.
+ *
+ * For each leaf field (not a structure) of a which differs from the
+ * corresponding field of b, the bit for its field offset is set in changed.
+ * Other bits are not cleared.
+ *
+ * Fixed width scalars and scalar arrays are compared by bit pattern.
+ * So a NaN is equal to the same NaN, and 0.0 differs from -0.0.
+ * Arrays which reference the same data are equal without comparing elements.
+ *
+ * @param a One structure
+ * @param b Another structure
+ * @param changed Set bits for fields which differ
+ * @returns true if any field differs
+ * @throws std::invalid_argument if a and b have different Structures
+ * @version Added after 8.0.5
+ */
+epicsShareExtern bool diff(const PVStructure& a, const PVStructure& b, BitSet& changed);
+
+/**
+ * As diff(), and also copy each differing leaf field from current into snapshot,
+ * as with PVField::copyUnchecked().  This makes snapshot equal to current in one pass.
+ *
+ * Arrays are copied by reference.  Elements of structure and union arrays
+ * are shared with current afterwards.
+ *
+ * @param snapshot The previous value, updated in place
+ * @param current The new value
+ * @param changed Set bits for fields which differed
+ * @returns true if any field differed
+ * @throws std::invalid_argument if snapshot and current have different Structures
+ * @version Added after 8.0.5
+ */
+epicsShareExtern bool diffUpdate(PVStructure& snapshot, const PVStructure& current, BitSet& changed);
+
 }}
 
 /**
@@ -320,6 +320,66 @@ namespace ScalarTypeFunc {
 
 epicsShareExtern std::ostream& operator<<(std::ostream& o, const ScalarType& scalarType);
 
+/**
+ * @brief Process wide registry of small integer tags for type IDs.
+ *
+ * Code which dispatches on the type ID of a structure can switch on Field::getTypeTag()
+ * instead of comparing strings.
+ * Well known IDs have fixed tags.  Other IDs may be given a tag with add().
+ *
+ * IDs with a version are matched by major version,
+ * so "epics:nt/NTTable:1.0" and "epics:nt/NTTable:1.1" both have the tag NTTable.
+ *
+ @code
+   switch(pvStructure->getStructure()->getTypeTag()) {
+   case TypeTag::Alarm: ...
+   case TypeTag::NTTable: ...
+   }
+ @endcode
+ */
+struct epicsShareClass TypeTag {
+    enum tag_t {
+        Unknown = 0,
+        Alarm,       //!< alarm_t
+        TimeStamp,   //!< time_t
+        Display,     //!< display_t
+        Control,     //!< control_t
+        Enumerated,  //!< enum_t
+        ValueAlarm,  //!< valueAlarm_t
+        NTScalar,    //!< epics:nt/NTScalar:1
+        NTScalarArray,
+        NTEnum,
+        NTMatrix,
+        NTNameValue,
+        NTTable,
+        NTURI,
+        NTNDArray,
+        NTAttribute,
+        NTMultiChannel,
+        NTScalarMultiChannel,
+        NTHistogram,
+        NTAggregate,
+        NTContinuum,
+        NTUnion,
+        NTStructureArray,
+        NTUnionArray,
+        FirstUser    //!< First tag given by add()
+    };
+    /**
+     * Find or allocate the tag for an ID.
+     * @param id Type ID
+     * @return The tag.
+     * @throws std::length_error when too many IDs are registered.
+     */
+    static int32 add(const std::string& id);
+    /**
+     * Find the tag for an ID.
+     * @param id Type ID
+     * @return The tag, or Unknown if id is not registered.
+     */
+    static int32 lookup(const std::string& id);
+};
+
 
 /**
  * @brief This class implements introspection object for field.
@@ -340,9 +400,18 @@ public:
    Type getType() const{return m_fieldType;}
    /**
     * Get the identification string.
+    * The string is created with the Field, and lives as long as it does.
     * @return The identification string, can be empty.
     */
-   virtual std::string getID() const = 0;
+   virtual const std::string& getID() const = 0;
+   /**
+    * Get the integer tag registered for getID().
+    * Comparing tags is cheaper than comparing ID strings.
+    * @return A TypeTag::tag_t, a tag from TypeTag::add(), or TypeTag::Unknown.
+    */
+   int32 getTypeTag() const {
+       return m_tag!=TypeTag::Unknown ? m_tag : lateTypeTag();
+   }
    
     /**
      * Puts the string representation to the stream.
@@ -351,6 +420,13 @@ public:
      */
     virtual std::ostream& dump(std::ostream& o) const = 0;
 
+    /**
+     * Get the number of bytes which serialize() will write,
+     * when the SerializableControl does not cache introspection data.
+     * @return The serialized size in bytes.
+     */
+    virtual std::size_t getSerializedSize() const = 0;
+
    //! Allocate a new instance
    //! @version Added after 7.0.0
     std::tr1::shared_ptr<PVField> build() const;
@@ -367,11 +443,17 @@ protected:
 private:
    const Type m_fieldType;
    unsigned int m_hash;
+   // tag found when the Field was created
+   int32 m_tag;
+   // (TypeTag generation << 16) | tag, when m_tag is Unknown
+   mutable size_t m_lateTag;
+   int32 lateTypeTag() const;
    struct Helper;
    friend struct Helper;
 
    friend class StructureArray;
    friend class Structure;
+   friend class Union;
    friend class PVFieldPvt;
    friend class StandardField;
    friend class BasePVStructureArray;
@@ -398,11 +480,12 @@ public:
      */
     ScalarType getScalarType() const {return scalarType;}
     
-    virtual std::string getID() const OVERRIDE;
+    virtual const std::string& getID() const OVERRIDE;
 
     virtual std::ostream& dump(std::ostream& o) const OVERRIDE FINAL;
 
     virtual void serialize(ByteBuffer *buffer, SerializableControl *control) const OVERRIDE;
+    virtual std::size_t getSerializedSize() const OVERRIDE;
     virtual void deserialize(ByteBuffer *buffer, DeserializableControl *control) OVERRIDE FINAL;
 
     //! Allocate a new instance
@@ -433,9 +516,10 @@ public:
     typedef BoundedString& reference;
     typedef const BoundedString& const_reference;
 
-    virtual std::string getID() const OVERRIDE FINAL;
+    virtual const std::string& getID() const OVERRIDE FINAL;
 
     virtual void serialize(ByteBuffer *buffer, SerializableControl *control) const OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
 
     std::size_t getMaximumLength() const;
 
@@ -443,6 +527,7 @@ protected:
     BoundedString(std::size_t maxStringLength);
 private:
     std::size_t maxLength;
+    std::string id;
     friend class FieldCreate;
     EPICS_NOT_COPYABLE(BoundedString)
 };
@@ -507,11 +592,12 @@ public:
 
     virtual std::size_t getMaximumCapacity() const OVERRIDE {return 0;}
 
-    virtual std::string getID() const OVERRIDE;
+    virtual const std::string& getID() const OVERRIDE;
 
     virtual std::ostream& dump(std::ostream& o) const OVERRIDE FINAL;
 
     virtual void serialize(ByteBuffer *buffer, SerializableControl *control) const OVERRIDE;
+    virtual std::size_t getSerializedSize() const OVERRIDE;
     virtual void deserialize(ByteBuffer *buffer, DeserializableControl *control) OVERRIDE FINAL;
 
     //! Allocate a new instance
@@ -520,7 +606,7 @@ public:
     
     virtual ~ScalarArray();
 private:
-    const std::string getIDScalarArrayLUT() const;
+    const std::string& getIDScalarArrayLUT() const;
     ScalarType elementType;
     friend class FieldCreate;
     EPICS_NOT_COPYABLE(ScalarArray)
@@ -549,13 +635,15 @@ public:
 
     virtual std::size_t getMaximumCapacity() const OVERRIDE FINAL {return size;}
 
-    virtual std::string getID() const OVERRIDE FINAL;
+    virtual const std::string& getID() const OVERRIDE FINAL;
 
     virtual void serialize(ByteBuffer *buffer, SerializableControl *control) const OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
 
     virtual ~BoundedScalarArray();
 private:
     std::size_t size;
+    std::string id;
     friend class FieldCreate;
     EPICS_NOT_COPYABLE(BoundedScalarArray)
 };
@@ -581,13 +669,15 @@ public:
 
     virtual std::size_t getMaximumCapacity() const OVERRIDE FINAL {return size;}
 
-    virtual std::string getID() const OVERRIDE FINAL;
+    virtual const std::string& getID() const OVERRIDE FINAL;
 
     virtual void serialize(ByteBuffer *buffer, SerializableControl *control) const OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
 
     virtual ~FixedScalarArray();
 private:
     std::size_t size;
+    std::string id;
     friend class FieldCreate;
     EPICS_NOT_COPYABLE(FixedScalarArray)
 };
@@ -612,11 +702,12 @@ public:
 
     virtual std::size_t getMaximumCapacity() const OVERRIDE FINAL {return 0;}
 
-    virtual std::string getID() const OVERRIDE FINAL;
+    virtual const std::string& getID() const OVERRIDE FINAL;
 
     virtual std::ostream& dump(std::ostream& o) const OVERRIDE FINAL;
 
     virtual void serialize(ByteBuffer *buffer, SerializableControl *control) const OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
     virtual void deserialize(ByteBuffer *buffer, DeserializableControl *control) OVERRIDE FINAL;
 
     //! Allocate a new instance
@@ -633,6 +724,7 @@ public:
     virtual ~StructureArray();
 private:
     StructureConstPtr pstructure;
+    std::string id;
     friend class FieldCreate;
     EPICS_NOT_COPYABLE(StructureArray)
 };
@@ -657,11 +749,12 @@ public:
 
     virtual std::size_t getMaximumCapacity() const OVERRIDE FINAL {return 0;}
 
-    virtual std::string getID() const OVERRIDE FINAL;
+    virtual const std::string& getID() const OVERRIDE FINAL;
 
     virtual std::ostream& dump(std::ostream& o) const OVERRIDE FINAL;
 
     virtual void serialize(ByteBuffer *buffer, SerializableControl *control) const OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
     virtual void deserialize(ByteBuffer *buffer, DeserializableControl *control) OVERRIDE FINAL;
 
     //! Allocate a new instance
@@ -678,6 +771,7 @@ public:
     virtual ~UnionArray();
 private:
     UnionConstPtr punion;
+    std::string id;
     friend class FieldCreate;
     EPICS_NOT_COPYABLE(UnionArray)
 };
@@ -825,11 +919,66 @@ public:
      */
     const std::string& getFieldName(std::size_t fieldIndex) const {return fieldNames.at(fieldIndex);}
 
-    virtual std::string getID() const OVERRIDE FINAL;
+    /**
+     * @brief Description of one field in getLayout()
+     */
+    struct LayoutEntry {
+        //! Offset after this field and all of its sub-fields
+        uint32 nextOffset;
+        //! Offset of the enclosing structure.  0 for the Structure itself.
+        uint32 parentOffset;
+        //! Index of this field in the enclosing Structure::getFields().  0 for the Structure itself.
+        uint32 memberIndex;
+        //! Type of this field
+        const Field *field;
+        //! Name of this field.  Empty for the Structure itself.
+        const std::string *name;
+    };
+    typedef std::vector<LayoutEntry> Layout;
+
+    /**
+     * A flat table of this Structure and all of its sub-fields.
+     * The table is indexed by field offset, as PVField::getFieldOffset()
+     * of the fields of a top level PVStructure of this type.
+     * So [0] describes this Structure itself.
+     *
+     * Built on first use, and kept until the Structure is destroyed.
+     * Pointers in the table remain valid as long as the Structure does.
+     */
+    const Layout& getLayout() const;
+
+    /**
+     * @brief A list of member names, with the type required of each.
+     *
+     * Used by property helpers like PVTimeStamp to find their fields.
+     * Must have static storage duration, as its address is the key under which
+     * getMemberIndices() caches its result.
+     */
+    struct MemberSet {
+        //! Number of members.  At least one.
+        std::size_t count;
+        //! Name of each member
+        const char * const *names;
+        //! Type of each member
+        const Type *types;
+        //! ScalarType or element type of each member.  Only checked for scalar and scalarArray.
+        const ScalarType *scalarTypes;
+    };
+
+    /**
+     * Find the members described by a MemberSet.
+     * The lookup is done once for each MemberSet, and the result kept until the Structure is destroyed.
+     * @return Indices into getFields() in the order of MemberSet::names,
+     *         or NULL if any member is missing or has a different type.
+     */
+    const uint32* getMemberIndices(const MemberSet& members) const;
+
+    virtual const std::string& getID() const OVERRIDE FINAL;
 
     virtual std::ostream& dump(std::ostream& o) const OVERRIDE FINAL;
 
     virtual void serialize(ByteBuffer *buffer, SerializableControl *control) const OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
     virtual void deserialize(ByteBuffer *buffer, DeserializableControl *control) OVERRIDE FINAL;
 
     //! Allocate a new instance
@@ -842,12 +991,26 @@ private:
     StringArray fieldNames;
     FieldConstPtrArray fields;
     std::string id;
+    // computed once as a Structure is immutable
+    std::size_t serializedSize;
+    // bytes of the serialized value of a PVStructure which do not depend on the value
+    std::size_t fixedValueSize;
+    // indices of fields whose serialized value size must be computed for each value
+    std::vector<std::size_t> variableValueFields;
+    // all leaves are fixed width scalars, so a serialized value is fixedValueSize packed bytes
+    bool packedValue;
+    // Layout*, built on first call to getLayout()
+    mutable void *layout;
+    // MemberIndices*, list of results of getMemberIndices()
+    struct MemberIndices;
+    mutable void *memberIndices;
 
     FieldConstPtr getFieldImpl(const std::string& fieldName, bool throws) const;
     void dumpFields(std::ostream& o) const;
     
     friend class FieldCreate;
     friend class Union;
+    friend class PVStructure;
     EPICS_NOT_COPYABLE(Structure)
 };
 
@@ -1021,11 +1184,12 @@ public:
      */
     int32 guess(Type t, ScalarType s) const;
 
-    virtual std::string getID() const OVERRIDE FINAL;
+    virtual const std::string& getID() const OVERRIDE FINAL;
 
     virtual std::ostream& dump(std::ostream& o) const OVERRIDE FINAL;
 
     virtual void serialize(ByteBuffer *buffer, SerializableControl *control) const OVERRIDE FINAL;
+    virtual std::size_t getSerializedSize() const OVERRIDE FINAL;
     virtual void deserialize(ByteBuffer *buffer, DeserializableControl *control) OVERRIDE FINAL;
 
     //! Allocate a new instance
@@ -1039,6 +1203,7 @@ private:
    StringArray fieldNames;
    FieldConstPtrArray fields;
    std::string id;
+   std::size_t serializedSize;
 
    FieldConstPtr getFieldImpl(const std::string& fieldName, bool throws) const;
    void dumpFields(std::ostream& o) const;
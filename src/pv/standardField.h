@@ -11,8 +11,10 @@
 
 #include <string>
 #include <stdexcept>
+#include <map>
 
 #include <pv/pvIntrospect.h>
+#include <pv/lock.h>
 
 #include <shareLib.h>
 
@@ -211,7 +213,7 @@ public:
 private:
     StandardField();
     StructureConstPtr createProperties(
-        std::string id,FieldConstPtr field,std::string properties);
+        const std::string& id,const FieldConstPtr& field,const std::string& properties);
     const FieldCreatePtr fieldCreate;
     const std::string notImplemented;
     const std::string valueFieldName;
@@ -231,6 +233,16 @@ private:
     const StructureConstPtr floatAlarmField;
     const StructureConstPtr doubleAlarmField;
     const StructureConstPtr enumeratedAlarmField;
+    const StructureConstPtr enumeratedField;
+
+    // createProperties() results keyed by (id, (value Field, property bit mask)).
+    // Held weakly.  A live entry references its value Field, so the raw pointer in the key stays valid.
+    typedef std::pair<std::string, std::pair<const Field*, unsigned> > propKey_t;
+    typedef std::map<propKey_t, std::tr1::weak_ptr<const Structure> > propCache_t;
+    Mutex propLock;
+    propCache_t propCache;
+    // expired entries are removed when the cache grows beyond this size
+    size_t propPrune;
 };
 
 FORCE_INLINE const StandardFieldPtr& getStandardField() {
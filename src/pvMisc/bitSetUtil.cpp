@@ -13,66 +13,61 @@
 
 namespace epics { namespace pvData {
 
-using std::tr1::static_pointer_cast;
 using std::size_t;
 
-static bool checkBitSetPVField(
-    PVFieldPtr const &pvField,BitSetPtr const &bitSet,int32 initialOffset)
+namespace {
+
+// returns true if any bit in the sub-tree at offset is set
+bool compressAt(BitSet& bitSet, const Structure::Layout& layout, uint32 offset)
 {
-    int32 offset = initialOffset;
-    int32 nbits = static_cast<int32>(pvField->getNumberFields());
-    if(nbits==1) return bitSet->get(offset);
-    int32 nextSetBit = bitSet->nextSetBit(offset);
-    if(nextSetBit>=(offset+nbits)) return false;
-    if(nextSetBit<0) return false;
-    if(bitSet->get(offset)) {
-        if(nbits>1) {
-            for(int32 i=offset+1; i<offset+nbits; i++) bitSet->clear(i);
-        }
+    const uint32 end = layout[offset].nextOffset;
+    if(end-offset==1u)
+        return bitSet.get(offset);
+
+    if(bitSet.get(offset)) {
+        // whole sub-tree already selected
+        bitSet.clear(offset+1u, end);
         return true;
     }
 
-    bool atLeastOneBitSet = false;
-    bool allBitsSet = true;
-    PVStructurePtr pvStructure = static_pointer_cast<PVStructure>(pvField);
-    offset = static_cast<int32>(pvStructure->getFieldOffset()) + 1;
-    while(offset<initialOffset + nbits) {
-        PVFieldPtr pvSubField = pvStructure->getSubFieldT(offset);
-        int32 nbitsNow = static_cast<int32>(pvSubField->getNumberFields());
-        if(nbitsNow==1) {
-            if(bitSet->get(offset)) {
-                atLeastOneBitSet = true;
-            } else {
-                allBitsSet = false;
-            }
-            offset++;
-        } else {
-            bool result = checkBitSetPVField(pvSubField,bitSet,offset);
-            if(result) {
-                atLeastOneBitSet = true;
-                if(!bitSet->get(offset)) {
-                    allBitsSet = false;
-                }
+    if(!bitSet.anySet(offset+1u, end))
+        return false;
+
+    // a structure whose members are all leaves (not structures, or empty structures)
+    const bool leafOnly = static_cast<const Structure*>(layout[offset].field)->getNumberFields()==end-offset-1u;
+
+    bool allBitsSet;
+    if(leafOnly) {
+        allBitsSet = bitSet.allSet(offset+1u, end);
+
+    } else {
+        allBitsSet = true;
+        for(uint32 child=offset+1u; child<end; child=layout[child].nextOffset) {
+            if(layout[child].nextOffset-child==1u) {
+                allBitsSet &= bitSet.get(child);
             } else {
-                allBitsSet = false;
+                allBitsSet &= compressAt(bitSet, layout, child) && bitSet.get(child);
             }
-            offset += static_cast<int32>(pvSubField->getNumberFields());
         }
     }
+
     if(allBitsSet) {
-        if(nbits>1) {
-            for(int32 i=initialOffset+1; i<initialOffset+nbits; i++){
-                bitSet->clear(i);
-            }
-        }
-        bitSet->set(initialOffset);
+        bitSet.clear(offset+1u, end);
+        bitSet.set(offset);
     }
-    return atLeastOneBitSet;
+    return true;
+}
+
+} // namespace
+
+bool BitSetUtil::compress(BitSet& bitSet, StructureConstPtr const &type)
+{
+    return compressAt(bitSet, type->getLayout(), 0u);
 }
 
 bool BitSetUtil::compress(BitSetPtr const &bitSet,PVStructurePtr const &pvStructure)
 {
-    return checkBitSetPVField(pvStructure,bitSet,0);
+    return compress(*bitSet, pvStructure->getStructure());
 }
 
 }}
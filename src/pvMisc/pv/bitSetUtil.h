@@ -31,6 +31,16 @@ public:
      *  @param pvStructure the structure.
      */
     static bool compress(BitSetPtr const &bitSet,PVStructurePtr const &pvStructure);
+    /**
+     *  compress a bitSet for any instance of a structure type.
+     *  Bit 0 is the structure itself, and other bits are field offsets
+     *  as given by PVField::getFieldOffset().
+     *  Runs in time linear in the number of fields.
+     *  @param bitSet this must be a valid bitSet for type.
+     *  @param type the structure type.
+     *  @return true if any bit for the structure is set.
+     */
+    static bool compress(BitSet& bitSet, StructureConstPtr const &type);
 };
 
 }}
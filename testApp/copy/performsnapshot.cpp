@@ -0,0 +1,202 @@
+// Attempt to quantify contention between one writer and several readers of a PVStructure.
+// Compares readers and writer sharing one PVStructure under a mutex,
+// with readers taking snapshots from a SharedPVStructure.
+// Also compares the cost of keeping a history of snapshots
+// by full copy, and with PVStructure::snapshot()
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <vector>
+
+#include <testMain.h>
+#include <epicsUnitTest.h>
+#include <epicsThread.h>
+#include <epicsAtomic.h>
+
+#include <pv/pvData.h>
+#include <pv/standardField.h>
+#include <pv/thread.h>
+#include <pv/lock.h>
+#include <pv/sharedPVStructure.h>
+
+namespace {
+
+namespace pvd = epics::pvData;
+
+// duration of each run in seconds
+const double runTime = 1.0;
+
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+struct Base {
+    pvd::StructureConstPtr type;
+    size_t stop;
+    size_t writes;
+    size_t reads;
+
+    Base()
+        :type(pvd::getStandardField()->scalar(pvd::pvDouble, "alarm,timeStamp,display,control"))
+        ,stop(0u), writes(0u), reads(0u)
+    {}
+    virtual ~Base() {}
+
+    virtual void write() =0;
+    virtual void read() =0;
+
+    void run(const char *name, unsigned nreaders) {
+        std::vector<pvd::Thread*> threads;
+        for(unsigned i=0; i<nreaders; i++) {
+            threads.push_back(new pvd::Thread(pvd::Thread::Config(this, &Base::read)
+                                              .name("reader")
+                                              .autostart(true)));
+        }
+        threads.push_back(new pvd::Thread(pvd::Thread::Config(this, &Base::write)
+                                          .name("writer")
+                                          .autostart(true)));
+        epicsThreadSleep(runTime);
+        epics::atomic::set(stop, size_t(1u));
+        for(size_t i=0; i<threads.size(); i++) {
+            threads[i]->exitWait();
+            delete threads[i];
+        }
+        printf("# %-8s %2u readers  writer %10.0f updates/s  readers %10.0f reads/s\n",
+               name, nreaders, writes/runTime, reads/runTime);
+    }
+};
+
+// update the value and timeStamp, as a record would
+void update(pvd::PVStructure& pv, pvd::int32 i)
+{
+    pv.getSubFieldT<pvd::PVDouble>("value")->put(i);
+    pv.getSubFieldT<pvd::PVLong>("timeStamp.secondsPastEpoch")->put(i);
+    pv.getSubFieldT<pvd::PVInt>("timeStamp.nanoseconds")->put(i);
+}
+
+// what a reader looks at
+double sample(const pvd::PVStructure& pv)
+{
+    return pv.getSubFieldT<pvd::PVDouble>("value")->get()
+            + pv.getSubFieldT<pvd::PVInt>("timeStamp.nanoseconds")->get()
+            + pv.getSubFieldT<pvd::PVDouble>("display.limitHigh")->get();
+}
+
+struct Locked : public Base {
+    pvd::Mutex lock;
+    pvd::PVStructurePtr value;
+
+    Locked() :value(pvd::getPVDataCreate()->createPVStructure(type)) {}
+    virtual ~Locked() {}
+
+    virtual void write() {
+        size_t n = 0u;
+        for(pvd::int32 i=0; !epics::atomic::get(stop); i++, n++) {
+            pvd::Lock G(lock);
+            update(*value, i);
+        }
+        epics::atomic::add(writes, n);
+    }
+    virtual void read() {
+        size_t n = 0u;
+        double sum = 0.0;
+        for(; !epics::atomic::get(stop); n++) {
+            pvd::Lock G(lock);
+            sum += sample(*value);
+        }
+        epics::atomic::add(reads, n);
+        if(sum<0.0) printf("# %f\n", sum);
+    }
+};
+
+struct Snapshot : public Base {
+    pvd::SharedPVStructure shared;
+
+    Snapshot() :shared(type) {}
+    virtual ~Snapshot() {}
+
+    virtual void write() {
+        const pvd::PVStructurePtr& W(shared.getWritable());
+        pvd::BitSet changed;
+        changed.set(W->getSubFieldT("value")->getFieldOffset());
+        changed.set(W->getSubFieldT("timeStamp")->getFieldOffset());
+        size_t n = 0u;
+        for(pvd::int32 i=0; !epics::atomic::get(stop); i++, n++) {
+            update(*W, i);
+            shared.publish(changed);
+        }
+        epics::atomic::add(writes, n);
+    }
+    virtual void read() {
+        size_t n = 0u;
+        double sum = 0.0;
+        for(; !epics::atomic::get(stop); n++) {
+            pvd::SharedPVStructure::const_pointer snap(shared.snapshot());
+            sum += sample(*snap);
+        }
+        epics::atomic::add(reads, n);
+        if(sum<0.0) printf("# %f\n", sum);
+    }
+};
+
+// keep the last nhistory snapshots of a large structure, where one field changes each time
+void history(const char *name, bool full)
+{
+    const size_t nsub = 100u, nleaf = 10u, nhistory = 64u, nupdate = 10000u;
+
+    pvd::FieldBuilderPtr builder(pvd::getFieldCreate()->createFieldBuilder());
+    for(size_t i=0; i<nsub; i++) {
+        char sub[16];
+        sprintf(sub, "s%zu", i);
+        builder = builder->addNestedStructure(sub);
+        for(size_t j=0; j<nleaf; j++) {
+            char leaf[16];
+            sprintf(leaf, "v%zu", j);
+            builder = builder->add(leaf, pvd::pvDouble);
+        }
+        builder = builder->endNested();
+    }
+    pvd::PVStructurePtr current(pvd::getPVDataCreate()->createPVStructure(builder->createStructure()));
+    pvd::PVDoublePtr value(current->getSubFieldT<pvd::PVDouble>("s50.v5"));
+
+    std::vector<pvd::PVStructure::const_shared_pointer> ring(nhistory);
+    pvd::PVStructure::const_shared_pointer prev(current->snapshot(pvd::BitSet(), pvd::PVStructure::const_shared_pointer()));
+    pvd::BitSet changed;
+    changed.set(full ? 0u : value->getFieldOffset());
+
+    const double start = now();
+    for(size_t i=0; i<nupdate; i++) {
+        value->put(double(i));
+        prev = current->snapshot(changed, prev);
+        ring[i%nhistory] = prev;
+    }
+    const double elapsed = now() - start;
+
+    printf("# %-10s %zu fields  %8.3f us/snapshot\n", name, current->getNumberFields(), elapsed/nupdate*1e6);
+}
+
+} // namespace
+
+MAIN(performSnapshot) {
+    testPlan(0);
+    testDiag("%u CPUs", epicsThreadGetCPUs());
+
+    for(unsigned nreaders=1u; nreaders<=8u; nreaders*=2u) {
+        {
+            Locked L;
+            L.run("mutex", nreaders);
+        }
+        {
+            Snapshot S;
+            S.run("snapshot", nreaders);
+        }
+    }
+
+    history("full copy", true);
+    history("shared", false);
+    return testDone();
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+#include <epicsThread.h>
+#include <epicsAtomic.h>
+
+#include <pv/pvUnitTest.h>
+#include <pv/pvData.h>
+#include <pv/thread.h>
+#include <pv/sharedPVStructure.h>
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+pvd::StructureConstPtr makeType()
+{
+    return pvd::getFieldCreate()->createFieldBuilder()
+            ->add("x", pvd::pvInt)
+            ->add("y", pvd::pvInt)
+            ->addNestedStructure("sub")
+                ->add("z", pvd::pvInt)
+            ->endNested()
+            ->createStructure();
+}
+
+pvd::int32 get(const pvd::PVStructure& pv, const char *name)
+{
+    return pv.getSubFieldT<pvd::PVInt>(name)->get();
+}
+
+void testPublish()
+{
+    testDiag("testPublish");
+
+    pvd::SharedPVStructure shared(makeType());
+    const pvd::PVStructurePtr& W(shared.getWritable());
+    pvd::PVIntPtr x(W->getSubFieldT<pvd::PVInt>("x")),
+                  y(W->getSubFieldT<pvd::PVInt>("y")),
+                  z(W->getSubFieldT<pvd::PVInt>("sub.z"));
+
+    pvd::SharedPVStructure::const_pointer snap0(shared.snapshot());
+    testOk1(!!snap0 && snap0.get()!=W.get());
+    testOk1(snap0==shared.snapshot());
+    testEqual(get(*snap0, "x"), 0);
+
+    // changed, but not yet published
+    x->put(1);
+    testEqual(get(*shared.snapshot(), "x"), 0);
+
+    pvd::BitSet changed;
+    shared.publish(changed.set(x->getFieldOffset()));
+    pvd::SharedPVStructure::const_pointer snap1(shared.snapshot());
+    testEqual(get(*snap1, "x"), 1);
+    testEqual(get(*snap0, "x"), 0); // unchanged while referenced
+
+    // the buffers of snap0 and snap1 are in use
+    y->put(2);
+    changed.clear();
+    shared.publish(changed.set(y->getFieldOffset()));
+    testEqual(shared.getStats().buffers, 3u);
+
+    snap0.reset();
+    snap1.reset();
+    testEqual(shared.getStats().free, 2u);
+
+    // a recycled buffer gets all changes published since it was last used
+    z->put(3);
+    changed.clear();
+    shared.publish(changed.set(z->getFieldOffset()));
+    pvd::SharedPVStructure::const_pointer snap2(shared.snapshot());
+    testEqual(get(*snap2, "x"), 1);
+    testEqual(get(*snap2, "y"), 2);
+    testEqual(get(*snap2, "sub.z"), 3);
+    testEqual(shared.getStats().buffers, 3u);
+    testEqual(shared.getStats().published, 4u);
+
+    // snapshots may outlive the SharedPVStructure
+}
+
+void testArrays()
+{
+    testDiag("testArrays");
+
+    pvd::StructureConstPtr elem(pvd::getFieldCreate()->createFieldBuilder()
+                                ->add("v", pvd::pvInt)
+                                ->createStructure());
+    pvd::SharedPVStructure shared(pvd::getFieldCreate()->createFieldBuilder()
+                                  ->addArray("sarr", elem)
+                                  ->add("any", pvd::getFieldCreate()->createVariantUnion())
+                                  ->createStructure());
+    const pvd::PVStructurePtr& W(shared.getWritable());
+    pvd::PVStructureArrayPtr sarr(W->getSubFieldT<pvd::PVStructureArray>("sarr"));
+    pvd::PVUnionPtr any(W->getSubFieldT<pvd::PVUnion>("any"));
+
+    pvd::PVStructureArray::svector elems(1u);
+    elems[0] = pvd::getPVDataCreate()->createPVStructure(elem);
+    pvd::PVIntPtr v(elems[0]->getSubFieldT<pvd::PVInt>("v"));
+    v->put(1);
+    sarr->replace(pvd::freeze(elems));
+    pvd::PVIntPtr anyValue(pvd::getPVDataCreate()->createPVScalar<pvd::PVInt>());
+    anyValue->put(1);
+    any->set(anyValue);
+
+    pvd::BitSet changed;
+    changed.set(sarr->getFieldOffset());
+    changed.set(any->getFieldOffset());
+    shared.publish(changed);
+
+    pvd::SharedPVStructure::const_pointer snap(shared.snapshot());
+
+    // modify in place, without publishing
+    v->put(2);
+    anyValue->put(2);
+
+    pvd::PVStructureArray::const_svector selems(snap->getSubFieldT<pvd::PVStructureArray>("sarr")->view());
+    testEqual(selems.size(), 1u);
+    testEqual(selems[0]->getSubFieldT<pvd::PVInt>("v")->get(), 1);
+    testEqual(snap->getSubFieldT<pvd::PVUnion>("any")->get<pvd::PVInt>()->get(), 1);
+}
+
+struct Concurrent {
+    pvd::SharedPVStructure shared;
+    pvd::PVIntPtr x, y, z;
+    size_t done;
+    size_t torn;
+    size_t reads;
+
+    Concurrent()
+        :shared(makeType())
+        ,x(shared.getWritable()->getSubFieldT<pvd::PVInt>("x"))
+        ,y(shared.getWritable()->getSubFieldT<pvd::PVInt>("y"))
+        ,z(shared.getWritable()->getSubFieldT<pvd::PVInt>("sub.z"))
+        ,done(0u), torn(0u), reads(0u)
+    {}
+
+    void write() {
+        pvd::BitSet changed;
+        changed.set(0);
+        for(pvd::int32 i=1; i<=20000; i++) {
+            x->put(i);
+            y->put(i);
+            z->put(i);
+            shared.publish(changed);
+        }
+        epics::atomic::set(done, size_t(1u));
+    }
+
+    void read() {
+        size_t n = 0u;
+        pvd::int32 prev = 0;
+        while(!epics::atomic::get(done)) {
+            pvd::SharedPVStructure::const_pointer snap(shared.snapshot());
+            pvd::int32 a = get(*snap, "x"), b = get(*snap, "y"), c = get(*snap, "sub.z");
+            if(a!=b || b!=c || a<prev)
+                epics::atomic::increment(torn);
+            prev = a;
+            n++;
+        }
+        epics::atomic::add(reads, n);
+    }
+};
+
+void testConcurrent()
+{
+    testDiag("testConcurrent");
+
+    Concurrent C;
+    std::vector<pvd::Thread*> readers;
+    for(size_t i=0; i<3u; i++) {
+        readers.push_back(new pvd::Thread(pvd::Thread::Config(&C, &Concurrent::read)
+                                          .name("reader")
+                                          .autostart(true)));
+    }
+    pvd::Thread writer(pvd::Thread::Config(&C, &Concurrent::write)
+                       .name("writer")
+                       .autostart(true));
+    writer.exitWait();
+    for(size_t i=0; i<readers.size(); i++) {
+        readers[i]->exitWait();
+        delete readers[i];
+    }
+
+    testOk(C.torn==0u, "%zu inconsistent snapshots of %zu", C.torn, C.reads);
+    testEqual(get(*C.shared.snapshot(), "x"), 20000);
+    testDiag("%zu buffers", C.shared.getStats().buffers);
+}
+
+} // namespace
+
+MAIN(testSharedPVStructure)
+{
+    testPlan(18);
+    testPublish();
+    testArrays();
+    testConcurrent();
+    return testDone();
+}
@@ -0,0 +1,90 @@
+// Attempt to quantify the cost of reading the current time with each TimeStamp::ClockSource
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+
+#include <testMain.h>
+#include <epicsUnitTest.h>
+#include <epicsTime.h>
+
+#include <pv/timeStamp.h>
+
+namespace {
+
+namespace pvd = epics::pvData;
+
+struct TimeIt {
+    struct timespec m_start;
+    double sum, sum2;
+    size_t count;
+    TimeIt() { reset(); }
+    void reset() {
+        sum = sum2 = 0.0;
+        count = 0;
+    }
+    void start() {
+        clock_gettime(CLOCK_MONOTONIC, &m_start);
+    }
+    void end() {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double diff = (end.tv_sec-m_start.tv_sec) + (end.tv_nsec-m_start.tv_nsec)*1e-9;
+        sum += diff;
+        sum2 += diff*diff;
+        count++;
+    }
+    void report(const char *unit ="s", double mult=1.0) const {
+        double mean = sum/count;
+        double mean2 = sum2/count;
+        double std = sqrt(mean2 - mean*mean);
+        printf("# %zu sample   %f +- %f %s\n", count, mean/mult, std/mult, unit);
+    }
+};
+
+const size_t ncalls = 1000000u;
+
+void timeSource(const char *name, pvd::TimeStamp::ClockSource source)
+{
+    testDiag("TimeStamp::getCurrent() %s", name);
+    pvd::TimeStamp::setClockSource(source);
+    TimeIt record;
+    pvd::TimeStamp ts;
+
+    for(size_t n=0; n<10; n++) {
+        record.start();
+        for(size_t i=0; i<ncalls; i++)
+            ts.getCurrent();
+        record.end();
+    }
+
+    record.report("ns/call", 1e-9*ncalls);
+    pvd::TimeStamp::setClockSource(pvd::TimeStamp::ClockEPICS);
+}
+
+void timeEpicsTime()
+{
+    testDiag("epicsTime::getCurrent()");
+    TimeIt record;
+    epicsTime now;
+
+    for(size_t n=0; n<10; n++) {
+        record.start();
+        for(size_t i=0; i<ncalls; i++)
+            now = epicsTime::getCurrent();
+        record.end();
+    }
+
+    record.report("ns/call", 1e-9*ncalls);
+}
+
+} // namespace
+
+MAIN(performClock) {
+    testPlan(0);
+    timeEpicsTime();
+    timeSource("ClockEPICS", pvd::TimeStamp::ClockEPICS);
+    timeSource("ClockRealtime", pvd::TimeStamp::ClockRealtime);
+    timeSource("ClockRealtimeCoarse", pvd::TimeStamp::ClockRealtimeCoarse);
+    return testDone();
+}
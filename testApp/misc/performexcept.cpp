@@ -0,0 +1,109 @@
+// Attempt to quantify the cost of throwing an exception with and without call stack capture
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+
+#include <stdexcept>
+
+#include <testMain.h>
+#include <epicsUnitTest.h>
+
+#include <pv/epicsException.h>
+
+namespace {
+
+namespace pvd = epics::pvData;
+
+struct TimeIt {
+    struct timespec m_start;
+    double sum, sum2;
+    size_t count;
+    TimeIt() { reset(); }
+    void reset() {
+        sum = sum2 = 0.0;
+        count = 0;
+    }
+    void start() {
+        clock_gettime(CLOCK_MONOTONIC, &m_start);
+    }
+    void end() {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double diff = (end.tv_sec-m_start.tv_sec) + (end.tv_nsec-m_start.tv_nsec)*1e-9;
+        sum += diff;
+        sum2 += diff*diff;
+        count++;
+    }
+    void report(const char *unit ="s", double mult=1.0) const {
+        double mean = sum/count;
+        double mean2 = sum2/count;
+        double std = sqrt(mean2 - mean*mean);
+        printf("# %zu sample   %f +- %f %s\n", count, mean/mult, std/mult, unit);
+    }
+};
+
+// throw from a few frames down, as a real error would be
+template<int N>
+struct Thrower {
+    static void mixed(int i) { Thrower<N-1>::mixed(i+1); }
+    static void plain(int i) { Thrower<N-1>::plain(i+1); }
+};
+
+template<>
+struct Thrower<0> {
+    static void mixed(int i) {
+        if(i>=0)
+            THROW_EXCEPTION2(std::logic_error, "bad input");
+    }
+    static void plain(int i) {
+        if(i>=0)
+            throw std::logic_error("bad input");
+    }
+};
+
+// time for 1000 throw and catch
+template<typename FN>
+void throwCatch(const char *name, FN fn)
+{
+    testDiag("%s", name);
+    TimeIt record;
+
+    for(size_t n=0; n<100; n++) {
+        size_t caught = 0;
+        record.start();
+        for(size_t i=0; i<1000; i++) {
+            try {
+                fn(0);
+            } catch(std::logic_error&) {
+                caught++;
+            }
+        }
+        record.end();
+        if(caught!=1000)
+            testAbort("Missed exceptions");
+    }
+
+    record.report("us per throw", 1e-3);
+}
+
+} // namespace
+
+MAIN(performExcept) {
+    testPlan(0);
+    const unsigned orig = pvd::ExceptionMixin::getStackCapturePeriod();
+
+    throwCatch("plain throw", &Thrower<5>::plain);
+
+    pvd::ExceptionMixin::setStackCapturePeriod(1);
+    throwCatch("THROW_EXCEPTION2 capture every", &Thrower<5>::mixed);
+
+    pvd::ExceptionMixin::setStackCapturePeriod(100);
+    throwCatch("THROW_EXCEPTION2 capture 1 in 100", &Thrower<5>::mixed);
+
+    pvd::ExceptionMixin::setStackCapturePeriod(0);
+    throwCatch("THROW_EXCEPTION2 capture never", &Thrower<5>::mixed);
+
+    pvd::ExceptionMixin::setStackCapturePeriod(orig);
+    return testDone();
+}
@@ -0,0 +1,105 @@
+// Attempt to quantify the scaling of bulk array conversion and copy with the number of worker threads
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+
+#include <vector>
+#include <algorithm>
+
+#include <testMain.h>
+#include <epicsUnitTest.h>
+#include <epicsThread.h>
+
+#include <pv/pvData.h>
+#include <pv/parallel.h>
+
+namespace {
+
+namespace pvd = epics::pvData;
+
+struct TimeIt {
+    struct timespec m_start;
+    double sum, sum2;
+    size_t count;
+    TimeIt() { reset(); }
+    void reset() {
+        sum = sum2 = 0.0;
+        count = 0;
+    }
+    void start() {
+        clock_gettime(CLOCK_MONOTONIC, &m_start);
+    }
+    void end() {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double diff = (end.tv_sec-m_start.tv_sec) + (end.tv_nsec-m_start.tv_nsec)*1e-9;
+        sum += diff;
+        sum2 += diff*diff;
+        count++;
+    }
+    void report(const char *unit ="s", double mult=1.0) const {
+        double mean = sum/count;
+        double mean2 = sum2/count;
+        double std = sqrt(mean2 - mean*mean);
+        printf("# %zu sample   %f +- %f %s\n", count, mean/mult, std/mult, unit);
+    }
+};
+
+// 256MB of double
+const size_t nelems = 32u*1024u*1024u;
+
+void convert(unsigned workers)
+{
+    testDiag("castUnsafeV(int16 -> double) workers=%u", workers);
+    pvd::ParallelPolicy::configure(workers);
+
+    std::vector<pvd::int16> input(nelems, 42);
+    std::vector<double> output(nelems);
+    TimeIt record;
+
+    for(size_t n=0; n<10; n++) {
+        record.start();
+        pvd::castUnsafeV(nelems, pvd::pvDouble, &output[0], pvd::pvShort, &input[0]);
+        record.end();
+    }
+
+    record.report("ms", 1e-3);
+}
+
+void thaw(unsigned workers)
+{
+    testDiag("thaw() of shared double array workers=%u", workers);
+    pvd::ParallelPolicy::configure(workers);
+
+    pvd::shared_vector<double> data(nelems, 42.0);
+    pvd::shared_vector<const double> input(pvd::freeze(data));
+    TimeIt record;
+
+    for(size_t n=0; n<10; n++) {
+        pvd::shared_vector<const double> temp(input);
+        record.start();
+        pvd::shared_vector<double> copy(pvd::thaw(temp));
+        record.end();
+    }
+
+    record.report("ms", 1e-3);
+}
+
+} // namespace
+
+MAIN(performParallel) {
+    testPlan(0);
+    const unsigned ncpu = epicsThreadGetCPUs();
+    // workers in addition to the calling thread, so the last step over-subscribes
+    const unsigned limit = std::min(std::max(ncpu, 4u), 16u);
+    testDiag("%u CPUs", ncpu);
+
+    for(unsigned workers=0; workers<=limit; workers = workers ? workers*2u : 1u)
+        convert(workers);
+    for(unsigned workers=0; workers<=limit; workers = workers ? workers*2u : 1u)
+        thaw(workers);
+
+    pvd::ParallelPolicy::configure(0);
+    return testDone();
+}
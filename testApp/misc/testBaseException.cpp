@@ -11,6 +11,8 @@
 #include <string.h>
 #include <stdio.h>
 
+#include <string>
+
 #include <epicsUnitTest.h>
 #include <testMain.h>
 
@@ -60,11 +62,63 @@ void testLogicException() {
     testPass("testLogicException");
 }
 
+static size_t stackLines(const std::string& msg)
+{
+    size_t lines = 0;
+    for(size_t i=0; i<msg.size(); i++)
+        if(msg[i]=='\n') lines++;
+    return lines-1; // exclude "On line ..."
+}
+
+void testStackCapture() {
+    const unsigned orig = ExceptionMixin::getStackCapturePeriod();
+    testDiag("Stack capture period %u", orig);
+
+    ExceptionMixin::setStackCapturePeriod(0);
+    testOk1(ExceptionMixin::getStackCapturePeriod()==0);
+    try {
+        THROW_EXCEPTION2(std::logic_error, "no stack");
+    } catch (std::logic_error& e) {
+        testOk1(stackLines(SHOW_EXCEPTION(e))==0);
+    }
+
+    ExceptionMixin::setStackCapturePeriod(1);
+    try {
+        THROW_EXCEPTION2(std::logic_error, "with stack");
+    } catch (std::logic_error& e) {
+#if defined(EXCEPT_USE_BACKTRACE)
+        testOk1(stackLines(SHOW_EXCEPTION(e))>0);
+#else
+        testSkip(1, "No stack capture on this target");
+#endif
+    }
+
+    // one in every four
+    ExceptionMixin::setStackCapturePeriod(4);
+    size_t captured = 0;
+    for(size_t i=0; i<8; i++) {
+        try {
+            THROW_EXCEPTION2(std::logic_error, "sampled");
+        } catch (std::logic_error& e) {
+            if(stackLines(SHOW_EXCEPTION(e))>0)
+                captured++;
+        }
+    }
+#if defined(EXCEPT_USE_BACKTRACE)
+    testOk(captured==2, "captured %u of 8", unsigned(captured));
+#else
+    testSkip(1, "No stack capture on this target");
+#endif
+
+    ExceptionMixin::setStackCapturePeriod(orig);
+}
+
 MAIN(testBaseException)
 {
-    testPlan(2);
+    testPlan(6);
     testDiag("Tests base exception");
     testLogicException();
     testBaseExceptionTest();
+    testStackCapture();
     return testDone();
 }
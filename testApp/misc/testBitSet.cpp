@@ -303,15 +303,62 @@ static void testSerialize()
 #undef TOFRO
 }
 
+static void testRange()
+{
+    testDiag("testRange()");
+
+    static const uint32 edges[] = {0, 1, 5, 63, 64, 65, 127, 128, 130, 190, 191, 192, 250};
+
+    // pattern with a full word, a partial word, and a sparse word
+    BitSet pattern;
+    for(uint32 i=0; i<64; i++)
+        pattern.set(i);
+    for(uint32 i=64; i<128; i+=3)
+        pattern.set(i);
+    pattern.set(130).set(191);
+
+    unsigned badAny = 0, badAll = 0, badClear = 0;
+    for(size_t f=0; f<NELEMENTS(edges); f++) {
+        for(size_t t=0; t<NELEMENTS(edges); t++) {
+            const uint32 from = edges[f], to = edges[t];
+
+            bool any = false, all = true;
+            BitSet expect(pattern);
+            for(uint32 i=from; i<to; i++) {
+                any |= pattern.get(i);
+                all &= pattern.get(i);
+                expect.clear(i);
+            }
+
+            if(pattern.anySet(from, to)!=any) badAny++;
+            if(pattern.allSet(from, to)!=all) badAll++;
+
+            BitSet actual(pattern);
+            actual.clear(from, to);
+            if(actual!=expect) badClear++;
+        }
+    }
+    testEqual(badAny, 0u);
+    testEqual(badAll, 0u);
+    testEqual(badClear, 0u);
+
+    // clearing the highest word shrinks
+    BitSet shrink(pattern);
+    shrink.clear(128, 1000);
+    testEqual(shrink.size(), 128u);
+    testOk1(BitSet().allSet(5, 5) && !BitSet().allSet(5, 6) && !BitSet().anySet(0, 1000));
+}
+
 } // namespace
 
 MAIN(testBitSet)
 {
-    testPlan(90);
+    testPlan(95);
     testInitialize();
     testGetSetClearFlip();
     testOperators();
     testLogical();
     testSerialize();
+    testRange();
     return testDone();
 }
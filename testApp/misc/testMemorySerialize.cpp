@@ -0,0 +1,164 @@
+/* testMemorySerialize.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <vector>
+
+#include <epicsEndian.h>
+
+#include <pv/pvData.h>
+#include <pv/serialize.h>
+#include <pv/standardField.h>
+#include <pv/memorySerialize.h>
+#include <pv/pvUnitTest.h>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+pvd::StructureConstPtr waveformType()
+{
+    // repeats alarm_t and time_t so that the introspection cache has something to do
+    return pvd::getFieldCreate()->createFieldBuilder()
+            ->addArray("value", pvd::pvDouble)
+            ->add("alarm", pvd::getStandardField()->alarm())
+            ->add("timeStamp", pvd::getStandardField()->timeStamp())
+            ->addNestedStructure("raw")
+                ->addArray("value", pvd::pvShort)
+                ->add("alarm", pvd::getStandardField()->alarm())
+                ->add("timeStamp", pvd::getStandardField()->timeStamp())
+            ->endNested()
+            ->add("name", pvd::pvString)
+            ->createStructure();
+}
+
+pvd::PVStructurePtr buildWaveform(size_t count)
+{
+    pvd::PVStructurePtr ret(pvd::getPVDataCreate()->createPVStructure(waveformType()));
+
+    pvd::shared_vector<double> value(count);
+    pvd::shared_vector<pvd::int16> raw(count);
+    for(size_t i=0; i<count; i++) {
+        value[i] = i*0.25;
+        raw[i] = pvd::int16(i);
+    }
+    ret->getSubFieldT<pvd::PVDoubleArray>("value")->replace(pvd::freeze(value));
+    ret->getSubFieldT<pvd::PVShortArray>("raw.value")->replace(pvd::freeze(raw));
+    ret->getSubFieldT<pvd::PVInt>("alarm.severity")->put(2);
+    ret->getSubFieldT<pvd::PVLong>("timeStamp.secondsPastEpoch")->put(0x12345678);
+    ret->getSubFieldT<pvd::PVString>("name")->put("waveform");
+    return ret;
+}
+
+void testSame(int byteOrder, size_t count, size_t stageSize, size_t directThreshold)
+{
+    testDiag("testSame byteOrder=%d count=%u stage=%u direct=%u", byteOrder,
+             unsigned(count), unsigned(stageSize), unsigned(directThreshold));
+
+    pvd::PVStructurePtr orig(buildWaveform(count));
+
+    std::vector<epicsUInt8> expect, actual;
+    pvd::serializeToVector(orig.get(), byteOrder, expect);
+
+    pvd::MemorySerializer S(byteOrder, stageSize, directThreshold);
+    S.serialize(*orig);
+    testEqual(S.getSize(), expect.size());
+    S.copyTo(actual);
+    testOk1(expect==actual);
+
+    pvd::PVStructurePtr copy(pvd::getPVDataCreate()->createPVStructure(waveformType()));
+    pvd::MemoryDeserializer D((const char*)&actual[0], actual.size(), byteOrder);
+    D.deserialize(*copy);
+    testEqual(D.getRemaining(), 0u);
+    testEqual(*orig, *copy);
+}
+
+void testDirect()
+{
+    testDiag("testDirect");
+
+    pvd::PVStructurePtr orig(buildWaveform(4096));
+    pvd::PVDoubleArray::const_svector value(orig->getSubFieldT<pvd::PVDoubleArray>("value")->view());
+
+    pvd::MemorySerializer S(EPICS_BYTE_ORDER);
+    S.serialize(*orig);
+
+    const pvd::MemorySerializer::segments_t& segs(S.getSegments());
+    // [size of value], [value data], [alarm, ..., size of raw.value], [raw.value data], [...]
+    testEqual(segs.size(), 5u);
+    testOk1(segs.size()>1 && segs[1].data==(const char*)value.data());
+    testEqual(segs[1].size, 4096u*sizeof(double));
+
+    size_t total = 0u;
+    for(size_t i=0; i<segs.size(); i++)
+        total += segs[i].size;
+    testEqual(total, S.getSize());
+
+    S.clear();
+    testEqual(S.getSize(), 0u);
+    testEqual(S.getSegments().size(), 0u);
+
+    testThrows(std::logic_error, S.ensureBuffer(1024*1024));
+    testThrows(std::invalid_argument, pvd::MemorySerializer(EPICS_BYTE_ORDER, 8));
+}
+
+void testCache()
+{
+    testDiag("testCache");
+
+    pvd::PVStructurePtr orig(buildWaveform(10));
+
+    std::vector<epicsUInt8> plain, cached, cached2;
+    pvd::serializeToVector(orig->getStructure().get(), EPICS_BYTE_ORDER, plain);
+
+    pvd::MemorySerializer S(EPICS_BYTE_ORDER, 16*1024, 4*1024, true);
+    S.serialize(*orig->getStructure());
+    S.copyTo(cached);
+    S.clear();
+    // second time only the id is sent
+    S.serialize(*orig->getStructure());
+    S.copyTo(cached2);
+
+    testOk(cached.size()<plain.size(), "repeated types are sent once %u < %u",
+           unsigned(cached.size()), unsigned(plain.size()));
+    testOk(cached2.size()<cached.size(), "known types are sent by id %u < %u",
+           unsigned(cached2.size()), unsigned(cached.size()));
+
+    pvd::MemoryDeserializer D((const char*)&cached[0], cached.size(), EPICS_BYTE_ORDER, true);
+    pvd::FieldConstPtr type(pvd::getFieldCreate()->deserialize(D.getBuffer(), &D));
+    testEqual(D.getRemaining(), 0u);
+    testOk1(!!type && *type==*orig->getStructure());
+
+    D.reset((const char*)&cached2[0], cached2.size());
+    type = pvd::getFieldCreate()->deserialize(D.getBuffer(), &D);
+    testEqual(D.getRemaining(), 0u);
+    testOk1(!!type && *type==*orig->getStructure());
+
+    // the ids are unknown to a new deserializer
+    pvd::MemoryDeserializer D2((const char*)&cached2[0], cached2.size(), EPICS_BYTE_ORDER, true);
+    testThrows(std::runtime_error, pvd::getFieldCreate()->deserialize(D2.getBuffer(), &D2));
+
+    // truncated
+    pvd::MemoryDeserializer D3((const char*)&cached[0], cached.size()/2, EPICS_BYTE_ORDER, true);
+    testThrows(std::logic_error, pvd::getFieldCreate()->deserialize(D3.getBuffer(), &D3));
+}
+
+} // namespace
+
+MAIN(testMemorySerialize)
+{
+    testPlan(36);
+    testSame(EPICS_ENDIAN_LITTLE, 10, 16*1024, 4*1024);
+    testSame(EPICS_ENDIAN_BIG, 10, 16*1024, 4*1024);
+    testSame(EPICS_ENDIAN_LITTLE, 10000, 16*1024, 4*1024);
+    testSame(EPICS_ENDIAN_BIG, 10000, 16*1024, 4*1024);
+    testSame(EPICS_BYTE_ORDER, 10000, 64, 0);
+    testDirect();
+    testCache();
+    return testDone();
+}
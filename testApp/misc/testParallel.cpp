@@ -0,0 +1,131 @@
+/* testParallel.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <vector>
+
+#include <string.h>
+
+#include <epicsAtomic.h>
+
+#include <pv/pvData.h>
+#include <pv/parallel.h>
+#include <pv/pvSubArrayCopy.h>
+#include <pv/pvUnitTest.h>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+// sizes which are not a multiple of the chunk size
+const size_t nelems = 100003;
+
+pvd::shared_vector<const pvd::int16> makeInput()
+{
+    pvd::shared_vector<pvd::int16> ret(nelems);
+    for(size_t i=0; i<nelems; i++)
+        ret[i] = pvd::int16(i*7u);
+    return pvd::freeze(ret);
+}
+
+void countChunk(void *raw, size_t first, size_t last)
+{
+    epics::atomic::add(*static_cast<size_t*>(raw), last-first);
+}
+
+void testConfigure()
+{
+    testDiag("testConfigure");
+
+    testEqual(pvd::ParallelPolicy::workers(), 0u);
+    testThrows(std::invalid_argument, pvd::ParallelPolicy::configure(2, 1024u, 0u));
+
+    pvd::ParallelPolicy::configure(2, 1024u, 4096u);
+    testEqual(pvd::ParallelPolicy::workers(), 2u);
+    testEqual(pvd::ParallelPolicy::threshold(), 1024u);
+
+    size_t total = 0u;
+    testOk1(pvd::detail::parallelFor(nelems, 4u, &countChunk, &total));
+    testEqual(total, nelems);
+
+    // below threshold
+    pvd::int32 dummy = 0;
+    testOk1(!pvd::detail::parallelFor(10u, 4u, 0, &dummy));
+
+    pvd::ParallelPolicy::configure(0);
+    testEqual(pvd::ParallelPolicy::workers(), 0u);
+    testOk1(!pvd::detail::parallelFor(nelems, 4u, 0, &dummy));
+}
+
+void testCast(unsigned workers)
+{
+    testDiag("testCast workers=%u", workers);
+    pvd::ParallelPolicy::configure(workers, 1024u, 4096u);
+
+    pvd::shared_vector<const pvd::int16> input(makeInput());
+
+    std::vector<double> expect(nelems), actual(nelems, -1.0);
+    for(size_t i=0; i<nelems; i++)
+        expect[i] = input[i];
+
+    pvd::castUnsafeV(nelems, pvd::pvDouble, &actual[0], pvd::pvShort, input.data());
+    testOk1(expect==actual);
+
+    std::vector<pvd::int16> back(nelems);
+    size_t n = 0;
+    testOk1(pvd::tryCastUnsafeV(nelems, pvd::pvShort, &back[0], pvd::pvDouble, &actual[0], &n));
+    testEqual(n, nelems);
+    testOk1(memcmp(&back[0], input.data(), nelems*sizeof(pvd::int16))==0);
+
+    // not split up
+    testThrows(std::runtime_error, pvd::castUnsafeV(nelems, pvd::pvBoolean, &back[0], pvd::pvShort, input.data()));
+
+    pvd::ParallelPolicy::configure(0);
+}
+
+void testCopy(unsigned workers)
+{
+    testDiag("testCopy workers=%u", workers);
+    pvd::ParallelPolicy::configure(workers, 1024u, 4096u);
+
+    pvd::shared_vector<const pvd::int16> input(makeInput());
+    pvd::shared_vector<const pvd::int16> keep(input);
+
+    // input is shared, so thaw() copies
+    pvd::shared_vector<pvd::int16> copy(pvd::thaw(input));
+    testOk1(copy.data()!=keep.data());
+    testEqual(copy.size(), nelems);
+    testOk1(memcmp(copy.data(), keep.data(), nelems*sizeof(pvd::int16))==0);
+
+    pvd::PVDataCreatePtr create(pvd::getPVDataCreate());
+    pvd::PVShortArrayPtr from(create->createPVScalarArray<pvd::PVShortArray>());
+    pvd::PVShortArrayPtr to(create->createPVScalarArray<pvd::PVShortArray>());
+    from->replace(keep);
+
+    pvd::copy(static_cast<pvd::PVScalarArray&>(*from), 1u, 1u,
+              static_cast<pvd::PVScalarArray&>(*to), 2u, 1u, nelems-1u);
+    pvd::PVShortArray::const_svector result(to->view());
+    testEqual(result.size(), nelems+1u);
+    testOk1(result.size()==nelems+1u && result[0]==0 && result[1]==0
+            && memcmp(result.data()+2, keep.data()+1, (nelems-1u)*sizeof(pvd::int16))==0);
+
+    pvd::ParallelPolicy::configure(0);
+}
+
+} // namespace
+
+MAIN(testParallel)
+{
+    testPlan(29);
+    testConfigure();
+    testCast(0);
+    testCast(3);
+    testCopy(0);
+    testCopy(3);
+    return testDone();
+}
@@ -23,6 +23,8 @@
 #include <pv/serialize.h>
 #include <pv/noDefaultMethods.h>
 #include <pv/byteBuffer.h>
+#include <pv/bitSet.h>
+#include <pv/memorySerialize.h>
 #include <pv/convert.h>
 #include <pv/pvUnitTest.h>
 #include <pv/current_function.h>
@@ -115,6 +117,8 @@ void serializationTest(PVFieldPtr const & field) {
     // serialize
     field->serialize(buffer, flusher);
 
+    testEqual(field->getSerializedSize(), buffer->getPosition());
+
     buffer->flip();
 
     // create new instance and deserialize
@@ -630,6 +634,8 @@ void serializationFieldTest(FieldConstPtr const & field)
     // serialize
     field->serialize(buffer, flusher);
 
+    testEqual(field->getSerializedSize(), buffer->getPosition());
+
     // deserialize
     buffer->flip();
 
@@ -849,11 +855,152 @@ void testFromString(int byteOrder)
     testOk1(_data->getSubFieldT<PVString>("Y")->get()=="testing");
 }
 
+void testSerializedSize()
+{
+    testDiag("Testing serialized size...");
+
+    StructureConstPtr type(getFieldCreate()->createFieldBuilder()
+                           ->setId("test_t")
+                           ->add("value", pvDouble)
+                           ->add("alarm", getStandardField()->alarm())
+                           ->add("timeStamp", getStandardField()->timeStamp())
+                           ->addFixedArray("fixed", pvInt, 4)
+                           ->addArray("array", pvShort)
+                           ->addNestedStructure("inner")
+                               ->add("x", pvInt)
+                               ->add("label", pvString)
+                           ->endNested()
+                           ->add("any", getFieldCreate()->createVariantUnion())
+                           ->createStructure());
+
+    // fixed part of alarm_t and time_t only
+    testEqual(getStandardField()->alarm()->build()->getSerializedSize(), 8u+1u);
+
+    PVStructurePtr value(type->build());
+    {
+        PVIntArray::svector fixed(4, 0);
+        value->getSubFieldT<PVIntArray>("fixed")->replace(freeze(fixed));
+    }
+
+    std::vector<epicsUInt8> bytes;
+    serializeToVector(value.get(), EPICS_BYTE_ORDER, bytes);
+    testEqual(value->getSerializedSize(), bytes.size());
+
+    value->getSubFieldT<PVString>("alarm.message")->put(string(300, 'x'));
+    value->getSubFieldT<PVString>("inner.label")->put("hello");
+    {
+        PVShortArray::svector arr(1000, 1);
+        value->getSubFieldT<PVShortArray>("array")->replace(freeze(arr));
+    }
+    value->getSubFieldT<PVUnion>("any")->set(getStandardField()->timeStamp()->build());
+
+    bytes.clear();
+    serializeToVector(value.get(), EPICS_BYTE_ORDER, bytes);
+    testEqual(value->getSerializedSize(), bytes.size());
+
+    BitSet changed;
+    changed.set(value->getSubFieldT("alarm.message")->getFieldOffset());
+    changed.set(value->getSubFieldT("inner")->getFieldOffset());
+    changed.set(value->getSubFieldT("timeStamp.nanoseconds")->getFieldOffset());
+    changed.set(value->getSubFieldT("any")->getFieldOffset());
+
+    buffer->clear();
+    value->serialize(buffer, flusher, &changed);
+    testEqual(value->getSerializedSize(changed), buffer->getPosition());
+
+    buffer->clear();
+    changed.serialize(buffer, flusher);
+    testEqual(changed.getSerializedSize(), buffer->getPosition());
+
+    changed.clear();
+    testEqual(value->getSerializedSize(changed), 0u);
+    changed.set(0);
+    testEqual(value->getSerializedSize(changed), value->getSerializedSize());
+
+    buffer->clear();
+    changed.serialize(buffer, flusher);
+    testEqual(changed.getSerializedSize(), buffer->getPosition());
+
+    bytes.clear();
+    serializeToVector(type.get(), EPICS_BYTE_ORDER, bytes);
+    testEqual(type->getSerializedSize(), bytes.size());
+
+    PVStructureArrayPtr sarr(getPVDataCreate()->createPVStructureArray(type));
+    {
+        PVStructureArray::svector elems(3);
+        elems[0] = value;
+        elems[2] = type->build();
+        PVIntArray::svector fixed(4, 1);
+        elems[2]->getSubFieldT<PVIntArray>("fixed")->replace(freeze(fixed));
+        sarr->replace(freeze(elems));
+    }
+    bytes.clear();
+    serializeToVector(sarr.get(), EPICS_BYTE_ORDER, bytes);
+    testEqual(sarr->getSerializedSize(), bytes.size());
+}
+
+// serialize leaf fields one at a time
+void serializeLeaves(const PVStructure& pvs, int byteOrder, std::vector<epicsUInt8>& out)
+{
+    const PVFieldPtrArray& fields = pvs.getPVFields();
+    for(size_t i=0; i<fields.size(); i++) {
+        if(fields[i]->getField()->getType()==structure)
+            serializeLeaves(static_cast<const PVStructure&>(*fields[i]), byteOrder, out);
+        else
+            serializeToVector(fields[i].get(), byteOrder, out);
+    }
+}
+
+void testPackedStructure(size_t nextra, int byteOrder)
+{
+    testDiag("Testing packed structure extra=%u byteOrder=%d", unsigned(nextra), byteOrder);
+
+    FieldBuilderPtr builder(getFieldCreate()->createFieldBuilder()
+                            ->add("alarm", getStandardField()->alarm())
+                            ->add("timeStamp", getStandardField()->timeStamp())
+                            ->addNestedStructure("all"));
+    for (int i = pvBoolean; i < pvString; i++)
+        builder = builder->add(ScalarTypeFunc::name(ScalarType(i)), ScalarType(i));
+    builder = builder->endNested();
+    for (size_t i = 0; i < nextra; i++) {
+        std::ostringstream name;
+        name<<"extra"<<i;
+        builder = builder->add(name.str(), pvDouble);
+    }
+    PVStructurePtr value(builder->createStructure()->build());
+
+    const PVFieldPtrArray& all = value->getSubFieldT<PVStructure>("all")->getPVFields();
+    static_cast<PVBoolean&>(*all[0]).put(true);
+    for(size_t i=1; i<all.size(); i++)
+        static_cast<PVScalar&>(*all[i]).putFrom<int32>(0x11+i);
+    value->getSubFieldT<PVInt>("alarm.severity")->put(2);
+    value->getSubFieldT<PVLong>("timeStamp.secondsPastEpoch")->put(0x0102030405060708ll);
+    if(nextra)
+        value->getSubFieldT<PVDouble>("extra0")->put(1.5);
+
+    std::vector<epicsUInt8> expect, actual;
+    serializeLeaves(*value, byteOrder, expect);
+    serializeToVector(value.get(), byteOrder, actual);
+    testOk1(expect==actual);
+    testEqual(value->getSerializedSize(), actual.size());
+
+    // a small buffer which can't hold the whole value
+    MemorySerializer S(byteOrder, 64, 0);
+    S.serialize(*value);
+    actual.clear();
+    S.copyTo(actual);
+    testOk1(expect==actual);
+
+    PVStructurePtr copy(value->getStructure()->build());
+    deserializeFromVector(copy.get(), byteOrder, expect);
+    testEqual(*value, *copy);
+}
+
 } // end namespace
 
 MAIN(testSerialization) {
 
-    testPlan(234);
+    testPlan(401);
 
     flusher = new SerializableControlImpl();
     control = new DeserializableControlImpl();
@@ -875,6 +1022,12 @@ MAIN(testSerialization) {
     testArraySizeType();
     testBoundedString();
 
+    testSerializedSize();
+    testPackedStructure(0, EPICS_ENDIAN_LITTLE);
+    testPackedStructure(0, EPICS_ENDIAN_BIG);
+    testPackedStructure(40, EPICS_ENDIAN_LITTLE);
+    testPackedStructure(40, EPICS_ENDIAN_BIG);
+
     testToString(EPICS_ENDIAN_BIG);
     testToString(EPICS_ENDIAN_LITTLE);
     testFromString(EPICS_ENDIAN_BIG);
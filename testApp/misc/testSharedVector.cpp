@@ -265,6 +265,11 @@ void testSlice()
     testOk1(original.data() == half1.data());
     testOk1(half2.data() == half2a.data());
 
+    testOk1(half2.same(half2a));
+    testOk1(!half1.same(original));
+    testOk1(!half1.same(half2));
+    testOk1(!half1.same(pvd::shared_vector<pvd::int32>(5, 100)));
+
     half1.slice(100000);
     half2.slice(1);
     half2a.slice(1,1);
@@ -694,11 +699,84 @@ void testCXX11Init()
 #endif
 }
 
+void testAllocator()
+{
+    testDiag("Test ArrayAllocator and ArrayPool");
+
+    pvd::ArrayPool::shared_pointer pool(new pvd::ArrayPool(1024u, 1024u*1024u, 2u));
+    pvd::ArrayAllocator::install(pool);
+    testOk1(pvd::ArrayAllocator::current()==pool);
+
+    // count*sizeof(double) would overflow
+    testThrows(std::bad_alloc, pvd::shared_vector<double>(size_t(-1)/4u));
+
+    {
+        // 8000 bytes in the 8192 byte class
+        pvd::shared_vector<double> A(1000u, 1.0);
+        testOk1(A.size()==1000u && A[0]==1.0 && A[999]==1.0);
+    }
+    {
+        // re-uses A's buffer
+        pvd::shared_vector<double> B(900u, 2.0);
+        B.resize(2000u);
+        testOk1(B.size()==2000u && B[0]==2.0 && B[899]==2.0);
+    }
+
+    // not from the pool
+    pvd::shared_vector<std::string> S(1000u);
+    pvd::shared_vector<pvd::int8> small(10u);
+
+    pvd::shared_vector<double> C(1000u, 3.0), D(C);
+    D.make_unique();
+    testOk1(D.data()!=C.data() && D[999]==3.0);
+
+    pvd::ArrayPool::Stats stats(pool->getStats());
+    testEqual(stats.hits, 2u);
+    testEqual(stats.misses, 3u);
+    testEqual(stats.bypass, 1u);
+    testEqual(stats.cached, 1u);
+    testEqual(stats.cachedBytes, 16384u);
+
+    // buffers keep the pool alive
+    small.clear();
+    pvd::ArrayAllocator::install(pvd::ArrayAllocator::shared_pointer());
+    testOk1(!pvd::ArrayAllocator::current());
+    testEqual(pool.use_count(), 3);
+    C.clear();
+    D.clear();
+    testEqual(pool.use_count(), 1);
+
+    pvd::shared_vector<double> F(1000u);
+    stats = pool->getStats();
+    testEqual(stats.hits, 2u);
+    testEqual(stats.cached, 3u);
+
+    pool->resetStats();
+    pool->drain();
+    stats = pool->getStats();
+    testOk1(stats.hits==0u && stats.misses==0u && stats.cached==0u && stats.cachedBytes==0u);
+
+    testThrows(std::invalid_argument, pvd::ArrayPool(1024u, 512u));
+
+    // buffers from an upstream allocator, page aligned and never mmap()'d
+    pvd::AlignedAllocator::shared_pointer aligned(new pvd::AlignedAllocator(4096u, 0u));
+    pvd::ArrayPool::shared_pointer apool(new pvd::ArrayPool(1024u, 1024u*1024u, 2u, aligned));
+    pvd::ArrayAllocator::install(apool);
+    {
+        pvd::shared_vector<double> G(1000u, 4.0), H(10u, 5.0);
+        testOk1((reinterpret_cast<size_t>(G.data())&4095u)==0u && G[999]==4.0);
+        testOk1((reinterpret_cast<size_t>(H.data())&4095u)==0u && H[9]==5.0);
+    }
+    pvd::ArrayAllocator::install(pvd::ArrayAllocator::shared_pointer());
+    testEqual(apool->getStats().cached, 1u);
+    apool->drain();
+}
+
 } // namespace
 
 MAIN(testSharedVector)
 {
-    testPlan(192);
+    testPlan(216);
     testDiag("Tests for shared_vector");
 
     testDiag("sizeof(shared_vector<pvd::int32>)=%lu",
@@ -722,5 +800,6 @@ MAIN(testSharedVector)
     testAutoSwap();
     testCXX11Move();
     testCXX11Init();
+    testAllocator();
     return testDone();
 }
@@ -123,10 +123,36 @@ void testTimeStampInternal()
     testOk1(diff==-1.0);
 }
 
+void testClockSource()
+{
+    testDiag("testClockSource");
+    testOk1(TimeStamp::getClockSource()==TimeStamp::ClockEPICS);
+
+    static const TimeStamp::ClockSource sources[] = {
+        TimeStamp::ClockRealtime,
+        TimeStamp::ClockRealtimeCoarse,
+        TimeStamp::ClockEPICS,
+    };
+    for(size_t i=0; i<sizeof(sources)/sizeof(sources[0]); i++) {
+        TimeStamp before, now, after;
+        before.getCurrent();
+        TimeStamp::setClockSource(sources[i]);
+        testOk1(TimeStamp::getClockSource()==sources[i]);
+        now.getCurrent();
+        TimeStamp::setClockSource(TimeStamp::ClockEPICS);
+        after.getCurrent();
+        // all sources follow the same (realtime) clock.  Allow for a coarse tick.
+        testOk(TimeStamp::diff(now, before) > -0.1 && TimeStamp::diff(after, now) > -0.1,
+               "source %d before=%f now=%f after=%f", int(sources[i]),
+               before.toSeconds(), now.toSeconds(), after.toSeconds());
+    }
+}
+
 MAIN(testTimeStamp)
 {
-    testPlan(37);
+    testPlan(44);
     testDiag("Tests timeStamp");
     testTimeStampInternal();
+    testClockSource();
     return testDone();
 }
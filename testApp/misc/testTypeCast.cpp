@@ -14,8 +14,11 @@
 #include <stddef.h>
 #include <string.h>
 #include <stdio.h>
+#include <errno.h>
 #include <float.h>
 #include <epicsMath.h>
+#include <epicsConvert.h>
+#include <epicsTime.h>
 
 #include <epicsUnitTest.h>
 #include <testMain.h>
@@ -63,6 +66,14 @@ namespace {
                 testFail("%s", msg.str().c_str());
                 return;
             }
+            TO tried;
+            if(!::epics::pvData::tryCastUnsafe<TO,FROM>(tried, inp) || !testequal<TO>::op(tried, expect)) {
+                msg<<"Failed tryCastUnsafe "
+                   <<print(inp)<<" ("<<typeid(FROM).name()<<") -> "
+                   <<print(expect)<<" ("<<typeid(TO).name()<<")";
+                testFail("%s", msg.str().c_str());
+                return;
+            }
             if(!testequal<TO>::op(actual, expect)) {
                 msg<<"Failed cast gives unexpected value "
                    <<print(inp)<<" ("<<typeid(FROM).name()<<") -> "
@@ -86,6 +97,13 @@ namespace {
         {
             std::ostringstream msg;
             TO actual;
+            if(::epics::pvData::tryCastUnsafe<TO,FROM>(actual, inp)) {
+                msg<<"tryCastUnsafe did not fail "
+                   <<print(inp)<<" ("<<typeid(FROM).name()<<") -> ("
+                   <<typeid(TO).name()<<")";
+                testFail("%s", msg.str().c_str());
+                return;
+            }
             try {
                 actual = ::epics::pvData::castUnsafe<TO,FROM>(inp);
                 msg<<"Failed to generate expected error "
@@ -105,6 +123,229 @@ namespace {
         }
     };
 
+    // compare castUnsafeV() with element-wise castUnsafe().
+    // odd length to exercise any remainder after vectorized blocks.
+    template<typename TO, typename FROM>
+    void testKernel(const char *name)
+    {
+        const size_t N = 1003;
+        std::vector<FROM> inp(N);
+        std::vector<TO> actual(N), expect(N);
+        for(size_t i=0; i<N; i++) {
+            inp[i] = FROM(int(epicsUInt32(i*2654435761u)>>17));
+            if(i%2)
+                inp[i] = -inp[i];
+            expect[i] = ::epics::pvData::castUnsafe<TO,FROM>(inp[i]);
+        }
+        ::epics::pvData::castUnsafeV(N, (::epics::pvData::ScalarType)::epics::pvData::ScalarTypeID<TO>::value, &actual[0],
+                                     (::epics::pvData::ScalarType)::epics::pvData::ScalarTypeID<FROM>::value, &inp[0]);
+        testOk(memcmp(&actual[0], &expect[0], N*sizeof(TO))==0, "castUnsafeV %s", name);
+    }
+
+    void testDoubleToFloat()
+    {
+        const double inp[] = {0.0, -0.0, 1.5, -2.25, 1e-300, -1e-300, 1e-40, -1e-40,
+                              FLT_MIN, -FLT_MIN, FLT_MAX, -FLT_MAX, 3.5e38, -3.5e38,
+                              1e300, -1e300, epicsINF, -epicsINF, epicsNAN};
+        const size_t N = sizeof(inp)/sizeof(inp[0]);
+        float actual[N];
+
+        testDiag("Test vcast double -> float clipping");
+        ::epics::pvData::castUnsafeV(N, ::epics::pvData::pvFloat, actual,
+                                     ::epics::pvData::pvDouble, inp);
+
+        bool ok = true;
+        for(size_t i=0; i<N; i++) {
+            float expect = epicsConvertDoubleToFloat(inp[i]);
+            if(memcmp(&actual[i], &expect, sizeof(float))!=0) {
+                testDiag("%g -> %g expected %g", inp[i], actual[i], expect);
+                ok = false;
+            }
+        }
+        testOk(ok, "castUnsafeV(double -> float) matches epicsConvertDoubleToFloat()");
+    }
+
+    // text as std::ostream would print it
+    template<typename T>
+    bool testPrintSame(const std::vector<T>& inp)
+    {
+        const size_t N = inp.size();
+        std::vector<string> actual(N, "previous content");
+        ::epics::pvData::castUnsafeV(N, ::epics::pvData::pvString, &actual[0],
+                                     (::epics::pvData::ScalarType)::epics::pvData::ScalarTypeID<T>::value, &inp[0]);
+        bool ok = true;
+        for(size_t i=0; i<N; i++) {
+            std::ostringstream strm;
+            strm<<print(inp[i]);
+            if(actual[i]!=strm.str() || ::epics::pvData::castUnsafe<string>(inp[i])!=strm.str()) {
+                testDiag("printed \"%s\" expected \"%s\"", actual[i].c_str(), strm.str().c_str());
+                ok = false;
+            }
+        }
+        return ok;
+    }
+
+    void testPrint()
+    {
+        testDiag("Test printing as std::ostream");
+
+        std::vector<int32_t> i32;
+        std::vector<int64_t> i64;
+        std::vector<uint64_t> u64;
+        std::vector<int8_t> i8;
+        std::vector<double> dbl;
+        std::vector<float> flt;
+
+        const int64_t ival[] = {0, 1, -1, 9, 10, -10, 127, -128, 32767, -32768,
+                                2147483647, -2147483647-1, 1234567890123LL,
+                                0x7fffffffffffffffLL, -0x7fffffffffffffffLL-1};
+        for(size_t i=0; i<sizeof(ival)/sizeof(ival[0]); i++) {
+            i32.push_back(int32_t(ival[i]));
+            i64.push_back(ival[i]);
+            u64.push_back(uint64_t(ival[i]));
+            i8.push_back(int8_t(ival[i]));
+        }
+
+        const double dval[] = {0.0, -0.0, 1.0, -1.5, 0.1, 1.0/3.0, 123456.0, 1234567.0, 1e-5, 1e-4,
+                               1e100, -1e-300, 5e-324, DBL_MAX, FLT_MAX, FLT_MIN, 42.000001,
+                               epicsINF, -epicsINF, epicsNAN};
+        for(size_t i=0; i<sizeof(dval)/sizeof(dval[0]); i++) {
+            dbl.push_back(dval[i]);
+            flt.push_back(float(dval[i]));
+        }
+        // arbitrary bit patterns
+        uint64_t x = 0x2545F4914F6CDD1DULL;
+        for(size_t i=0; i<1000; i++) {
+            x ^= x<<13; x ^= x>>7; x ^= x<<17;
+            double d;
+            memcpy(&d, &x, sizeof(d));
+            dbl.push_back(d);
+            i64.push_back(int64_t(x));
+            u64.push_back(x);
+        }
+
+        testOk(testPrintSame(i8), "print int8");
+        testOk(testPrintSame(i32), "print int32");
+        testOk(testPrintSame(i64), "print int64");
+        testOk(testPrintSame(u64), "print uint64");
+        testOk(testPrintSame(flt), "print float");
+        testOk(testPrintSame(dbl), "print double");
+    }
+
+    // compare with strtod()/strtoll() as used by epicsParse*()
+    void testParse()
+    {
+        testDiag("Test parsing as epicsParse*()");
+
+        std::vector<string> inp;
+        const char * const sval[] = {"0", "-0", "+0", "00", "010", "0x10", "-0x10", "1", "-1", "+7",
+                                     " 5", "5 ", "5x", "", "-", "+", ".", "1.", ".5", "-.5", "1e", "1e+",
+                                     "1e5", "1E-5", "1.5e+3", "0.000001", "123456789012345", "1234567890123456",
+                                     "12345678901234567890", "99999999999999999999", "9223372036854775807",
+                                     "-9223372036854775808", "9223372036854775808", "18446744073709551615",
+                                     "2147483647", "-2147483648", "2147483648", "127", "-128", "128",
+                                     "1e22", "1e23", "1e-22", "1e-23", "4.9e-324", "1e400", "0e999",
+                                     "inf", "-nan", "0.1", "0.30000000000000004", "3.4028234663852886e38"};
+        for(size_t i=0; i<sizeof(sval)/sizeof(sval[0]); i++)
+            inp.push_back(sval[i]);
+        uint64_t x = 0x9E3779B97F4A7C15ULL;
+        for(size_t i=0; i<1000; i++) {
+            x ^= x<<13; x ^= x>>7; x ^= x<<17;
+            char buf[40];
+            const double d = double(int64_t(x>>20))*pow(10.0, int(x%40)-20);
+            switch(i%4) {
+            case 0: sprintf(buf, "%.17g", d); break;
+            case 1: sprintf(buf, "%g", d); break;
+            case 2: sprintf(buf, "%.*f", int(x%8), d); break;
+            default: sprintf(buf, "%lld", (long long)(int64_t(x)>>(x%60))); break;
+            }
+            inp.push_back(buf);
+        }
+
+        bool okd = true, okf = true, oki = true, oku = true, ok8 = true;
+        for(size_t i=0; i<inp.size(); i++) {
+            const char *s = inp[i].c_str();
+            char *end;
+
+            errno = 0;
+            double ed = strtod(s, &end);
+            while(*end==' ')
+                end++;
+            bool valid = end!=s && !*end && errno==0;
+            double ad = 42.0;
+            int err = epics::pvData::detail::tryParseToPOD(s, &ad);
+            if(valid ? (err || memcmp(&ad, &ed, sizeof(ed))!=0) : !err) {
+                testDiag("double \"%s\" -> %d %.17g expected %.17g", s, err, ad, ed);
+                okd = false;
+            }
+
+            float ef = float(ed), af = 42.0f;
+            err = epics::pvData::detail::tryParseToPOD(s, &af);
+            if(valid && fabs(ed)>FLT_MIN && fabs(ed)<FLT_MAX && (err || memcmp(&af, &ef, sizeof(ef))!=0)) {
+                testDiag("float \"%s\" -> %d %.9g expected %.9g", s, err, af, ef);
+                okf = false;
+            }
+
+            errno = 0;
+            long long el = strtoll(s, &end, 0);
+            while(*end==' ')
+                end++;
+            valid = end!=s && !*end && errno==0;
+            int64_t al = 42;
+            err = epics::pvData::detail::tryParseToPOD(s, &al);
+            if(valid ? (err || al!=el) : !err) {
+                testDiag("int64 \"%s\" -> %d %lld expected %lld", s, err, (long long)al, el);
+                oki = false;
+            }
+
+            int8_t a8 = 42;
+            err = epics::pvData::detail::tryParseToPOD(s, &a8);
+            valid = valid && el>=-128 && el<=127;
+            if(valid ? (err || a8!=el) : !err) {
+                testDiag("int8 \"%s\" -> %d %d expected %lld", s, err, a8, el);
+                ok8 = false;
+            }
+
+            errno = 0;
+            unsigned long long eu = strtoull(s, &end, 0);
+            while(*end==' ')
+                end++;
+            valid = end!=s && !*end && errno==0;
+            uint64_t au = 42;
+            err = epics::pvData::detail::tryParseToPOD(s, &au);
+            if(valid ? (err || au!=eu) : !err) {
+                testDiag("uint64 \"%s\" -> %d %llu expected %llu", s, err, (unsigned long long)au, eu);
+                oku = false;
+            }
+        }
+        testOk(okd, "parse double");
+        testOk(okf, "parse float");
+        testOk(oki, "parse int64");
+        testOk(ok8, "parse int8");
+        testOk(oku, "parse uint64");
+    }
+
+    // throughput of castUnsafeV() for some commonly requested pairs
+    template<typename TO, typename FROM>
+    void benchKernel(const char *name, size_t N, unsigned reps)
+    {
+        std::vector<double> values(N);
+        for(size_t i=0; i<N; i++)
+            values[i] = std::numeric_limits<TO>::is_integer ? double(i%1000) - 100.0 : (i%1000)*0.37 - 100.0;
+        std::vector<FROM> inp(N);
+        std::vector<TO> out(N);
+        ::epics::pvData::castUnsafeV(N, (::epics::pvData::ScalarType)::epics::pvData::ScalarTypeID<FROM>::value, &inp[0],
+                                     ::epics::pvData::pvDouble, &values[0]);
+
+        epicsTime start(epicsTime::getCurrent());
+        for(unsigned r=0; r<reps; r++)
+            ::epics::pvData::castUnsafeV(N, (::epics::pvData::ScalarType)::epics::pvData::ScalarTypeID<TO>::value, &out[0],
+                                         (::epics::pvData::ScalarType)::epics::pvData::ScalarTypeID<FROM>::value, &inp[0]);
+        double elapsed = epicsTime::getCurrent() - start;
+
+        testDiag("castUnsafeV %-16s %8.1f Melem/s", name,
+                 elapsed>0.0 ? N*double(reps)/elapsed/1e6 : 0.0);
+    }
 
 // Test cast
 #define TEST(TTO, VTO, TFRO, VFRO) testcase<TTO, TFRO>::op(VTO, VFRO)
@@ -119,7 +360,7 @@ namespace {
 
 MAIN(testTypeCast)
 {
-    testPlan(124);
+    testPlan(150);
 
 try {
 
@@ -414,6 +655,19 @@ try {
     FAIL(epics::pvData::boolean, string, "T");
     FAIL(epics::pvData::boolean, string, "F");
 
+    testDiag("NULL C string");
+    {
+        const char *cnull = NULL;
+        string out("x");
+        testOk1(!::epics::pvData::tryCastUnsafe<string>(out, cnull));
+        try {
+            out = ::epics::pvData::castUnsafe<string>(cnull);
+            testFail("castUnsafe of NULL did not throw");
+        } catch(std::runtime_error& e) {
+            testPass("castUnsafe of NULL throws: %s", e.what());
+        }
+    }
+
     testDiag("Floating point overflows");
 
     TEST(float, FLT_MAX, double, 1e300);
@@ -438,6 +692,58 @@ try {
         testOk1(result[2]=="42424242");
     }
 
+    {
+        const string in[4] = { "1", "2", "x", "4" };
+        int32_t result[4] = { 0, 0, -1, -1 };
+        size_t n = 42;
+
+        testDiag("Test tryCastUnsafeV string -> int32 with a bad element");
+        testOk1(!epics::pvData::tryCastUnsafeV(4, epics::pvData::pvInt, (void*)result,
+                                               epics::pvData::pvString, (void*)in, &n));
+        testOk(n==2, "stopped at %u", unsigned(n));
+        testOk1(result[0]==1 && result[1]==2 && result[2]==-1 && result[3]==-1);
+
+        try {
+            epics::pvData::castUnsafeV(4, epics::pvData::pvInt, (void*)result,
+                                       epics::pvData::pvString, (void*)in);
+            testFail("castUnsafeV did not throw");
+        } catch(std::runtime_error& e) {
+            testOk(strstr(e.what(), "index 2")!=NULL, "castUnsafeV throws: %s", e.what());
+        }
+
+        testOk1(epics::pvData::tryCastUnsafeV(2, epics::pvData::pvInt, (void*)result,
+                                              epics::pvData::pvString, (void*)in, &n) && n==2);
+        testOk1(!epics::pvData::tryCastUnsafeV(1, epics::pvData::pvBoolean, (void*)result,
+                                               epics::pvData::pvInt, (void*)result, &n) && n==0);
+    }
+
+    {
+        int32_t val = 5;
+        testOk1(epics::pvData::detail::tryParseToPOD("0x10", &val)==0 && val==16);
+        testOk1(epics::pvData::detail::tryParseToPOD("10 apples", &val)!=0 && val==16);
+    }
+
+    testDiag("Array conversion kernels");
+    testKernel<double, int16_t>("int16 -> double");
+    testKernel<float, uint32_t>("uint32 -> float");
+    testKernel<int8_t, int64_t>("int64 -> int8");
+    testKernel<int32_t, double>("double -> int32");
+    testDoubleToFloat();
+
+    benchKernel<double, int16_t>("int16 -> double", 1u<<16, 100);
+    benchKernel<double, uint16_t>("uint16 -> double", 1u<<16, 100);
+    benchKernel<double, int32_t>("int32 -> double", 1u<<16, 100);
+    benchKernel<float, double>("double -> float", 1u<<16, 100);
+    benchKernel<double, float>("float -> double", 1u<<16, 100);
+    benchKernel<int32_t, double>("double -> int32", 1u<<16, 100);
+    testPrint();
+    testParse();
+
+    benchKernel<string, int32_t>("int32 -> string", 1u<<16, 4);
+    benchKernel<string, double>("double -> string", 1u<<16, 4);
+    benchKernel<int32_t, string>("string -> int32", 1u<<16, 4);
+    benchKernel<double, string>("string -> double", 1u<<16, 4);
+
 } catch(std::exception& e) {
     testAbort("Uncaught exception: %s", e.what());
 }
@@ -4,6 +4,7 @@
  */
 
 #include <sstream>
+#include <iomanip>
 #include <vector>
 
 #include <testMain.h>
@@ -335,6 +336,91 @@ void testRaw()
                      ));
 }
 
+void testAppendRaw()
+{
+    testDiag("%s", CURRENT_FUNCTION);
+
+    pvd::PVStructurePtr input(pvd::getPVDataCreate()->createPVStructure(pvd::getFieldCreate()->createFieldBuilder()
+                                               ->add("b", pvd::pvBoolean)
+                                               ->add("i8", pvd::pvByte)
+                                               ->add("u8", pvd::pvUByte)
+                                               ->add("i16", pvd::pvShort)
+                                               ->add("i64", pvd::pvLong)
+                                               ->add("u64", pvd::pvULong)
+                                               ->add("f", pvd::pvFloat)
+                                               ->add("d", pvd::pvDouble)
+                                               ->add("s", pvd::pvString)
+                                               ->addArray("ai8", pvd::pvByte)
+                                               ->addArray("ad", pvd::pvDouble)
+                                               ->addArray("ab", pvd::pvBoolean)
+                                               ->add("below", everything)
+                                               ->createStructure()));
+
+    input->getSubFieldT<pvd::PVBoolean>("b")->put(true);
+    input->getSubFieldT<pvd::PVByte>("i8")->put(-5);
+    input->getSubFieldT<pvd::PVUByte>("u8")->put(200);
+    input->getSubFieldT<pvd::PVShort>("i16")->put(-300);
+    input->getSubFieldT<pvd::PVLong>("i64")->put(-0x7fffffffffffffffll-1);
+    input->getSubFieldT<pvd::PVULong>("u64")->put(0xffffffffffffffffull);
+    input->getSubFieldT<pvd::PVFloat>("f")->put(1.0f/3.0f);
+    input->getSubFieldT<pvd::PVDouble>("d")->put(-1.25e-20);
+    input->getSubFieldT<pvd::PVString>("s")->put("a b");
+    {
+        pvd::PVByteArray::svector temp(3);
+        temp[0] = -128; temp[1] = 0; temp[2] = 127;
+        input->getSubFieldT<pvd::PVByteArray>("ai8")->replace(pvd::freeze(temp));
+    }
+    {
+        pvd::PVDoubleArray::svector temp(4);
+        temp[0] = 100000.0; temp[1] = 1234567.0; temp[2] = -0.0; temp[3] = 3.14159265358979;
+        input->getSubFieldT<pvd::PVDoubleArray>("ad")->replace(pvd::freeze(temp));
+    }
+    {
+        pvd::PVBooleanArray::svector temp(2);
+        temp[0] = false;
+        temp[1] = true;
+        input->getSubFieldT<pvd::PVBooleanArray>("ab")->replace(pvd::freeze(temp));
+    }
+    input->getSubFieldT<pvd::PVUnion>("below.below.select")->select<pvd::PVInt>("two")->put(2);
+    {
+        pvd::PVStructureArrayPtr arr(input->getSubFieldT<pvd::PVStructureArray>("below.below.astruct"));
+        pvd::PVStructureArray::svector temp(2);
+        temp[0] = pvd::getPVDataCreate()->createPVStructure(arr->getStructureArray()->getStructure());
+        arr->replace(pvd::freeze(temp));
+    }
+
+    std::string buf;
+    input->stream().appendRaw(buf);
+
+    testDiff(print(input->stream().format(pvd::PVStructure::Formatter::Raw)), buf, "same as stream");
+
+    // no special IDs, so also the same as PVField::dumpValue()
+    {
+        std::ostringstream strm;
+        strm<<*input;
+        testDiff(strm.str(), buf, "same as dumpValue()");
+    }
+
+    // appends
+    input->stream().appendRaw(buf);
+    testEqual(buf.size()%2u, 0u);
+    testOk1(buf.substr(0, buf.size()/2)==buf.substr(buf.size()/2));
+
+    // stream options are honored
+    {
+        std::ostringstream strm, expect;
+        strm<<std::hex<<std::setprecision(12)<<input->stream().format(pvd::PVStructure::Formatter::Raw);
+        expect<<std::hex<<std::setprecision(12)<<*input;
+        testDiff(expect.str(), strm.str(), "hex");
+    }
+    {
+        std::ostringstream strm, expect;
+        strm<<std::setprecision(17)<<input->stream().format(pvd::PVStructure::Formatter::Raw);
+        expect<<std::setprecision(17)<<*input;
+        testDiff(expect.str(), strm.str(), "precision");
+    }
+}
+
 void testEscape()
 {
     testDiag("%s", CURRENT_FUNCTION);
@@ -360,12 +446,13 @@ void testEscape()
 
 MAIN(testprinter)
 {
-    testPlan(26);
+    testPlan(32);
     showNTScalarNumeric();
     showNTScalarString();
     showNTEnum();
     showNTTable();
     testRaw();
+    testAppendRaw();
     testEscape();
     return testDone();
 }
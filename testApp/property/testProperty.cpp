@@ -215,9 +215,46 @@ static void testEnumerated()
     testPass("testEnumerated PASSED\n");
 }
 
+static void testAttach()
+{
+    testDiag("testAttach\n");
+    PVStructurePtr top(pvDataCreate->createPVStructure(fieldCreate->createFieldBuilder()
+                                                       ->add("secondsPastEpoch", pvLong)
+                                                       ->add("nanoseconds", pvInt)
+                                                       ->add("userTag", pvInt)
+                                                       ->addNestedStructure("sub")
+                                                           ->add("nanoseconds", pvLong)
+                                                       ->endNested()
+                                                       ->createStructure()));
+    top->getSubFieldT<PVLong>("secondsPastEpoch")->put(1234);
+
+    // found by looking up from "sub", where "nanoseconds" has the wrong type
+    PVTimeStamp pvTimeStamp;
+    testOk1(pvTimeStamp.attach(top->getSubFieldT("sub")));
+    TimeStamp ts;
+    pvTimeStamp.get(ts);
+    testOk1(ts.getSecondsPastEpoch()==1234);
+
+    // attached fields are kept alive
+    PVStructure::weak_pointer weak(top);
+    top.reset();
+    testOk1(!weak.expired());
+    pvTimeStamp.get(ts);
+    testOk1(ts.getSecondsPastEpoch()==1234);
+
+    // failure to attach detaches
+    PVAlarm pvAlarm;
+    testOk1(pvAlarm.attach(doubleRecord->getSubFieldT("alarm")));
+    testOk1(!pvAlarm.attach(doubleRecord->getSubFieldT("timeStamp")));
+    testOk1(!pvAlarm.isAttached());
+    testOk1(!pvTimeStamp.attach(doubleRecord->getSubFieldT("display")));
+    testOk1(!pvTimeStamp.isAttached());
+    testOk1(weak.expired());
+}
+
 MAIN(testProperty)
 {
-    testPlan(27);
+    testPlan(37);
     testDiag("Tests property");
     fieldCreate = getFieldCreate();
     pvDataCreate = getPVDataCreate();
@@ -229,6 +266,7 @@ MAIN(testProperty)
     testControl();
     testDisplay();
     testEnumerated();
+    testAttach();
     printRecords();
     return testDone();;
 }
@@ -0,0 +1,91 @@
+// Attempt to quantify the memory used by each type of PVField
+#include <stdlib.h>
+#include <stdio.h>
+#include <malloc.h>
+
+#include <vector>
+
+#include <testMain.h>
+#include <epicsUnitTest.h>
+
+#include <pv/pvData.h>
+#include <pv/standardField.h>
+
+namespace {
+
+namespace pvd = epics::pvData;
+
+// number of instances of each type
+const size_t ninst = 100000u;
+
+// bytes currently allocated from the heap
+size_t heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__>2 || (__GLIBC__==2 && __GLIBC_MINOR__>=33))
+    return mallinfo2().uordblks;
+#else
+    return size_t(unsigned(mallinfo().uordblks));
+#endif
+}
+
+void measure(const char *name, size_t objsize, const pvd::FieldConstPtr& type)
+{
+    pvd::PVDataCreatePtr create(pvd::getPVDataCreate());
+    std::vector<pvd::PVFieldPtr> fields;
+    fields.reserve(ninst);
+
+    const size_t before = heapInUse();
+    for(size_t i=0; i<ninst; i++)
+        fields.push_back(create->createPVField(type));
+    const size_t after = heapInUse();
+
+    const size_t nfields = fields[0]->getNumberFields();
+    const double perInst = double(after-before)/ninst;
+    printf("# %-16s sizeof %4zu  heap %8.1f bytes/instance  %6.1f bytes/field (%zu fields)\n",
+           name, objsize, perInst, perInst/nfields, nfields);
+}
+
+#define SCALAR(PVT, ST) measure(#PVT, sizeof(pvd::PVT), create->createScalar(pvd::ST))
+#define ARRAY(PVT, ST) measure(#PVT, sizeof(pvd::PVT), create->createScalarArray(pvd::ST))
+
+} // namespace
+
+MAIN(performFootprint) {
+    testPlan(0);
+    testDiag("sizeof(PVField)==%zu", sizeof(pvd::PVField));
+
+    pvd::FieldCreatePtr create(pvd::getFieldCreate());
+    pvd::StandardFieldPtr standard(pvd::getStandardField());
+
+    SCALAR(PVBoolean, pvBoolean);
+    SCALAR(PVByte, pvByte);
+    SCALAR(PVInt, pvInt);
+    SCALAR(PVLong, pvLong);
+    SCALAR(PVDouble, pvDouble);
+    SCALAR(PVString, pvString);
+
+    ARRAY(PVBooleanArray, pvBoolean);
+    ARRAY(PVIntArray, pvInt);
+    ARRAY(PVDoubleArray, pvDouble);
+    ARRAY(PVStringArray, pvString);
+
+    pvd::StructureConstPtr small(create->createFieldBuilder()
+                                 ->add("value", pvd::pvInt)
+                                 ->createStructure());
+    pvd::UnionConstPtr choice(create->createFieldBuilder()
+                              ->add("a", pvd::pvInt)
+                              ->add("b", pvd::pvString)
+                              ->createUnion());
+
+    measure("PVStructure", sizeof(pvd::PVStructure), small);
+    measure("PVStructureArray", sizeof(pvd::PVStructureArray), create->createStructureArray(small));
+    measure("PVUnion", sizeof(pvd::PVUnion), choice);
+    measure("PVUnion(variant)", sizeof(pvd::PVUnion), create->createVariantUnion());
+    measure("PVUnionArray", sizeof(pvd::PVUnionArray), create->createUnionArray(choice));
+
+    // a typical record
+    measure("NTScalar double", sizeof(pvd::PVStructure),
+            standard->scalar(pvd::pvDouble, "alarm,timeStamp,display,control,valueAlarm"));
+
+    return testDone();
+}
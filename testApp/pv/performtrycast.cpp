@@ -0,0 +1,242 @@
+// Attempt to quantify the cost of exceptions vs. status returns on input where 10% is invalid
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+
+#include <vector>
+#include <string>
+#include <sstream>
+
+#include <testMain.h>
+#include <epicsUnitTest.h>
+
+#include <pv/pvData.h>
+#include <pv/typeCast.h>
+
+namespace {
+
+namespace pvd = epics::pvData;
+
+struct TimeIt {
+    struct timespec m_start;
+    double sum, sum2;
+    size_t count;
+    TimeIt() { reset(); }
+    void reset() {
+        sum = sum2 = 0.0;
+        count = 0;
+    }
+    void start() {
+        clock_gettime(CLOCK_MONOTONIC, &m_start);
+    }
+    void end() {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double diff = (end.tv_sec-m_start.tv_sec) + (end.tv_nsec-m_start.tv_nsec)*1e-9;
+        sum += diff;
+        sum2 += diff*diff;
+        count++;
+    }
+    void report(const char *unit ="s", double mult=1.0) const {
+        double mean = sum/count;
+        double mean2 = sum2/count;
+        double std = sqrt(mean2 - mean*mean);
+        printf("# %zu sample   %f +- %f %s\n", count, mean/mult, std/mult, unit);
+    }
+};
+
+const size_t nelems = 1000;
+
+// every 10th element is invalid
+std::vector<std::string> makeInput()
+{
+    std::vector<std::string> ret(nelems);
+    for(size_t i=0; i<nelems; i++) {
+        std::ostringstream strm;
+        if(i%10==9)
+            strm<<"bad"<<i;
+        else
+            strm<<i;
+        ret[i] = strm.str();
+    }
+    return ret;
+}
+
+void parseThrow(const std::vector<std::string>& input)
+{
+    testDiag("castUnsafe() w/ catch");
+    TimeIt record;
+
+    for(size_t n=0; n<100; n++) {
+        size_t bad = 0;
+        pvd::int32 sum = 0;
+        record.start();
+        for(size_t i=0; i<nelems; i++) {
+            try {
+                sum += pvd::castUnsafe<pvd::int32>(input[i]);
+            } catch(std::runtime_error&) {
+                bad++;
+            }
+        }
+        record.end();
+        if(bad!=nelems/10)
+            testAbort("Miscount %zu", bad);
+    }
+
+    record.report("us per 1000", 1e-6);
+}
+
+void parseTry(const std::vector<std::string>& input)
+{
+    testDiag("tryCastUnsafe()");
+    TimeIt record;
+
+    for(size_t n=0; n<100; n++) {
+        size_t bad = 0;
+        pvd::int32 sum = 0;
+        record.start();
+        for(size_t i=0; i<nelems; i++) {
+            pvd::int32 val;
+            if(pvd::tryCastUnsafe(val, input[i]))
+                sum += val;
+            else
+                bad++;
+        }
+        record.end();
+        if(bad!=nelems/10)
+            testAbort("Miscount %zu", bad);
+    }
+
+    record.report("us per 1000", 1e-6);
+}
+
+// convert an array, skipping bad elements, as eg. a tolerant client would
+void arrayThrow(const std::vector<std::string>& input)
+{
+    testDiag("castUnsafeV() w/ catch, one element at a time");
+    TimeIt record;
+    std::vector<pvd::int32> output(nelems);
+
+    for(size_t n=0; n<100; n++) {
+        size_t bad = 0;
+        record.start();
+        for(size_t i=0; i<nelems; i++) {
+            try {
+                pvd::castUnsafeV(1, pvd::pvInt, &output[i], pvd::pvString, &input[i]);
+            } catch(std::runtime_error&) {
+                output[i] = 0;
+                bad++;
+            }
+        }
+        record.end();
+        if(bad!=nelems/10)
+            testAbort("Miscount %zu", bad);
+    }
+
+    record.report("us per 1000", 1e-6);
+}
+
+void arrayTry(const std::vector<std::string>& input)
+{
+    testDiag("tryCastUnsafeV(), resuming after each bad element");
+    TimeIt record;
+    std::vector<pvd::int32> output(nelems);
+
+    for(size_t n=0; n<100; n++) {
+        size_t bad = 0;
+        record.start();
+        for(size_t i=0; i<nelems; ) {
+            size_t done;
+            if(pvd::tryCastUnsafeV(nelems-i, pvd::pvInt, &output[i], pvd::pvString, &input[i], &done))
+                break;
+            i += done;
+            output[i++] = 0;
+            bad++;
+        }
+        record.end();
+        if(bad!=nelems/10)
+            testAbort("Miscount %zu", bad);
+    }
+
+    record.report("us per 1000", 1e-6);
+}
+
+std::vector<std::string> makeNames()
+{
+    std::vector<std::string> ret(nelems);
+    for(size_t i=0; i<nelems; i++)
+        ret[i] = i%10==9 ? "value.nothere" : "alarm.severity";
+    return ret;
+}
+
+pvd::PVStructurePtr makeStruct()
+{
+    return pvd::getFieldCreate()->createFieldBuilder()
+            ->add("value", pvd::pvDouble)
+            ->addNestedStructure("alarm")
+                ->add("severity", pvd::pvInt)
+                ->add("status", pvd::pvInt)
+                ->add("message", pvd::pvString)
+            ->endNested()
+            ->createStructure()->build();
+}
+
+void lookupThrow(const std::vector<std::string>& names)
+{
+    testDiag("getSubFieldT() w/ catch");
+    TimeIt record;
+    pvd::PVStructurePtr top(makeStruct());
+
+    for(size_t n=0; n<100; n++) {
+        size_t bad = 0;
+        record.start();
+        for(size_t i=0; i<nelems; i++) {
+            try {
+                top->getSubFieldT<pvd::PVInt>(names[i]);
+            } catch(std::runtime_error&) {
+                bad++;
+            }
+        }
+        record.end();
+        if(bad!=nelems/10)
+            testAbort("Miscount %zu", bad);
+    }
+
+    record.report("us per 1000", 1e-6);
+}
+
+void lookupTry(const std::vector<std::string>& names)
+{
+    testDiag("getSubField() w/ NULL check");
+    TimeIt record;
+    pvd::PVStructurePtr top(makeStruct());
+
+    for(size_t n=0; n<100; n++) {
+        size_t bad = 0;
+        record.start();
+        for(size_t i=0; i<nelems; i++) {
+            if(!top->getSubField<pvd::PVInt>(names[i]))
+                bad++;
+        }
+        record.end();
+        if(bad!=nelems/10)
+            testAbort("Miscount %zu", bad);
+    }
+
+    record.report("us per 1000", 1e-6);
+}
+
+} // namespace
+
+MAIN(performTryCast) {
+    testPlan(0);
+    std::vector<std::string> input(makeInput()), names(makeNames());
+    parseThrow(input);
+    parseTry(input);
+    arrayThrow(input);
+    arrayTry(input);
+    lookupThrow(names);
+    lookupTry(names);
+    return testDone();
+}
@@ -0,0 +1,158 @@
+// Attempt to quantify the cost of dispatching on the type ID of many structures
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+
+#include <vector>
+
+#include <testMain.h>
+#include <epicsUnitTest.h>
+
+#include <pv/current_function.h>
+#include <pv/pvData.h>
+#include <pv/standardField.h>
+
+namespace {
+
+namespace pvd = epics::pvData;
+
+struct TimeIt {
+    struct timespec m_start;
+    double sum, sum2;
+    size_t count;
+    TimeIt() { reset(); }
+    void reset() {
+        sum = sum2 = 0.0;
+        count = 0;
+    }
+    void start() {
+        clock_gettime(CLOCK_MONOTONIC, &m_start);
+    }
+    void end() {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double diff = (end.tv_sec-m_start.tv_sec) + (end.tv_nsec-m_start.tv_nsec)*1e-9;
+        sum += diff;
+        sum2 += diff*diff;
+        count++;
+    }
+    void report(const char *unit ="s", double mult=1.0) const {
+        double mean = sum/count;
+        double mean2 = sum2/count;
+        double std = sqrt(mean2 - mean*mean);
+        printf("# %zu sample   %f +- %f %s\n", count, mean/mult, std/mult, unit);
+    }
+};
+
+const size_t nstructs = 1000000u;
+
+typedef std::vector<pvd::StructureConstPtr> structs_t;
+
+structs_t makeStructs()
+{
+    pvd::FieldCreatePtr create(pvd::getFieldCreate());
+    pvd::StandardFieldPtr standard(pvd::getStandardField());
+
+    structs_t types;
+    types.push_back(standard->scalar(pvd::pvDouble, "alarm,timeStamp,display,control"));
+    types.push_back(standard->scalarArray(pvd::pvInt, "alarm,timeStamp"));
+    types.push_back(standard->enumerated("alarm,timeStamp"));
+    types.push_back(create->createFieldBuilder()
+                    ->setId("epics:nt/NTTable:1.0")
+                    ->addArray("labels", pvd::pvString)
+                    ->createStructure());
+    types.push_back(standard->alarm());
+    types.push_back(standard->timeStamp());
+    types.push_back(create->createFieldBuilder()
+                    ->add("other", pvd::pvInt)
+                    ->createStructure());
+
+    structs_t ret(nstructs);
+    for(size_t i=0; i<nstructs; i++)
+        ret[i] = types[(i*3u)%types.size()];
+    return ret;
+}
+
+// compare ID strings, copied as getID() used to return by value
+size_t byString(const structs_t& structs, size_t counts[4])
+{
+    size_t n = 0;
+    for(size_t i=0, N=structs.size(); i<N; i++) {
+        std::string id(structs[i]->getID()),
+                    idprefix(id.substr(0, id.find_first_of('.')));
+        if(idprefix=="epics:nt/NTScalar:1")
+            counts[0]++;
+        else if(idprefix=="epics:nt/NTTable:1")
+            counts[1]++;
+        else if(id=="alarm_t")
+            counts[2]++;
+        else if(id=="time_t")
+            counts[3]++;
+        n++;
+    }
+    return n;
+}
+
+// compare the interned ID string
+size_t byReference(const structs_t& structs, size_t counts[4])
+{
+    size_t n = 0;
+    for(size_t i=0, N=structs.size(); i<N; i++) {
+        const std::string& id(structs[i]->getID());
+        if(id.compare(0, 20, "epics:nt/NTScalar:1.")==0)
+            counts[0]++;
+        else if(id.compare(0, 19, "epics:nt/NTTable:1.")==0)
+            counts[1]++;
+        else if(id=="alarm_t")
+            counts[2]++;
+        else if(id=="time_t")
+            counts[3]++;
+        n++;
+    }
+    return n;
+}
+
+size_t byTag(const structs_t& structs, size_t counts[4])
+{
+    size_t n = 0;
+    for(size_t i=0, N=structs.size(); i<N; i++) {
+        switch(structs[i]->getTypeTag()) {
+        case pvd::TypeTag::NTScalar: counts[0]++; break;
+        case pvd::TypeTag::NTTable: counts[1]++; break;
+        case pvd::TypeTag::Alarm: counts[2]++; break;
+        case pvd::TypeTag::TimeStamp: counts[3]++; break;
+        default: break;
+        }
+        n++;
+    }
+    return n;
+}
+
+void run(const char *name, size_t (*fn)(const structs_t&, size_t*), const structs_t& structs)
+{
+    testDiag("%s", name);
+    TimeIt record;
+    size_t counts[4] = {0u, 0u, 0u, 0u};
+
+    for(size_t n=0; n<10; n++) {
+        record.start();
+        (*fn)(structs, counts);
+        record.end();
+    }
+
+    testDiag("NTScalar %zu NTTable %zu alarm_t %zu time_t %zu",
+             counts[0], counts[1], counts[2], counts[3]);
+    record.report("ns/structure", 1e-9*structs.size());
+}
+
+} // namespace
+
+MAIN(performTypeTag) {
+    testPlan(0);
+    structs_t structs(makeStructs());
+    run("byString", &byString, structs);
+    run("byReference", &byReference, structs);
+    run("byTag", &byTag, structs);
+    return testDone();
+}
@@ -16,6 +16,7 @@
 #include <testMain.h>
 
 #include <pv/bitSetUtil.h>
+#include <pv/pvUnitTest.h>
 #include <pv/standardField.h>
 #include <pv/standardPVField.h>
 
@@ -117,13 +118,90 @@ static void test()
     printf("testBitSetUtil PASSED\n");
 }
 
+// the original recursive algorithm, walking a PVStructure
+static bool referenceCompress(PVField& pvField, BitSet& bitSet, uint32 initialOffset)
+{
+    uint32 nbits = (uint32)pvField.getNumberFields();
+    if(nbits==1) return bitSet.get(initialOffset);
+    int32 nextSetBit = bitSet.nextSetBit(initialOffset);
+    if(nextSetBit<0 || uint32(nextSetBit)>=initialOffset+nbits) return false;
+    if(bitSet.get(initialOffset)) {
+        for(uint32 i=initialOffset+1; i<initialOffset+nbits; i++) bitSet.clear(i);
+        return true;
+    }
+    bool atLeastOneBitSet = false;
+    bool allBitsSet = true;
+    const PVFieldPtrArray& fields = static_cast<PVStructure&>(pvField).getPVFields();
+    uint32 offset = initialOffset+1;
+    for(size_t i=0; i<fields.size(); i++) {
+        uint32 nbitsNow = (uint32)fields[i]->getNumberFields();
+        if(referenceCompress(*fields[i], bitSet, offset)) {
+            atLeastOneBitSet = true;
+            if(!bitSet.get(offset)) allBitsSet = false;
+        } else {
+            allBitsSet = false;
+        }
+        offset += nbitsNow;
+    }
+    if(allBitsSet) {
+        for(uint32 i=initialOffset+1; i<initialOffset+nbits; i++) bitSet.clear(i);
+        bitSet.set(initialOffset);
+    }
+    return atLeastOneBitSet;
+}
+
+static void testRandomMasks()
+{
+    testDiag("testRandomMasks");
+
+    StructureConstPtr type(fieldCreate->createFieldBuilder()
+                           ->add("value", standardField->scalar(pvDouble, "alarm,timeStamp,display,control,valueAlarm"))
+                           ->add("index", pvInt)
+                           ->addNestedStructure("nested")
+                               ->addNestedStructure("empty")
+                               ->endNested()
+                               ->add("alarm", standardField->alarm())
+                               ->addArray("data", pvDouble)
+                           ->endNested()
+                           ->createStructure());
+    PVStructurePtr pvs(pvDataCreate->createPVStructure(type));
+    const uint32 nbits = (uint32)pvs->getNumberFields();
+    testDiag("%u fields", nbits);
+
+    srand(1234);
+    unsigned badBits = 0, badResult = 0, badOverload = 0;
+    for(unsigned n=0; n<2000; n++) {
+        // vary the density from sparse to full
+        const unsigned density = n%11u;
+        BitSet mask;
+        for(uint32 i=0; i<nbits; i++) {
+            if(unsigned(rand()%10) < density)
+                mask.set(i);
+        }
+
+        BitSet expect(mask), actual(mask);
+        bool expectResult = referenceCompress(*pvs, expect, 0);
+        bool actualResult = BitSetUtil::compress(actual, type);
+        if(expect!=actual) badBits++;
+        if(expectResult!=actualResult) badResult++;
+
+        BitSetPtr viaPV(new BitSet(mask));
+        BitSetUtil::compress(viaPV, pvs);
+        if(*viaPV!=actual) badOverload++;
+    }
+    testEqual(badBits, 0u);
+    testEqual(badResult, 0u);
+    testEqual(badOverload, 0u);
+}
+
 MAIN(testBitSetUtil)
 {
-    testPlan(5);
+    testPlan(8);
     fieldCreate = getFieldCreate();
     pvDataCreate = getPVDataCreate();
     standardField = getStandardField();
     standardPVField = getStandardPVField();
     test();
+    testRandomMasks();
     return testDone();
 }
@@ -0,0 +1,197 @@
+/* testColumnarStructureArray.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <vector>
+#include <string>
+#include <sstream>
+
+#include <epicsEndian.h>
+
+#include <pv/pvData.h>
+#include <pv/serialize.h>
+#include <pv/standardField.h>
+#include <pv/columnarStructureArray.h>
+#include <pv/pvUnitTest.h>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+pvd::StructureConstPtr pointType()
+{
+    return pvd::getFieldCreate()->createFieldBuilder()
+            ->add("x", pvd::pvDouble)
+            ->add("y", pvd::pvFloat)
+            ->add("flag", pvd::pvBoolean)
+            ->addNestedStructure("tag")
+                ->add("id", pvd::pvULong)
+                ->add("code", pvd::pvShort)
+            ->endNested()
+            ->createStructure();
+}
+
+pvd::StructureConstPtr labelType()
+{
+    return pvd::getFieldCreate()->createFieldBuilder()
+            ->add("index", pvd::pvInt)
+            ->add("label", pvd::pvString)
+            ->createStructure();
+}
+
+// build a structure array with 'count' elements with distinct values
+pvd::PVStructureArrayPtr buildPoints(size_t count)
+{
+    pvd::PVStructureArrayPtr arr(pvd::getPVDataCreate()->createPVStructureArray(pointType()));
+    pvd::PVStructureArray::svector elems(count);
+    for(size_t i=0; i<count; i++) {
+        elems[i] = pvd::getPVDataCreate()->createPVStructure(pointType());
+        elems[i]->getSubFieldT<pvd::PVDouble>("x")->put(i*1.5);
+        elems[i]->getSubFieldT<pvd::PVFloat>("y")->put(-float(i));
+        elems[i]->getSubFieldT<pvd::PVBoolean>("flag")->put(i%3==0);
+        elems[i]->getSubFieldT<pvd::PVULong>("tag.id")->put(0x0102030405060708ull+i);
+        elems[i]->getSubFieldT<pvd::PVShort>("tag.code")->put(pvd::int16(i));
+    }
+    arr->replace(pvd::freeze(elems));
+    return arr;
+}
+
+void testColumns()
+{
+    testDiag("testColumns");
+
+    pvd::ColumnarStructureArray table(pointType());
+
+    testEqual(table.getNumberColumns(), 5u);
+    testEqual(table.getColumnName(0), "x");
+    testEqual(table.getColumnName(3), "tag.id");
+    testEqual(table.getColumnType(3), pvd::pvULong);
+    testEqual(table.getColumnIndex("tag.code"), 4u);
+    testEqual(table.getColumnIndex("nothere"), size_t(-1));
+    testEqual(table.getLength(), 0u);
+
+    table.setLength(3);
+    {
+        pvd::shared_vector<const double> x(table.getColumn<double>("x"));
+        testEqual(x.size(), 3u);
+        testOk1(x[0]==0.0 && x[2]==0.0);
+    }
+
+    pvd::shared_vector<double> x(3);
+    x[0] = 1.0; x[1] = 2.0; x[2] = 3.0;
+    pvd::shared_vector<const double> cx(pvd::freeze(x));
+    table.putColumn("x", cx);
+    testOk1(table.getColumn<double>(0).data()==cx.data()); // zero copy
+
+    // converting put
+    pvd::shared_vector<pvd::int32> ival(3);
+    ival[0] = 4; ival[1] = 5; ival[2] = 6;
+    table.putColumn<pvd::int32>(1, pvd::freeze(ival));
+    testEqual(table.getColumn<float>("y")[2], 6.0f);
+
+    table.setLength(4);
+    testEqual(table.getColumn<double>("x")[2], 3.0);
+    testEqual(table.getColumn<double>("x")[3], 0.0);
+
+    testThrows(std::logic_error, table.getColumn<pvd::int32>("x"));
+    testThrows(std::length_error, table.putColumn("x", cx));
+
+    testThrows(std::invalid_argument,
+               pvd::ColumnarStructureArray(pvd::getFieldCreate()->createFieldBuilder()
+                                                ->addArray("bad", pvd::pvInt)
+                                                ->createStructure()));
+}
+
+void testCopy()
+{
+    testDiag("testCopy");
+
+    pvd::PVStructureArrayPtr arr(buildPoints(10));
+
+    pvd::ColumnarStructureArray table(pointType());
+    table.copyFrom(*arr);
+
+    testEqual(table.getLength(), 10u);
+    testEqual(table.getColumn<double>("x")[4], 6.0);
+    testEqual(table.getColumn<pvd::uint64>("tag.id")[9], 0x0102030405060708ull+9);
+    testEqual(table.getColumn<pvd::int16>("tag.code")[7], 7);
+
+    pvd::PVStructureArrayPtr back(pvd::getPVDataCreate()->createPVStructureArray(pointType()));
+    table.copyTo(*back);
+    testOk1(*arr==*back);
+
+    pvd::PVStructureArrayPtr other(pvd::getPVDataCreate()->createPVStructureArray(labelType()));
+    testThrows(std::invalid_argument, table.copyFrom(*other));
+}
+
+void testSerialize(pvd::StructureConstPtr type, const pvd::PVStructureArray& arr, int byteOrder)
+{
+    std::vector<epicsUInt8> expect, actual;
+
+    pvd::serializeToVector(&arr, byteOrder, expect);
+
+    pvd::ColumnarStructureArray table(type);
+    table.copyFrom(arr);
+    pvd::serializeToVector(&table, byteOrder, actual);
+
+    testOk(expect==actual, "serialize %u elements, %u bytes, byte order %d",
+           unsigned(arr.getLength()), unsigned(expect.size()), byteOrder);
+
+    pvd::ColumnarStructureArray table2(type);
+    pvd::deserializeFromVector(&table2, byteOrder, expect);
+
+    pvd::PVStructureArrayPtr back(pvd::getPVDataCreate()->createPVStructureArray(type));
+    table2.copyTo(*back);
+    testOk(arr==*back, "deserialize %u elements", unsigned(table2.getLength()));
+}
+
+void testSerialization()
+{
+    testDiag("testSerialization");
+
+    // larger than one serialization buffer
+    pvd::PVStructureArrayPtr points(buildPoints(2000));
+    testSerialize(pointType(), *points, EPICS_ENDIAN_LITTLE);
+    testSerialize(pointType(), *points, EPICS_ENDIAN_BIG);
+
+    pvd::PVStructureArrayPtr labels(pvd::getPVDataCreate()->createPVStructureArray(labelType()));
+    {
+        pvd::PVStructureArray::svector elems(100);
+        for(size_t i=0; i<elems.size(); i++) {
+            std::ostringstream strm;
+            strm<<"label"<<i;
+            elems[i] = pvd::getPVDataCreate()->createPVStructure(labelType());
+            elems[i]->getSubFieldT<pvd::PVInt>("index")->put(pvd::int32(i));
+            elems[i]->getSubFieldT<pvd::PVString>("label")->put(strm.str());
+        }
+        labels->replace(pvd::freeze(elems));
+    }
+    testSerialize(labelType(), *labels, EPICS_ENDIAN_LITTLE);
+    testSerialize(labelType(), *labels, EPICS_ENDIAN_BIG);
+
+    // NULL elements can't be represented
+    labels->setLength(101);
+    {
+        std::vector<epicsUInt8> bytes;
+        pvd::serializeToVector(labels.get(), EPICS_ENDIAN_LITTLE, bytes);
+        pvd::ColumnarStructureArray table(labelType());
+        testThrows(std::runtime_error, pvd::deserializeFromVector(&table, EPICS_ENDIAN_LITTLE, bytes));
+        testEqual(table.getLength(), 0u);
+    }
+}
+
+} // namespace
+
+MAIN(testColumnarStructureArray)
+{
+    testPlan(32);
+    testColumns();
+    testCopy();
+    testSerialization();
+    return testDone();
+}
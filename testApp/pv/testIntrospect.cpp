@@ -406,9 +406,90 @@ static void testMapping()
 
 }
 
+static void testTypeTag()
+{
+    testDiag("testTypeTag");
+
+    StructureConstPtr alarm(standardField->alarm());
+    testOk1(&alarm->getID()==&alarm->getID());
+    testOk1(alarm->getTypeTag()==TypeTag::Alarm);
+    testOk1(standardField->timeStamp()->getTypeTag()==TypeTag::TimeStamp);
+    testOk1(standardField->enumerated()->getTypeTag()==TypeTag::Enumerated);
+    testOk1(standardField->scalar(pvDouble, "alarm")->getTypeTag()==TypeTag::NTScalar);
+    testOk1(fieldCreate->createScalar(pvDouble)->getTypeTag()==TypeTag::Unknown);
+
+    // matched by major version
+    testOk1(TypeTag::lookup("epics:nt/NTTable:1.0")==TypeTag::NTTable);
+    testOk1(TypeTag::lookup("epics:nt/NTTable:1.2")==TypeTag::NTTable);
+    testOk1(TypeTag::lookup("epics:nt/NTTable:2.0")==TypeTag::Unknown);
+    testOk1(TypeTag::lookup("epics:nt/NTTable")==TypeTag::Unknown);
+    testOk1(TypeTag::lookup("epics:nt/NTTable:1.0.1")==TypeTag::Unknown);
+
+    // arrays of a tagged type are not tagged
+    testOk1(TypeTag::lookup("epics:nt/NTTable:1.0[]")==TypeTag::Unknown);
+    testOk1(TypeTag::lookup("epics:nt/NTTable:1[]")==TypeTag::Unknown);
+    StructureConstPtr table(fieldCreate->createFieldBuilder()
+                            ->setId("epics:nt/NTTable:1.0")
+                            ->addArray("labels", pvString)
+                            ->createStructure());
+    testOk1(table->getTypeTag()==TypeTag::NTTable);
+    testOk1(fieldCreate->createStructureArray(table)->getTypeTag()==TypeTag::Unknown);
+
+    StructureConstPtr mine(fieldCreate->createFieldBuilder()
+                           ->setId("test:mytype:1.0")
+                           ->add("value", pvInt)
+                           ->createStructure());
+    StructureArrayConstPtr mineArray(fieldCreate->createStructureArray(mine));
+    testOk1(mineArray->getID()=="test:mytype:1.0[]");
+    testOk1(mine->getTypeTag()==TypeTag::Unknown);
+
+    // Fields created before add() see the new tag
+    int32 tag = TypeTag::add("test:mytype:1.1");
+    testOk1(tag>=TypeTag::FirstUser);
+    testOk1(TypeTag::add("test:mytype:1.0")==tag);
+    testOk1(mine->getTypeTag()==tag);
+    testOk1(mineArray->getTypeTag()==TypeTag::Unknown);
+    testOk1(TypeTag::add("alarm_t")==TypeTag::Alarm);
+}
+
+namespace {
+const char * const pairNames[] = {"b", "a"};
+const Type pairTypes[] = {scalarArray, scalar};
+const ScalarType pairScalarTypes[] = {pvString, pvInt};
+const Structure::MemberSet pairMembers = {2u, pairNames, pairTypes, pairScalarTypes};
+
+const ScalarType otherScalarTypes[] = {pvString, pvDouble};
+const Structure::MemberSet otherMembers = {2u, pairNames, pairTypes, otherScalarTypes};
+}
+
+static void testMemberIndices()
+{
+    testDiag("testMemberIndices");
+
+    StructureConstPtr type(fieldCreate->createFieldBuilder()
+                           ->add("x", pvDouble)
+                           ->add("a", pvInt)
+                           ->addArray("b", pvString)
+                           ->createStructure());
+
+    const uint32 *idx = type->getMemberIndices(pairMembers);
+    testOk1(idx!=NULL);
+    if(idx)
+        testOk1(idx[0]==2u && idx[1]==1u);
+    else
+        testFail("not found");
+    testOk1(type->getMemberIndices(pairMembers)==idx);
+
+    // wrong type
+    testOk1(type->getMemberIndices(otherMembers)==NULL);
+    testOk1(type->getMemberIndices(otherMembers)==NULL);
+    // missing
+    testOk1(standardField->alarm()->getMemberIndices(pairMembers)==NULL);
+}
+
 MAIN(testIntrospect)
 {
-    testPlan(358);
+    testPlan(386);
     fieldCreate = getFieldCreate();
     pvDataCreate = getPVDataCreate();
     standardField = getStandardField();
@@ -419,5 +500,7 @@ MAIN(testIntrospect)
     testBoundedString();
     testError();
     testMapping();
+    testTypeTag();
+    testMemberIndices();
     return testDone();
 }
@@ -9,6 +9,7 @@
 #include <cstdlib>
 #include <cstddef>
 #include <string>
+#include <sstream>
 #include <cstdio>
 
 #include <pv/pvUnitTest.h>
@@ -23,6 +24,8 @@
 #include <pv/pvTimeStamp.h>
 #include <pv/bitSet.h>
 
+#include <epicsMath.h>
+
 using namespace epics::pvData;
 using std::tr1::static_pointer_cast;
 using std::string;
@@ -690,6 +693,44 @@ static void testAnyScalar()
     testEqual(c->get(), "42");
 }
 
+static void testTryConvert()
+{
+    testDiag("testTryConvert()");
+
+    PVStructurePtr value(FieldBuilder::begin()
+                         ->add("a", pvInt)
+                         ->add("c", pvString)
+                         ->createStructure()->build());
+
+    PVIntPtr a(value->getSubFieldT<PVInt>("a"));
+    PVStringPtr c(value->getSubFieldT<PVString>("c"));
+    PVScalar& sa = *a;
+    PVScalar& sc = *c;
+
+    a->put(1);
+    c->put("12");
+
+    int32 ival = -1;
+    testOk1(sc.tryGetAs(ival));
+    testEqual(ival, 12);
+    testOk1(c->tryGetAs(ival));
+
+    testOk1(sa.tryPutFrom<std::string>("0x20"));
+    testEqual(a->get(), 32);
+
+    c->put("bad");
+    ival = -1;
+    testOk1(!sc.tryGetAs(ival));
+    testEqual(ival, -1);
+    testOk1(!sa.tryPutFrom<std::string>(c->get()));
+    testOk1(!a->tryPutFrom<std::string>(c->get()));
+    testEqual(a->get(), 32);
+
+    double dval = 0.0;
+    testOk1(sa.tryGetAs(dval));
+    testEqual(dval, 32.0);
+}
+
 static void testSubField()
 {
     testDiag("testSubField()");
@@ -766,9 +807,324 @@ static void testSubField()
     testEqual(value->getSubField(9), PVFieldPtr());
 }
 
+static void testDiff()
+{
+    testDiag("testDiff()");
+
+    StructureConstPtr type(fieldCreate->createFieldBuilder()
+                           ->add("a", pvInt)
+                           ->addNestedStructure("B")
+                               ->add("b", pvDouble)
+                               ->add("s", pvString)
+                           ->endNested()
+                           ->addArray("arr", pvShort)
+                           ->addArray("sarr", pvString)
+                           ->addNestedStructureArray("C")
+                               ->add("c", pvInt)
+                           ->endNested()
+                           ->createStructure());
+
+    PVStructurePtr prev(pvDataCreate->createPVStructure(type)),
+                   cur(pvDataCreate->createPVStructure(type));
+    BitSet changed;
+
+    testOk1(!diff(*prev, *cur, changed));
+    testEqual(changed.cardinality(), 0u);
+    testOk1(!diff(*prev, *prev, changed));
+
+    shared_vector<int16> arr(4, 1);
+    cur->getSubFieldT<PVShortArray>("arr")->replace(freeze(arr));
+    cur->getSubFieldT<PVDouble>("B.b")->put(1.5);
+    cur->getSubFieldT<PVString>("B.s")->put("x");
+
+    testOk1(diff(*prev, *cur, changed));
+    testEqual(changed, BitSet().set(cur->getSubFieldT("B.b")->getFieldOffset())
+                               .set(cur->getSubFieldT("B.s")->getFieldOffset())
+                               .set(cur->getSubFieldT("arr")->getFieldOffset()));
+    testOk1(*prev!=*cur);
+
+    changed.clear();
+    testOk1(diffUpdate(*prev, *cur, changed));
+    testEqual(changed.cardinality(), 3u);
+    testEqual(*prev, *cur);
+    // arrays are shared after update
+    testOk1(prev->getSubFieldT<PVShortArray>("arr")->view().data()==cur->getSubFieldT<PVShortArray>("arr")->view().data());
+
+    changed.clear();
+    testOk1(!diffUpdate(*prev, *cur, changed));
+    testEqual(changed.cardinality(), 0u);
+
+    // same values in distinct arrays
+    {
+        shared_vector<int16> arr2(4, 1);
+        prev->getSubFieldT<PVShortArray>("arr")->replace(freeze(arr2));
+        shared_vector<string> sarr(2, "y"), sarr2(2, "y");
+        prev->getSubFieldT<PVStringArray>("sarr")->replace(freeze(sarr));
+        cur->getSubFieldT<PVStringArray>("sarr")->replace(freeze(sarr2));
+        testOk1(!diff(*prev, *cur, changed));
+    }
+
+    // NaN by bit pattern
+    {
+        double nan = epicsNAN;
+        prev->getSubFieldT<PVDouble>("B.b")->put(nan);
+        cur->getSubFieldT<PVDouble>("B.b")->put(nan);
+        testOk1(!diff(*prev, *cur, changed));
+    }
+
+    // structure array compares by value
+    {
+        PVStructureArray::svector elems(1);
+        elems[0] = pvDataCreate->createPVStructure(type->getField<StructureArray>("C")->getStructure());
+        elems[0]->getSubFieldT<PVInt>("c")->put(3);
+        cur->getSubFieldT<PVStructureArray>("C")->replace(freeze(elems));
+        testOk1(diff(*prev, *cur, changed));
+        testEqual(changed, BitSet().set(cur->getSubFieldT("C")->getFieldOffset()));
+    }
+
+    PVStructurePtr other(standardPVField->scalar(pvInt, ""));
+    testThrows(std::invalid_argument, diff(*prev, *other, changed));
+}
+
+namespace {
+struct CountPut : public PostHandler {
+    size_t count;
+    CountPut() :count(0u) {}
+    virtual ~CountPut() {}
+    virtual void postPut() { count++; }
+};
+
+struct CountBatch : public PostBatchHandler {
+    size_t count;
+    BitSet changed;
+    CountBatch() :count(0u) {}
+    virtual ~CountBatch() {}
+    virtual void postPut(const BitSet& changed) {
+        count++;
+        this->changed = changed;
+    }
+};
+}
+
+static void testFieldNames()
+{
+    testDiag("testFieldNames()");
+
+    PVStructurePtr top(ValueBuilder()
+                       .add<pvInt>("a", 0)
+                       .addNested("B")
+                          .add<pvInt>("b", 0)
+                       .endNested()
+                       .buildPVStructure());
+
+    testOk1(top->getFieldName().empty());
+
+    // names are not copied
+    PVIntPtr a(top->getSubFieldT<PVInt>("a"));
+    PVStructurePtr B(top->getSubFieldT<PVStructure>("B"));
+    testOk1(&a->getFieldName()==&top->getStructure()->getFieldNames()[top->getStructure()->getFieldIndex("a")]);
+    testOk1(&B->getSubFieldT("b")->getFieldName()==&B->getStructure()->getFieldNames()[0]);
+    testOk1(B->getSubFieldT("b")->getFullName()=="B.b");
+
+    std::tr1::shared_ptr<CountPut> handler(new CountPut);
+    a->postPut(); // no handler
+    a->setPostHandler(handler);
+    a->put(5); // calls postPut()
+    testOk1(handler->count==1u);
+
+    // fields may outlive their parent, and keep their names
+    top.reset();
+    testOk1(a->getParent()==NULL && a->getFieldName()=="a");
+    testOk1(B->getParent()==NULL && B->getSubFieldT("b")->getFullName()=="B.b");
+    a->postPut();
+    testOk1(handler->count==2u);
+
+    // fields shared with a newer structure
+    PVStructurePtr A(getPVDataCreate()->createPVStructure(
+                         getStandardField()->scalar(pvDouble, "alarm")));
+    {
+        PVStructurePtr other(getPVDataCreate()->createPVStructure(
+                                 A->getStructure()->getFieldNames(), A->getPVFields()));
+        testOk1(A->getSubField("value")->getParent()==other.get());
+    }
+    testOk1(!!A->getSubField("value"));
+    testOk1(!!A->getSubField("alarm.severity"));
+    testEqual(A->getPVFields()[0]->getFieldName(), "value");
+    std::ostringstream strm;
+    strm<<*A;
+    testOk(strm.str().find("double value")!=std::string::npos, "print %s", strm.str().c_str());
+}
+
+static void testLayout()
+{
+    testDiag("testLayout()");
+
+    PVStructurePtr top(getPVDataCreate()->createPVStructure(
+                           getStandardField()->scalar(pvDouble, "alarm,timeStamp,display")));
+    StructureConstPtr type(top->getStructure());
+    const Structure::Layout& layout = type->getLayout();
+
+    testOk1(&layout==&type->getLayout()); // built once
+    testOk1(layout.size()==top->getNextFieldOffset());
+    testOk1(layout[0].field==type.get() && layout[0].nextOffset==layout.size());
+
+    bool match = true;
+    for(size_t i=1; i<layout.size(); i++) {
+        PVFieldPtr fld(top->getSubFieldT(i));
+        const PVStructure *parent = fld->getParent();
+        match &= layout[i].field==fld->getField().get();
+        match &= layout[i].nextOffset==fld->getNextFieldOffset();
+        match &= layout[i].parentOffset==parent->getFieldOffset();
+        match &= *layout[i].name==fld->getFieldName();
+        match &= parent->getStructure()->getFields()[layout[i].memberIndex].get()==layout[i].field;
+    }
+    testOk(match, "layout matches PVStructure offsets");
+
+    // offsets are absolute, also for a sub-structure
+    PVStructurePtr ts(top->getSubFieldT<PVStructure>("timeStamp"));
+    testOk1(ts->getSubFieldT(ts->getFieldOffset()+2u)==ts->getSubFieldT("nanoseconds"));
+    testThrows(std::runtime_error, ts->getSubFieldT(ts->getNextFieldOffset()));
+    testOk1(!ts->getSubField(ts->getFieldOffset()));
+}
+
+static void testPostBatch()
+{
+    testDiag("testPostBatch()");
+
+    PVStructurePtr top(ValueBuilder()
+                       .add<pvInt>("a", 0)
+                       .addNested("B")
+                          .add<pvInt>("b", 0)
+                          .add<pvInt>("c", 0)
+                       .endNested()
+                       .buildPVStructure());
+    PVIntPtr a(top->getSubFieldT<PVInt>("a")),
+             b(top->getSubFieldT<PVInt>("B.b")),
+             c(top->getSubFieldT<PVInt>("B.c"));
+    PVStructurePtr B(top->getSubFieldT<PVStructure>("B"));
+
+    std::tr1::shared_ptr<CountPut> aPost(new CountPut), bPost(new CountPut);
+    a->setPostHandler(aPost);
+    b->setPostHandler(bPost);
+    std::tr1::shared_ptr<CountBatch> topBatch(new CountBatch), BBatch(new CountBatch);
+    top->setPostBatchHandler(topBatch);
+    B->setPostBatchHandler(BBatch);
+    testThrows(std::logic_error, top->setPostBatchHandler(PostBatchHandlerPtr(new CountBatch)));
+
+    {
+        PVStructure::PostBatch batch(*top);
+        a->put(1);
+        a->put(2);
+        b->put(3);
+        {
+            PVStructure::PostBatch nested(*top);
+            c->put(4);
+        }
+        testOk1(aPost->count==0u && bPost->count==0u && topBatch->count==0u);
+        testOk1(a->get()==2);
+    }
+    testOk1(topBatch->count==1u);
+    testEqual(topBatch->changed, BitSet().set(a->getFieldOffset()).set(b->getFieldOffset()).set(c->getFieldOffset()));
+    testOk1(aPost->count==1u && bPost->count==1u);
+    testOk1(BBatch->count==0u);
+
+    // batch on a sub-structure within a batch on the top
+    {
+        PVStructure::PostBatch batch(*top);
+        {
+            PVStructure::PostBatch inner(*B);
+            b->put(5);
+        }
+        testOk1(BBatch->count==1u && bPost->count==1u);
+        testEqual(BBatch->changed, BitSet().set(1u));
+    }
+    testOk1(topBatch->count==2u && bPost->count==2u);
+    testEqual(topBatch->changed, BitSet().set(b->getFieldOffset()));
+
+    // no changes, no call
+    {
+        PVStructure::PostBatch batch(*top);
+    }
+    testOk1(topBatch->count==2u);
+
+    // after the batch, immediate again
+    a->put(6);
+    testOk1(aPost->count==2u && topBatch->count==2u);
+}
+
+static void testSnapshot()
+{
+    testDiag("testSnapshot()");
+
+    PVStructurePtr current(getPVDataCreate()->createPVStructure(
+                               getStandardField()->scalar(pvDouble, "alarm,timeStamp,display")));
+    PVDoublePtr value(current->getSubFieldT<PVDouble>("value"));
+    PVIntPtr nanoseconds(current->getSubFieldT<PVInt>("timeStamp.nanoseconds"));
+    BitSet changed;
+
+    value->put(1.0);
+    PVStructure::const_shared_pointer first(current->snapshot(changed, PVStructure::const_shared_pointer()));
+    testOk1(first && first->isImmutable() && first->getSubFieldT<PVDouble>("value")->get()==1.0);
+    testOk1(first->getSubField("alarm")!=current->getSubField("alarm"));
+
+    value->put(2.0);
+    nanoseconds->put(42);
+    changed.set(value->getFieldOffset());
+    changed.set(nanoseconds->getFieldOffset());
+    PVStructure::const_shared_pointer second(current->snapshot(changed, first));
+
+    testOk1(second->isImmutable());
+    testOk1(second->getSubFieldT<PVDouble>("value")->get()==2.0);
+    testOk1(second->getSubFieldT<PVInt>("timeStamp.nanoseconds")->get()==42);
+    testOk1(first->getSubFieldT<PVDouble>("value")->get()==1.0);
+    testOk1(first->getSubFieldT<PVInt>("timeStamp.nanoseconds")->get()==0);
+
+    // unchanged sub-fields are shared
+    testOk1(second->getSubField("alarm")==first->getSubField("alarm"));
+    testOk1(second->getSubField("display")==first->getSubField("display"));
+    testOk1(second->getSubField("timeStamp.secondsPastEpoch")==first->getSubField("timeStamp.secondsPastEpoch"));
+    testOk1(second->getSubField("timeStamp")!=first->getSubField("timeStamp"));
+    testOk1(second->getSubField("value")!=first->getSubField("value"));
+
+    // offsets of the new snapshot
+    testOk1(second->getSubFieldT(nanoseconds->getFieldOffset())==second->getSubField("timeStamp.nanoseconds"));
+    testOk1(second->getNumberFields()==current->getNumberFields());
+    testOk1(*second==*current);
+
+    // sub-fields are not re-parented by later snapshots
+    const PVField *alarm = first->getSubField("alarm").get();
+    const std::string *alarmName = &alarm->getFieldName();
+    testOk1(alarm->getParent()==NULL && second->getSubField("value")->getParent()==NULL);
+    testOk1(second->getSubFieldT("timeStamp.nanoseconds")->getFullName()=="nanoseconds");
+    second.reset();
+    testOk1(&alarm->getFieldName()==alarmName);
+    testOk1(!!first->getSubField("alarm") && !!first->getSubField("timeStamp.nanoseconds"));
+    {
+        std::ostringstream strm;
+        strm<<*first;
+        testOk(strm.str().find("alarm_t alarm")!=std::string::npos
+               && strm.str().find("time_t timeStamp")!=std::string::npos, "print %s", strm.str().c_str());
+    }
+    second = current->snapshot(changed, first);
+    // first released while second is in use
+    first.reset();
+    testOk1(!!second->getSubField("alarm.severity") && second->getSubFieldT<PVDouble>("value")->get()==2.0);
+
+    // a snapshot of a sub-structure
+    PVStructurePtr ts(current->getSubFieldT<PVStructure>("timeStamp"));
+    PVStructure::const_shared_pointer tsnap(ts->snapshot(BitSet().set(0), PVStructure::const_shared_pointer()));
+    nanoseconds->put(43);
+    PVStructure::const_shared_pointer tsnap2(ts->snapshot(BitSet().set(nanoseconds->getFieldOffset()-ts->getFieldOffset()), tsnap));
+    testOk1(tsnap2->getSubFieldT<PVInt>("nanoseconds")->get()==43);
+    testOk1(tsnap2->getSubField("userTag")==tsnap->getSubField("userTag"));
+    testOk1(tsnap2->getFieldOffset()==0u && tsnap2->getSubFieldT("nanoseconds")->getFieldOffset()==2u);
+
+    testThrows(std::invalid_argument, current->snapshot(changed, tsnap));
+}
+
 MAIN(testPVData)
 {
-    testPlan(271);
+    testPlan(358);
     try{
         fieldCreate = getFieldCreate();
         pvDataCreate = getPVDataCreate();
@@ -784,7 +1140,13 @@ MAIN(testPVData)
         testCopy();
         testFieldAccess();
         testAnyScalar();
+        testTryConvert();
         testSubField();
+        testDiff();
+        testFieldNames();
+        testLayout();
+        testPostBatch();
+        testSnapshot();
     }catch(std::exception& e){
         PRINT_EXCEPTION(e);
         testAbort("Unhandled Exception: %s", e.what());
@@ -10,6 +10,7 @@
 #include <cstddef>
 #include <string>
 #include <cstdio>
+#include <stdexcept>
 
 #include <epicsAssert.h>
 #include <epicsExit.h>
@@ -196,11 +197,100 @@ static void testVoid()
     testOk1(iarr->getLength()==4);
 }
 
+static void testSameBuffer()
+{
+    testDiag("Check comparison and copy of arrays sharing a buffer");
+
+    PVIntArrayPtr a = static_pointer_cast<PVIntArray>(getPVDataCreate()->createPVScalarArray(pvInt));
+    PVIntArrayPtr b = static_pointer_cast<PVIntArray>(getPVDataCreate()->createPVScalarArray(pvInt));
+
+    PVIntArray::const_svector idata(1000, 1);
+    a->replace(idata);
+    b->replace(idata);
+
+    testOk1(a->view().same(b->view()));
+    testOk1(*a==*b);
+
+    b->copyUnchecked(*a);
+    testOk1(b->view().same(a->view()));
+    testOk1(b->view().data()==idata.data());
+
+    // equal values in another buffer
+    PVIntArray::const_svector other(1000, 1);
+    b->replace(other);
+    testOk1(!a->view().same(b->view()));
+    testOk1(*a==*b);
+
+    b->copyUnchecked(*a);
+    testOk1(b->view().same(a->view()));
+    testOk1(b->view().data()==idata.data());
+}
+
+static bool isAligned(const void *ptr, size_t alignment)
+{
+    return (reinterpret_cast<size_t>(ptr) & (alignment-1u))==0u;
+}
+
+static void testAlignedAllocator()
+{
+    testDiag("Check array storage from an AlignedAllocator");
+
+    testOk1(!getPVDataCreate()->getArrayAllocator());
+
+    try {
+        AlignedAllocator bad(3u);
+        testFail("Accepted alignment 3");
+    }catch(std::invalid_argument&){
+        testPass("Rejected alignment 3");
+    }
+
+    // use huge pages from 1MB
+    AlignedAllocator::shared_pointer alloc(new AlignedAllocator(128u, 1024u*1024u));
+    getPVDataCreate()->setArrayAllocator(alloc);
+    testOk1(getPVDataCreate()->getArrayAllocator()==alloc);
+
+    PVDoubleArrayPtr small = getPVDataCreate()->createPVScalarArray<PVDoubleArray>();
+    PVByteArrayPtr odd = getPVDataCreate()->createPVScalarArray<PVByteArray>();
+    PVDoubleArrayPtr big = getPVDataCreate()->createPVScalarArray<PVDoubleArray>();
+
+    small->setLength(17);
+    odd->setLength(3);
+    const size_t nbig = 2u*1024u*1024u/sizeof(double)+1u;
+    big->setLength(nbig);
+
+    testOk1(isAligned(small->view().data(), 128u));
+    testOk1(isAligned(odd->view().data(), 128u));
+    testOk1(isAligned(big->view().data(), 128u));
+#if defined(__linux__)
+    testOk1(alloc->numMapped()==1u);
+#else
+    testOk1(alloc->numMapped()==0u);
+#endif
+
+    {
+        PVDoubleArray::svector temp(big->reuse());
+        for(size_t i=0; i<temp.size(); i++)
+            temp[i] = double(i);
+        big->replace(freeze(temp));
+    }
+    PVDoubleArray::const_svector bigData(big->view());
+    testOk1(bigData.size()==nbig && bigData[0]==0.0 && bigData[nbig-1u]==double(nbig-1u));
+
+    // storage outlives the allocator being un-installed
+    getPVDataCreate()->setArrayAllocator(ArrayAllocator::shared_pointer());
+    testOk1(!getPVDataCreate()->getArrayAllocator());
+    testOk1(bigData[nbig-1u]==double(nbig-1u));
+
+    bigData.clear();
+    big->replace(PVDoubleArray::const_svector());
+    testOk1(alloc->numMapped()==0u);
+}
+
 } // end namespace
 
 MAIN(testPVScalarArray)
 {
-    testPlan(158);
+    testPlan(177);
     testFactory();
     testBasic<PVByteArray>();
     testBasic<PVUByteArray>();
@@ -209,5 +299,7 @@ MAIN(testPVScalarArray)
     testBasic<PVStringArray>();
     testShare();
     testVoid();
+    testSameBuffer();
+    testAlignedAllocator();
     return testDone();
 }
@@ -20,6 +20,8 @@
 #include <pv/standardPVField.h>
 #include <pv/timeStamp.h>
 #include <pv/pvTimeStamp.h>
+#include <pv/serialize.h>
+#include <pv/pvUnitTest.h>
 
 using namespace epics::pvData;
 using std::tr1::static_pointer_cast;
@@ -195,11 +197,69 @@ static void testClearUnion()
     }
 }
 
+static void testReuseValue()
+{
+    testDiag("testReuseValue");
+
+    PVUnionPtr src(pvDataCreate->createPVVariantUnion());
+    PVUnionPtr dest(pvDataCreate->createPVVariantUnion());
+
+    std::vector<epicsUInt8> asDouble, asTime;
+    src->set(pvDataCreate->createPVScalar<PVDouble>());
+    src->get<PVDouble>()->put(42.0);
+    serializeToVector(src.get(), EPICS_BYTE_ORDER, asDouble);
+    src->set(standardPVField->scalar(pvString, "timeStamp"));
+    src->get<PVStructure>()->getSubFieldT<PVLong>("timeStamp.secondsPastEpoch")->put(1234);
+    serializeToVector(src.get(), EPICS_BYTE_ORDER, asTime);
+
+    deserializeFromVector(dest.get(), EPICS_BYTE_ORDER, asDouble);
+    PVField *firstDouble = dest->get().get();
+    testEqual(dest->get<PVDouble>()->get(), 42.0);
+
+    deserializeFromVector(dest.get(), EPICS_BYTE_ORDER, asTime);
+    PVField *firstTime = dest->get().get();
+    testEqual(dest->get<PVStructure>()->getSubFieldT<PVLong>("timeStamp.secondsPastEpoch")->get(), 1234);
+
+    // alternating types reuse the earlier instances
+    deserializeFromVector(dest.get(), EPICS_BYTE_ORDER, asDouble);
+    testOk1(dest->get().get()==firstDouble);
+    testEqual(dest->get<PVDouble>()->get(), 42.0);
+    deserializeFromVector(dest.get(), EPICS_BYTE_ORDER, asTime);
+    testOk1(dest->get().get()==firstTime);
+
+    // an instance still referenced elsewhere is not reused
+    PVFieldPtr held(dest->get());
+    deserializeFromVector(dest.get(), EPICS_BYTE_ORDER, asDouble);
+    deserializeFromVector(dest.get(), EPICS_BYTE_ORDER, asTime);
+    testOk1(dest->get().get()!=held.get());
+    testEqual(*dest->get(), *held);
+
+    // copy also reuses
+    dest->copy(*pvDataCreate->createPVVariantUnion());
+    src->set(pvDataCreate->createPVScalar<PVDouble>());
+    dest->copy(*src);
+    testOk1(dest->get().get()==firstDouble);
+
+    // arrays are not kept once replaced
+    std::vector<epicsUInt8> asArray;
+    PVDoubleArray::svector elems(1000u, 1.0);
+    PVDoubleArrayPtr arr(pvDataCreate->createPVScalarArray<PVDoubleArray>());
+    arr->replace(freeze(elems));
+    src->set(arr);
+    serializeToVector(src.get(), EPICS_BYTE_ORDER, asArray);
+    deserializeFromVector(dest.get(), EPICS_BYTE_ORDER, asArray);
+    testEqual(dest->get<PVDoubleArray>()->getLength(), 1000u);
+    std::tr1::weak_ptr<PVField> replaced(dest->get());
+    deserializeFromVector(dest.get(), EPICS_BYTE_ORDER, asDouble);
+    testOk1(replaced.expired());
+}
+
 MAIN(testPVUnion)
 {
-    testPlan(21);
+    testPlan(31);
     testPVUnionType();
     testPVUnionArray();
     testClearUnion();
+    testReuseValue();
     return testDone();
 }
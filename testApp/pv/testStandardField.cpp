@@ -33,9 +33,34 @@ static void print(const string& name, FieldConstPtr const & f)
     testShow()<<name<<'\n'<<format::indent_level(1)<<f;
 }
 
+static void testCached()
+{
+    testDiag("testCached()");
+
+    StructureConstPtr a(standardField->scalar(pvDouble, "alarm,timeStamp,display,control"));
+    testOk1(a==standardField->scalar(pvDouble, "alarm,timeStamp,display,control"));
+    testOk1(a==standardField->scalar(pvDouble, "control,display,timeStamp,alarm"));
+    testOk1(a!=standardField->scalar(pvDouble, "alarm,timeStamp"));
+    testOk1(a!=standardField->scalar(pvInt, "alarm,timeStamp,display,control"));
+    testOk1(a!=standardField->scalarArray(pvDouble, "alarm,timeStamp,display,control"));
+    testOk1(a->getField("display").get()==standardField->display().get());
+    testOk1(a->getID()=="epics:nt/NTScalar:1.0");
+
+    UnionConstPtr u1(fieldCreate->createFieldBuilder()->add("x", pvInt)->createUnion()),
+                  u2(fieldCreate->createFieldBuilder()->add("y", pvInt)->createUnion());
+    StructureConstPtr nu1(standardField->regUnion(u1, "alarm"));
+    testOk1(nu1==standardField->regUnion(u1, "alarm"));
+    testOk1(nu1->getField("value").get()==u1.get());
+    testOk1(standardField->regUnion(u2, "alarm")->getField("value").get()==u2.get());
+
+    testThrows(std::logic_error, standardField->scalar(pvString, "valueAlarm"));
+    testThrows(std::logic_error, standardField->scalar(pvString, "valueAlarm"));
+}
+
 MAIN(testStandardField)
 {
-    testPlan(1);
+    testPlan(13);
+    testCached();
     StructureConstPtr doubleValue = standardField->scalar(pvDouble,
         "alarm,timeStamp,display,control,valueAlarm");
     print("doubleValue", doubleValue);
@@ -16,6 +16,7 @@
 
 /* copy */
 int testCreateRequest(void);
+int testSharedPVStructure(void);
 
 /* misc */
 int testBaseException(void);
@@ -23,6 +24,8 @@ int testBitSet(void);
 int testByteBuffer(void);
 int testOverrunBitSet(void);
 int testSerialization(void);
+int testMemorySerialize(void);
+int testParallel(void);
 int testSharedVector(void);
 int testThread(void);
 int testEvent(void);
@@ -35,6 +38,7 @@ int testCreateRequest(void);
 
 /* pv */
 int testBitSetUtil(void);
+int testColumnarStructureArray(void);
 int testConvert(void);
 int testFieldBuilder(void);
 int testIntrospect(void);
@@ -53,6 +57,7 @@ void pvDataAllTests(void)
 
     /* pv */
     runTest(testBitSetUtil);
+    runTest(testColumnarStructureArray);
     runTest(testConvert);
     runTest(testFieldBuilder);
     runTest(testIntrospect);
@@ -71,6 +76,8 @@ void pvDataAllTests(void)
     runTest(testByteBuffer);
     runTest(testOverrunBitSet);
     runTest(testSerialization);
+    runTest(testMemorySerialize);
+    runTest(testParallel);
     runTest(testSharedVector);
     runTest(testThread);
     runTest(testEvent);
@@ -80,6 +87,7 @@ void pvDataAllTests(void)
 
     /* copy */
     runTest(testCreateRequest);
+    runTest(testSharedPVStructure);
 
     /* property */
     runTest(testCreateRequest);